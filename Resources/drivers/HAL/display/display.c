@@ -24,8 +24,6 @@
 
 #define MIN_REFRESH_MS              1
 #define DECODER_MAX                 4
-#define DISPLAY_SEGMENT_PIN_COUNT   8
-#define DISPLAY_PIN_MASK            1
 #define DPOINT_ENABLE_MASK          0x80
 #define EMPTY_DISPLAY               0x00
 #define DISPLAY_BLINK_PERIOD_MS     600
@@ -44,6 +42,7 @@
 
 #ifdef ISR_DEVELOPMENT_MODE
 #define DISPLAY_ISR_DEV DISPLAY_ISR_DEV_PIN
+static const gpio_handle_t isrDevPin = GPIO_HANDLE(DISPLAY_ISR_DEV);
 #endif
 
 
@@ -76,7 +75,7 @@ static void clearDisplay(void);
 /*******************************************************************************
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
-static const uint8_t segmentPinout[] = 
+static const pin_t segmentPinout[] = 
 {
     DISPLAY_SEGA,
     DISPLAY_SEGB,
@@ -89,6 +88,12 @@ static const uint8_t segmentPinout[] =
 
 };
 
+static const pin_t decoderPinout[] = 
+{
+    DISPLAY_DECODER_A,
+    DISPLAY_DECODER_B
+};
+
 /* Decode table extracted from https://en.wikichip.org/wiki/seven-segment_display/representing_letters and modified*/
 
 static const uint8_t seven_seg_digits_decode_gfedcba[78]= {
@@ -125,6 +130,9 @@ static display_t displays[] =
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+// Segments and decoder are written as groups, one store for each port
+static gpio_group_t segments;
+static gpio_group_t decoder;
 
 /*******************************************************************************
  *******************************************************************************
@@ -134,18 +142,14 @@ static display_t displays[] =
 void displayInit(void)
 {
     // decoder pin init (GPIO)
-    gpioWrite(DISPLAY_DECODER_A, LOW);
-    gpioWrite(DISPLAY_DECODER_B, LOW);
-
-    gpioMode(DISPLAY_DECODER_A, OUTPUT);
-    gpioMode(DISPLAY_DECODER_B, OUTPUT);
+    gpioGroupInit(&decoder, decoderPinout, sizeof(decoderPinout) / sizeof(pin_t));
+    gpioGroupWrite(&decoder, 0);
+    gpioGroupMode(&decoder, OUTPUT);
 
     // 7-segment pin init (GPIO)
-    for (uint8_t i = 0 ; i < sizeof(segmentPinout) ; i++)
-    {
-        gpioWrite(segmentPinout[i], LOW);
-        gpioMode(segmentPinout[i], OUTPUT);
-    }
+    gpioGroupInit(&segments, segmentPinout, sizeof(segmentPinout) / sizeof(pin_t));
+    gpioGroupWrite(&segments, EMPTY_DISPLAY);
+    gpioGroupMode(&segments, OUTPUT);
 
     // PISR init (SYSTICK)
     systickInit(displayPISR); // periodic interruption registration
@@ -222,7 +226,7 @@ void displayWriteWord(char string[])
 void displayPISR(void)
 {
     #ifdef ISR_DEVELOPMENT_MODE
-    gpioWrite(DISPLAY_ISR_DEV, HIGH);
+    gpioHandleSet(isrDevPin);
     #endif
 
 	static uint8_t tickCount = 1;          // PISR period time control
@@ -253,21 +257,13 @@ void displayPISR(void)
         	blinkCount++;
         }
 
-		gpioWrite(DISPLAY_DECODER_A, (displayCount & 0x1));
-		gpioWrite(DISPLAY_DECODER_B, (displayCount & 0x2));
+		gpioGroupWrite(&decoder, displayCount);
 
 		if (displays[displayCount].brightnessCount == 0)
 		{
 			if (displays[displayCount].isEnabled && (displays[displayCount].blinkIsEnabled || (displays[displayCount].state != DISPLAY_BLINK) ) )
 			{
-					uint8_t character = displays[displayCount].character;
-
-				for (uint8_t j = 0 ; j < DISPLAY_SEGMENT_PIN_COUNT ; j++)
-				{
-					uint8_t out = character & DISPLAY_PIN_MASK;
-					gpioWrite(segmentPinout[j], out);
-					character = character >> 1;
-				}
+				gpioGroupWrite(&segments, displays[displayCount].character);
 
 				displays[displayCount].brightnessCount = displays[displayCount].brightnessLevel; // reload brightness counter
 			}
@@ -293,16 +289,13 @@ void displayPISR(void)
     }
     
     #ifdef ISR_DEVELOPMENT_MODE
-    gpioWrite(DISPLAY_ISR_DEV, LOW);
+    gpioHandleClear(isrDevPin);
     #endif
 }
 
 void clearDisplay(void)
 {
-	for (uint8_t j = 0 ; j < DISPLAY_SEGMENT_PIN_COUNT ; j++)
-	{
-		gpioWrite(segmentPinout[j], LOW);
-	}
+	gpioGroupWrite(&segments, EMPTY_DISPLAY);
 }
 
 uint8_t decode7seg(uint8_t chr)
@@ -29,6 +29,7 @@
 
 #ifdef ISR_DEVELOPMENT_MODE
 #define ENCODER_ISR_DEV ENCODER_ISR_DEV_PIN
+static const gpio_handle_t isrDevPin = GPIO_HANDLE(ENCODER_ISR_DEV);
 #endif
 
 #define ENCODER_ISR_HANDLER(i,s) \
@@ -256,7 +257,7 @@ void initSingleEncoder(encoder_id_t id)
 void FSMCycle(encoder_id_t id, encoder_signal_t signal)
 {
   #ifdef ISR_DEVELOPMENT_MODE
-  gpioWrite(ENCODER_ISR_DEV, HIGH);
+  gpioHandleSet(isrDevPin);
   #endif
 
   if (encodersList[id].enabled)
@@ -274,7 +275,7 @@ void FSMCycle(encoder_id_t id, encoder_signal_t signal)
   }
   
   #ifdef ISR_DEVELOPMENT_MODE
-  gpioWrite(ENCODER_ISR_DEV, LOW);
+  gpioHandleClear(isrDevPin);
   #endif
 }
 
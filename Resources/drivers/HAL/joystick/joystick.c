@@ -41,7 +41,6 @@
 typedef struct {
 	/* General variables */
 	bool 				alreadyInitialized;		// The driver has already been initialized
-	uint32_t			tickCounter;			// Used to control the sample rate to read joystick status
 	uint8_t				threshold;				// Threshold used to detect the direction
 	joystick_position_t	bufferPosition;			// Holds the current position during the sample interval
 	uint8_t				samplingPositionStep;	// Step in the position sampling process, used to control simple state machine
@@ -106,7 +105,6 @@ void joystickInit(void)
 		context.alreadyInitialized = true;
 
 		// Initialization of the driver's context
-		context.tickCounter = JOYSTICK_SAMPLE_RATE_TICKS;
 		context.samplingPositionStep = 0;
 		context.angleReset = true;
 		context.directionReset = true;
@@ -128,8 +126,8 @@ void joystickInit(void)
 		// Initialization of the gpio driver
 		gpioMode(JOYSTICK_BUTTON_PIN, INPUT | (JOYSTICK_BUTTON_ACTIVE == LOW ? PULLUP : PULLDOWN));
 
-		// Initialization of the systick driver
-		systickInit(joystickPeriodicISR);
+		// Initialization of the systick driver, called at the sample rate
+		systickSubscribe(joystickPeriodicISR, JOYSTICK_SAMPLE_RATE_TICKS, 0);
 	}
 }
 
@@ -174,25 +172,19 @@ void joystickOnAnyDirection(js_any_direction_cb_t callback, uint8_t threshold)
 
 static void joystickPeriodicISR(void)
 {
-	if (--context.tickCounter == 0)
+	// Sample the status of the joystick's button
+	bool previousButtonPressed = context.buttonPressed;
+	context.buttonPressed = gpioRead(JOYSTICK_BUTTON_PIN) == JOYSTICK_BUTTON_ACTIVE ? true : false;
+	if (!previousButtonPressed && context.buttonPressed)
 	{
-		// Reload the value of the tickCounter
-		context.tickCounter = JOYSTICK_SAMPLE_RATE_TICKS;
-
-		// Sample the status of the joystick's button
-		bool previousButtonPressed = context.buttonPressed;
-		context.buttonPressed = gpioRead(JOYSTICK_BUTTON_PIN) == JOYSTICK_BUTTON_ACTIVE ? true : false;
-		if (!previousButtonPressed && context.buttonPressed)
+		if (context.onButtonPressed)
 		{
-			if (context.onButtonPressed)
-			{
-				context.onButtonPressed();
-			}
+			context.onButtonPressed();
 		}
-
-		// Sample the status of the joystick's position
-		joystickSamplePosition(JOYSTICK_SAMPLE_RESET);
 	}
+
+	// Sample the status of the joystick's position
+	joystickSamplePosition(JOYSTICK_SAMPLE_RESET);
 }
 
 static void joystickSamplePosition(int16_t sample)
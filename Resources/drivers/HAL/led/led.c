@@ -80,8 +80,16 @@ typedef struct {
 	led_mode_t	mode;		// The current led mode
 	bool		enabled;	// Stops interruption control while settings are being changed by user
 	context_t	context;	// Data context to run each led mode
+	uint32_t	mask;		// Mask of the pin in its port
 } led_t;
 
+// Changes of the outputs requested during the ISR, written once for each port
+typedef struct {
+	uint32_t	set[GPIO_PORT_COUNT];
+	uint32_t	clear[GPIO_PORT_COUNT];
+	uint32_t	toggle[GPIO_PORT_COUNT];
+} led_outputs_t;
+
 // Declaration of the led function process control
 typedef void	(*process)(led_t* led);
 
@@ -133,6 +141,14 @@ static void ledInstanceBlinkSomeProcess(led_t* led);
 static void ledInstanceBurstProcess(led_t* led);
 static void ledInstanceOneShotProcess(led_t* led);
 
+/**
+ * @brief Requests the change of the led output, written when the ISR finishes
+ * @param led	Led instance pointer
+ * @param value	Value of the pin
+ */
+static void ledInstanceOutput(led_t* led, bool value);
+static void ledInstanceOutputToggle(led_t* led);
+
 /*******************************************************************************
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
@@ -157,6 +173,9 @@ static led_t 			leds[LED_TOTAL_COUNT] = {
 		{	PIN_LED_GREEN, 	LED_ACTIVE	}
 };
 
+// Outputs changed by the current ISR
+static led_outputs_t	outputs;
+
 /*******************************************************************************
  *******************************************************************************
                         GLOBAL FUNCTION DEFINITIONS
@@ -352,6 +371,26 @@ static void ledISR(void)
 			}
 		}
 	}
+
+	// Leds changed together on the same port are written with one store
+	for (uint8_t port = 0; port < GPIO_PORT_COUNT; port++)
+	{
+		if (outputs.set[port])
+		{
+			gpioSetMask(port, outputs.set[port]);
+			outputs.set[port] = 0;
+		}
+		if (outputs.clear[port])
+		{
+			gpioClearMask(port, outputs.clear[port]);
+			outputs.clear[port] = 0;
+		}
+		if (outputs.toggle[port])
+		{
+			gpioToggleMask(port, outputs.toggle[port]);
+			outputs.toggle[port] = 0;
+		}
+	}
 }
 
 /*******************************************************************************
@@ -369,6 +408,7 @@ static void ledInstanceInit(led_t* led)
 		// Initialization of some structure variables
 		led->enabled = true;
 		led->mode = STATIC;
+		led->mask = 1UL << PIN2NUM(led->pin);
 
 		// Initialization of GPIO associated to the led structure
 		gpioWrite(led->pin, !led->active);
@@ -405,7 +445,7 @@ static void ledInstanceBlinkProcess(led_t* led)
 		blink_context_t* context = &led->context.blink;
 		if (--context->counter == 0)
 		{
-			gpioToggle(led->pin);
+			ledInstanceOutputToggle(led);
 			context->counter = context->period / 2;
 		}
 	}
@@ -420,7 +460,7 @@ static void ledInstanceBlinkSomeProcess(led_t* led)
 		blink_some_context_t* context = &led->context.blinkSome;
 		if (--context->counter == 0)
 		{
-			gpioToggle(led->pin);
+			ledInstanceOutputToggle(led);
 			if (--context->changes == 0)
 			{
 				led->mode = STATIC;
@@ -442,7 +482,7 @@ static void ledInstanceBurstProcess(led_t* led)
 		burst_context_t* context = &led->context.burst;
 		if (--context->burstCounter == 0)
 		{
-			gpioWrite(led->pin, led->active);
+			ledInstanceOutput(led, led->active);
 			context->burstCounter = context->burstPeriod;
 			context->blinkCounter = context->blinkPeriod / 2;
 			context->changes = context->blinks * 2 - 1;
@@ -453,7 +493,7 @@ static void ledInstanceBurstProcess(led_t* led)
 			{
 				if (--context->blinkCounter == 0)
 				{
-					gpioToggle(led->pin);
+					ledInstanceOutputToggle(led);
 					context->blinkCounter = context->blinkPeriod / 2;
 					context->changes--;
 				}
@@ -471,12 +511,34 @@ static void ledInstanceOneShotProcess(led_t* led)
 		one_shot_context_t* context = &led->context.oneShot;
 		if (--context->counter == 0)
 		{
-			gpioWrite(led->pin, !led->active);
+			ledInstanceOutput(led, !led->active);
 			led->mode = STATIC;
 		}
 	}
 }
 
+static void ledInstanceOutput(led_t* led, bool value)
+{
+	// The last request of the ISR wins
+	uint8_t port = PIN2PORT(led->pin);
+	outputs.toggle[port] &= ~led->mask;
+	if (value)
+	{
+		outputs.set[port] |= led->mask;
+		outputs.clear[port] &= ~led->mask;
+	}
+	else
+	{
+		outputs.clear[port] |= led->mask;
+		outputs.set[port] &= ~led->mask;
+	}
+}
+
+static void ledInstanceOutputToggle(led_t* led)
+{
+	outputs.toggle[PIN2PORT(led->pin)] ^= led->mask;
+}
+
 
 /*******************************************************************************
  *******************************************************************************
@@ -9,6 +9,7 @@
  ******************************************************************************/
 
 #include "drivers/MCAL/gpio/gpio.h"
+#include "drivers/MCAL/gpio/gpio_capture.h"
 #include "board/board.h"
 #include "magnetic_reader.h"
 
@@ -41,7 +42,10 @@
 static void edgesHandler(void);
 static void cardSwipe(void);
 static void cardSwipeStopped(void);
+#ifndef MAGNETIC_READER_DMA_MODE
 static void dataRead(void);
+#endif
+static void dataCopy(void);
 static bool getUsefulData(void);
 static uint16_t searchSS(void);
 static uint16_t searchES(uint16_t ss);
@@ -63,6 +67,15 @@ static uint8_t 	cardData[DATA_LENGTH*2];
 static uint8_t	usefulCardData[DATA_LENGTH];
 static uint8_t 	finalId[40];
 
+// Pins read from the interrupts
+static const gpio_handle_t	enablePin = GPIO_HANDLE(MAG_CARD_ENABLE);
+static const gpio_handle_t	dataPin = GPIO_HANDLE(MAG_CARD_DATA);
+
+#ifdef MAGNETIC_READER_DMA_MODE
+// Samples of the port of the clock and data pins, one on each clock edge
+static uint32_t	captureData[DATA_LENGTH*2];
+#endif
+
 static void 	(*dataCallback)(uint8_t data[]);
 static void 	(*errorCallback)(void);
 
@@ -81,7 +94,9 @@ void magneticReaderInit(void)
 
 	// Configure IRQ's
 	gpioIRQ(MAG_CARD_ENABLE, GPIO_IRQ_MODE_INTERRUPT_BOTH_EDGES, edgesHandler);
+#ifndef MAGNETIC_READER_DMA_MODE
 	gpioIRQ(MAG_CARD_CLK, GPIO_IRQ_MODE_INTERRUPT_FALLING_EDGE, dataRead);
+#endif
 }
 
 void magneticReaderSubscribe(void (*dataCb) (uint8_t data[]), void (*errorCb) (void))
@@ -100,7 +115,7 @@ void magneticReaderSubscribe(void (*dataCb) (uint8_t data[]), void (*errorCb) (v
 static void edgesHandler(void)
 {
 	bool state;
-	state = gpioRead(MAG_CARD_ENABLE);
+	state = gpioHandleRead(enablePin);
 	if(state)
 	{
 		cardSwipeStopped();
@@ -114,6 +129,13 @@ static void edgesHandler(void)
 static void cardSwipe(void)
 {
 	enableActive = true;
+
+#ifdef MAGNETIC_READER_DMA_MODE
+	// The DMA samples the data on each clock edge until the swipe stops
+	gpio_capture_cfg_t config = { MAG_CARD_CLK, GPIO_IRQ_MODE_DMA_FALLING_EDGE, captureData, NULL, DATA_LENGTH*2, NULL, false, NULL };
+	gpioCaptureStop();
+	gpioCaptureStart(config);
+#endif
 }
 
 static void cardSwipeStopped(void)
@@ -122,6 +144,7 @@ static void cardSwipeStopped(void)
 	{
 		enableActive = false;
 		restart = true;
+		dataCopy();
 
 		if(!dataParse())
 		{
@@ -136,6 +159,7 @@ static void cardSwipeStopped(void)
 	}
 }
 
+#ifndef MAGNETIC_READER_DMA_MODE
 static void dataRead(void)
 {
 	static uint32_t bitCounter = 0;
@@ -146,7 +170,7 @@ static void dataRead(void)
 	}
 	if(enableActive)
 	{
-		cardData[bitCounter] = (!gpioRead(MAG_CARD_DATA));
+		cardData[bitCounter] = (!gpioHandleRead(dataPin));
 		bitCounter++;
 	}
 	else
@@ -154,6 +178,20 @@ static void dataRead(void)
 		bitCounter = 0;
 	}
 }
+#endif
+
+static void dataCopy(void)
+{
+#ifdef MAGNETIC_READER_DMA_MODE
+	// Data bits of the samples captured, the rest of the bits are cleared
+	size_t bits = gpioCaptureStop();
+	uint16_t i;
+	for(i = 0; i < DATA_LENGTH*2; i++)
+	{
+		cardData[i] = i < bits ? !(captureData[i] & dataPin.mask) : 0;
+	}
+#endif
+}
 
 static bool getUsefulData(void)
 {
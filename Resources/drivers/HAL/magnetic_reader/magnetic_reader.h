@@ -19,6 +19,11 @@
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
+// You can create a define with MAGNETIC_READER_DMA_MODE to sample the data pin
+// with the DMA on each edge of the clock, instead of one interrupt for each bit.
+// The data pin must be on the same port as the clock pin.
+// #define MAGNETIC_READER_DMA_MODE
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -8,7 +8,12 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 #include "timer.h"
-#include "../../MCAL/systick/SysTick.h"
+#include "../../MCAL/systick/systick.h"
+#include "../../../startup/hardware.h"
+#include "../../../lib/typed_queue/typed_queue.h"
+#ifdef TIMER_TICKLESS_MODE
+#include "../../MCAL/pit/pit.h"
+#endif // TIMER_TICKLESS_MODE
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -22,20 +27,47 @@
 
 #define TIMER_ID_INTERNAL   0
 
+#if (TIMER_WHEEL_SIZE & (TIMER_WHEEL_SIZE - 1)) != 0 || TIMER_WHEEL_SIZE > 128
+#error TIMER_WHEEL_SIZE must be a power of two up to 128
+#endif
+
+// Lists of timers, the slots of the wheel and the list of timers
+// expiring in the current tick
+#define TIMER_LIST_EXPIRING TIMER_WHEEL_SIZE
+#define TIMER_LIST_NONE     0xFF
+#define TIMER_WHEEL_MASK    (TIMER_WHEEL_SIZE - 1)
+
+#if TIMER_DEFERRED_QUEUE_SIZE < TIMERS_MAX_CANT
+#error TIMER_DEFERRED_QUEUE_SIZE must hold every timer
+#endif
+
+// Bit of a slot in the occupancy bit mask
+#define SLOT_WORD(slot)     ((slot) >> 5)
+#define SLOT_BIT(slot)      (1UL << ((slot) & 31))
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
 typedef struct {
 	ttick_t             period;
-	ttick_t             cnt;
+	ttick_t             deadline;   // Tick when the timer expires
+    ttick_t             expiredAt;  // Tick of the expiration waiting in the deferred queue
     tim_callback_t      callback;
+    tim_id_t            next;       // Next timer in the same list
+    tim_id_t            prev;       // Previous timer in the same list
+    uint8_t             list;       // Slot of the wheel, TIMER_LIST_EXPIRING or TIMER_LIST_NONE
     uint8_t             mode        : 1;
     uint8_t             running     : 1;
     uint8_t             expired     : 1;
-    uint8_t             unused      : 5;
+    uint8_t             deferred    : 1;    // Callback run by timerService()
+    uint8_t             pending     : 1;    // Waiting in the deferred queue
+    uint8_t             unused      : 3;
 } timer_t;
 
+// Expired timers, from the timer ISR to timerService()
+DECLARE_QUEUE(timerDeferredQueue, tim_id_t, TIMER_DEFERRED_QUEUE_SIZE)
+
 /*******************************************************************************
  * VARIABLES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -49,6 +81,60 @@ typedef struct {
  */
 static void timer_isr(void);
 
+/**
+ * @brief Expires the timers with the given deadline and runs their callbacks
+ * @param tick Tick being processed
+ */
+static void expireSlot(ttick_t tick);
+
+/**
+ * @brief Returns the current tick, to schedule timers from
+ */
+static ttick_t currentTick(void);
+
+/**
+ * @brief Inserts the timer at the beginning of the list, with interrupts disabled
+ * @param id ID of the timer
+ * @param list Slot of the wheel or TIMER_LIST_EXPIRING
+ */
+static void listInsert(tim_id_t id, uint8_t list);
+
+/**
+ * @brief Removes the timer from its list, if any, with interrupts disabled
+ * @param id ID of the timer
+ */
+static void listRemove(tim_id_t id);
+
+/**
+ * @brief Schedules the timer to expire after the given ticks, with interrupts disabled
+ * @param id ID of the timer
+ * @param ticks Ticks until the timer expires
+ */
+static void schedule(tim_id_t id, ttick_t ticks);
+
+/**
+ * @brief Schedules the timer to expire at the given tick, with interrupts disabled
+ * @param id ID of the timer
+ * @param deadline Tick when the timer expires
+ */
+static void scheduleAt(tim_id_t id, ttick_t deadline);
+
+#ifdef TIMER_TICKLESS_MODE
+/**
+ * @brief Looks for the nearest deadline after the last tick processed, with
+ *        interrupts disabled
+ * @param deadline Nearest deadline found
+ * @return Whether there is any timer running
+ */
+static bool nextDeadline(ttick_t* deadline);
+
+/**
+ * @brief Programs the alarm to the nearest deadline, or stops it, with
+ *        interrupts disabled
+ */
+static void armAlarm(void);
+#endif // TIMER_TICKLESS_MODE
+
 
 /*******************************************************************************
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
@@ -61,6 +147,19 @@ static void timer_isr(void);
 static timer_t timers[TIMERS_MAX_CANT];
 static tim_id_t timers_cant = TIMER_ID_INTERNAL+1;
 
+static tim_id_t wheel[TIMER_WHEEL_SIZE + 1];    // First timer of each list
+static uint32_t wheelOccupancy[(TIMER_WHEEL_SIZE + 31) / 32];  // Bit mask of slots with timers
+static volatile ttick_t now;                    // Ticks since initialised
+
+static timerDeferredQueue_t deferredQueue;
+static timer_deferred_stats_t deferredStats;
+
+#ifdef TIMER_TICKLESS_MODE
+static ttick_t alarmTick;                       // Deadline programmed in the alarm
+static bool alarmArmed;                         // Whether the alarm is programmed
+static bool servicing;                          // Whether the alarm is being serviced
+#endif // TIMER_TICKLESS_MODE
+
 /*******************************************************************************
  *******************************************************************************
                         GLOBAL FUNCTION DEFINITIONS
@@ -72,8 +171,22 @@ void timerInit(void)
     static bool yaInit = false;
     if (yaInit)
         return;
+
+    // Every list starts empty
+    for (uint8_t list = 0 ; list <= TIMER_WHEEL_SIZE ; list++)
+    {
+        wheel[list] = TIMER_INVALID_ID;
+    }
+    for (tim_id_t id = 0 ; id < TIMERS_MAX_CANT ; id++)
+    {
+        timers[id].list = TIMER_LIST_NONE;
+    }
     
+#ifdef TIMER_TICKLESS_MODE
+    pitTimebaseInit(PIT_BUS_CLOCK_HZ / 1000U * TIMER_TICK_MS); // init peripheral
+#else
     systickInit(timer_isr); // init peripheral
+#endif // TIMER_TICKLESS_MODE
     
     yaInit = true;
 }
@@ -100,18 +213,19 @@ void timerStart(tim_id_t id, ttick_t ticks, uint8_t mode, tim_callback_t callbac
     if ((id < timers_cant) && (mode < CANT_TIM_MODES))
 #endif // TIMER_DEVELOPMENT_MODE
     {
-        // disable timer
-        timers[id].running = 0;
+        hardwareDisableInterrupts();
 
         // configure timer
         timers[id].period = ticks;
-        timers[id].cnt = ticks;
         timers[id].callback = callback;
         timers[id].mode = mode;
         timers[id].expired = 0;
 
         // enable timer
+        schedule(id, ticks);
         timers[id].running = 1;
+
+        hardwareEnableInterrupts();
     }
 }
 
@@ -121,13 +235,17 @@ void timerResume(tim_id_t id)
     if (id < timers_cant)
 #endif // TIMER_DEVELOPMENT_MODE
     {
+        hardwareDisableInterrupts();
+
         // Si esta pausado el timer
         if (!timers[id].running)
         {
             // Reanudo el timer
-            timers[id].cnt = timers[id].period;
+            schedule(id, timers[id].period);
             timers[id].running = 1;
         }
+
+        hardwareEnableInterrupts();
     }
 }
 
@@ -137,11 +255,16 @@ void timerPause(tim_id_t id)
     if (id < timers_cant)
 #endif // TIMER_DEVELOPMENT_MODE
     {
+        hardwareDisableInterrupts();
+
         // Apago el timer
+        listRemove(id);
         timers[id].running = 0;
 
         // y bajo el flag
         timers[id].expired = 0;
+
+        hardwareEnableInterrupts();
     }
 }
 
@@ -151,18 +274,71 @@ void timerRestart(tim_id_t id)
     if (id < timers_cant)
 #endif // TIMER_DEVELOPMENT_MODE
     {
-        // disable timer
-        timers[id].running = 0;
+        hardwareDisableInterrupts();
 
         // configure timer
-        timers[id].cnt = timers[id].period;
         timers[id].expired = 0;
 
         // enable timer
+        schedule(id, timers[id].period);
         timers[id].running = 1;
+
+        hardwareEnableInterrupts();
     }
 }
 
+void timerSetDeferred(tim_id_t id, bool deferred)
+{
+#ifdef TIMER_DEVELOPMENT_MODE
+    if (id < timers_cant)
+#endif // TIMER_DEVELOPMENT_MODE
+    {
+        hardwareDisableInterrupts();
+        timers[id].deferred = deferred;
+        hardwareEnableInterrupts();
+    }
+}
+
+void timerService(void)
+{
+    tim_id_t id;
+    while (timerDeferredQueuePop(&deferredQueue, &id))
+    {
+        // Once cleared, a new expiration is queued again
+        hardwareDisableInterrupts();
+        timers[id].pending = 0;
+        ttick_t latency = currentTick() - timers[id].expiredAt;
+        tim_callback_t callback = timers[id].callback;
+        deferredStats.depth--;
+        if (latency > deferredStats.maxLatency)
+        {
+            deferredStats.maxLatency = latency;
+        }
+        hardwareEnableInterrupts();
+
+        if (callback)
+        {
+            callback();
+        }
+    }
+}
+
+void timerGetDeferredStats(timer_deferred_stats_t* stats)
+{
+    hardwareDisableInterrupts();
+    *stats = deferredStats;
+    hardwareEnableInterrupts();
+}
+
+void timerResetDeferredStats(void)
+{
+    hardwareDisableInterrupts();
+    deferredStats.maxDepth = deferredStats.depth;
+    deferredStats.maxLatency = 0;
+    deferredStats.overruns = 0;
+    hardwareEnableInterrupts();
+}
+
 bool timerRunning(tim_id_t id)
 {
     return timers[id].running;
@@ -193,41 +369,245 @@ void timerDelay(ttick_t ticks)
 
 static void timer_isr(void)
 {
-    // decremento los timers activos
-    uint8_t timerIndex;
-    for (timerIndex = 0 ; timerIndex < timers_cant ; timerIndex++)
+#ifdef TIMER_TICKLESS_MODE
+    // Woken up by the alarm, every deadline up to the current tick
+    // is processed in order, skipping the ticks without timers
+    hardwareDisableInterrupts();
+    servicing = true;
+    ttick_t tick = currentTick();
+    ttick_t deadline;
+    while (now != tick)
     {
-        timer_t* currentTimer = &timers[timerIndex];
-        if (currentTimer->running)
+        if (nextDeadline(&deadline) && (deadline - now) <= (tick - now))
         {
-            currentTimer->cnt--;
-            // si hubo timeout!
-            if (currentTimer->cnt == 0)
+            now = deadline;
+            hardwareEnableInterrupts();
+            expireSlot(deadline);
+            hardwareDisableInterrupts();
+        }
+        else
+        {
+            now = tick;
+        }
+    }
+    servicing = false;
+    armAlarm();
+    hardwareEnableInterrupts();
+#else
+    expireSlot(++now);
+#endif // TIMER_TICKLESS_MODE
+}
+
+static void expireSlot(ttick_t tick)
+{
+    uint8_t slot = tick & TIMER_WHEEL_MASK;
+
+    // Only the timers in the slot of this tick can expire
+    if (wheelOccupancy[SLOT_WORD(slot)] & SLOT_BIT(slot))
+    {
+        // 1) move the timers expiring now to their own list, the others
+        // in the slot expire in the next turns of the wheel
+        hardwareDisableInterrupts();
+        tim_id_t id = wheel[slot];
+        while (id != TIMER_INVALID_ID)
+        {
+            tim_id_t next = timers[id].next;
+            if (timers[id].deadline == tick)
+            {
+                listRemove(id);
+                listInsert(id, TIMER_LIST_EXPIRING);
+            }
+            id = next;
+        }
+        hardwareEnableInterrupts();
+
+        // 2) process them one at a time, callbacks can start, pause or
+        // restart any timer, even the ones still in the list
+        while (wheel[TIMER_LIST_EXPIRING] != TIMER_INVALID_ID)
+        {
+            hardwareDisableInterrupts();
+            id = wheel[TIMER_LIST_EXPIRING];
+            timer_t* currentTimer = &timers[id];
+            listRemove(id);
+
+            // Important: first update state so that if timerStart()
+            // is called in the callback, this block doesn't deletes
+            // the configuration
+            if (currentTimer->mode == TIM_MODE_SINGLESHOT)
             {
-            	// Important: first update state so that if timerStart()
-				// is called in the callback, this block doesn't deletes
-            	// the configuration
-                // 1) update state
-                if (currentTimer->mode == TIM_MODE_SINGLESHOT)
+                currentTimer->expired = 1;
+                currentTimer->running = 0;
+            }
+            else
+            {
+                // Periodic timers are scheduled from their deadline, so
+                // they don't drift when processed late
+                scheduleAt(id, tick + (currentTimer->period ? currentTimer->period : 1));
+                currentTimer->expired = 1;
+            }
+            tim_callback_t callback = currentTimer->callback;
+
+            // Deferred callbacks are queued for timerService(), an expiration
+            // while the previous one is waiting only counts as an overrun
+            if (currentTimer->deferred)
+            {
+                callback = NULL;
+                if (currentTimer->pending)
                 {
-                    currentTimer->expired = 1;
-                    currentTimer->running = 0;
+                    deferredStats.overruns++;
                 }
                 else
                 {
-                    currentTimer->cnt = currentTimer->period;
-                    currentTimer->expired = 1;
+                    currentTimer->pending = 1;
+                    currentTimer->expiredAt = tick;
+                    timerDeferredQueuePush(&deferredQueue, id);
+                    if (++deferredStats.depth > deferredStats.maxDepth)
+                    {
+                        deferredStats.maxDepth = deferredStats.depth;
+                    }
                 }
+            }
+            hardwareEnableInterrupts();
 
-            	// 2) execute action: callback or set flag
-                if (currentTimer->callback)
+            // 3) execute action: callback or set flag
+            if (callback)
+            {
+                callback();
+            }
+        }
+    }
+}
+
+static ttick_t currentTick(void)
+{
+#ifdef TIMER_TICKLESS_MODE
+    return pitTimebaseTicks();
+#else
+    return now;
+#endif // TIMER_TICKLESS_MODE
+}
+
+static void listInsert(tim_id_t id, uint8_t list)
+{
+    timers[id].list = list;
+    timers[id].prev = TIMER_INVALID_ID;
+    timers[id].next = wheel[list];
+    if (wheel[list] != TIMER_INVALID_ID)
+    {
+        timers[wheel[list]].prev = id;
+    }
+    wheel[list] = id;
+
+    if (list < TIMER_WHEEL_SIZE)
+    {
+        wheelOccupancy[SLOT_WORD(list)] |= SLOT_BIT(list);
+    }
+}
+
+static void listRemove(tim_id_t id)
+{
+    uint8_t list = timers[id].list;
+    if (list != TIMER_LIST_NONE)
+    {
+        if (timers[id].prev != TIMER_INVALID_ID)
+        {
+            timers[timers[id].prev].next = timers[id].next;
+        }
+        else
+        {
+            wheel[list] = timers[id].next;
+        }
+        if (timers[id].next != TIMER_INVALID_ID)
+        {
+            timers[timers[id].next].prev = timers[id].prev;
+        }
+        timers[id].list = TIMER_LIST_NONE;
+
+        if (list < TIMER_WHEEL_SIZE && wheel[list] == TIMER_INVALID_ID)
+        {
+            wheelOccupancy[SLOT_WORD(list)] &= ~SLOT_BIT(list);
+        }
+    }
+}
+
+static void schedule(tim_id_t id, ttick_t ticks)
+{
+    // A timer of zero ticks expires in the next tick
+    scheduleAt(id, currentTick() + (ticks ? ticks : 1));
+}
+
+static void scheduleAt(tim_id_t id, ttick_t deadline)
+{
+#ifdef TIMER_TICKLESS_MODE
+    // Without timers nothing is processed, so the last tick processed
+    // catches up to keep the deadlines near
+    if (!servicing && !alarmArmed)
+    {
+        now = currentTick();
+    }
+#endif // TIMER_TICKLESS_MODE
+
+    listRemove(id);
+    timers[id].deadline = deadline;
+    listInsert(id, deadline & TIMER_WHEEL_MASK);
+
+#ifdef TIMER_TICKLESS_MODE
+    // The alarm is moved earlier if needed, while servicing it is
+    // programmed when finished
+    if (!servicing && (!alarmArmed || (int32_t)(deadline - alarmTick) < 0))
+    {
+        alarmTick = deadline;
+        alarmArmed = true;
+        pitAlarmAt(deadline, timer_isr);
+    }
+#endif // TIMER_TICKLESS_MODE
+}
+
+#ifdef TIMER_TICKLESS_MODE
+static bool nextDeadline(ttick_t* deadline)
+{
+    bool found = false;
+    ttick_t nearest = 0;
+
+    // Slots are visited in order from the next tick, so the first timer
+    // expiring in this turn of the wheel is the nearest one, otherwise
+    // it is the nearest of the later turns
+    for (uint16_t ahead = 1 ; ahead <= TIMER_WHEEL_SIZE && !(found && nearest <= ahead) ; ahead++)
+    {
+        uint8_t slot = (now + ahead) & TIMER_WHEEL_MASK;
+        if (wheelOccupancy[SLOT_WORD(slot)] & SLOT_BIT(slot))
+        {
+            for (tim_id_t id = wheel[slot] ; id != TIMER_INVALID_ID ; id = timers[id].next)
+            {
+                ttick_t distance = timers[id].deadline - now;
+                if (!found || distance < nearest)
                 {
-                    currentTimer->callback();
+                    nearest = distance;
+                    found = true;
                 }
-
             }
         }
     }
+
+    *deadline = now + nearest;
+    return found;
+}
+
+static void armAlarm(void)
+{
+    ttick_t deadline;
+    if (nextDeadline(&deadline))
+    {
+        alarmTick = deadline;
+        alarmArmed = true;
+        pitAlarmAt(deadline, timer_isr);
+    }
+    else if (alarmArmed)
+    {
+        alarmArmed = false;
+        pitAlarmStop();
+    }
 }
+#endif // TIMER_TICKLESS_MODE
 
 /******************************************************************************/
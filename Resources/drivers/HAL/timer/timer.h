@@ -23,8 +23,36 @@
 #define TIMER_TICK_MS       1
 #define TIMER_MS2TICKS(ms)  ((ms)/TIMER_TICK_MS)
 
+// Amount of timers, including the internal one used by timerDelay()
+#ifndef TIMERS_MAX_CANT
 #define TIMERS_MAX_CANT     16
+#endif
+
+#if TIMERS_MAX_CANT < 255
 #define TIMER_INVALID_ID    255
+#else
+#define TIMER_INVALID_ID    0xFFFF
+#endif
+
+// Slots of the timing wheel, must be a power of two up to 128. Timers are
+// placed in the slot of the tick they expire, so each tick only visits
+// the timers of one slot. Timers longer than the wheel stay in their
+// slot for more than one turn, so use a size greater than the usual periods.
+#ifndef TIMER_WHEEL_SIZE
+#define TIMER_WHEEL_SIZE    32
+#endif
+
+// Tickless mode, the driver does not use the SysTick. The time base is the
+// PIT, and its alarm is programmed to the next deadline, so the CPU is only
+// woken up when a timer expires. The SysTick keeps running while other
+// drivers are subscribed to it.
+// #define TIMER_TICKLESS_MODE
+
+// Size of the queue of deferred callbacks, a power of two not lower than
+// TIMERS_MAX_CANT, each timer is queued at most once
+#ifndef TIMER_DEFERRED_QUEUE_SIZE
+#define TIMER_DEFERRED_QUEUE_SIZE   16
+#endif
 
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
@@ -35,9 +63,21 @@ enum { TIM_MODE_SINGLESHOT, TIM_MODE_PERIODIC, CANT_TIM_MODES };
 
 // Timer alias
 typedef uint32_t ttick_t;
+#if TIMERS_MAX_CANT < 255
 typedef uint8_t tim_id_t;
+#else
+typedef uint16_t tim_id_t;
+#endif
 typedef void (*tim_callback_t)(void);
 
+// Counters of the deferred callbacks
+typedef struct {
+    uint16_t    depth;          // Expirations waiting in the queue
+    uint16_t    maxDepth;       // Highest depth seen
+    ttick_t     maxLatency;     // Worst ticks from the expiration to the callback
+    uint32_t    overruns;       // Expirations while the previous one was still waiting
+} timer_deferred_stats_t;
+
 
 /*******************************************************************************
  * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
@@ -91,6 +131,32 @@ void timerResume(tim_id_t id);
  */
 void timerRestart(tim_id_t id);
 
+/**
+ * @brief Selects whether the callback of the timer runs in the timer ISR, the
+ *        default, or deferred to timerService() in the main loop. Expirations
+ *        already queued still run their callback.
+ * @param id ID of the timer
+ * @param deferred true = callback deferred to timerService()
+ */
+void timerSetDeferred(tim_id_t id, bool deferred);
+
+/**
+ * @brief Runs the callbacks of the deferred timers which expired, in the order
+ *        they expired. Call it from the main loop.
+ */
+void timerService(void);
+
+/**
+ * @brief Gets the counters of the deferred callbacks
+ * @param stats Where the counters are copied
+ */
+void timerGetDeferredStats(timer_deferred_stats_t* stats);
+
+/**
+ * @brief Clears the maximum depth, worst latency and overruns counters
+ */
+void timerResetDeferredStats(void);
+
 /**
  * @brief Returns whether the timer is running or not
  * @param id ID of the timer
@@ -0,0 +1,96 @@
+/*******************************************************************************
+  @file     timestamp.c
+  @brief    Timestamp driver, monotonic 64 bits clock on the SysTick
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "timestamp.h"
+#include "../../MCAL/systick/systick.h"
+#include "hardware.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CYCLES_PER_TICK		(CPU_FREQUENCY_HZ / SYSTICK_ISR_FREQUENCY_HZ)
+#define CYCLES_PER_US		(CPU_FREQUENCY_HZ / 1000000UL)
+#define US_PER_TICK			(1000000UL / SYSTICK_ISR_FREQUENCY_HZ)
+
+// Cycles elapsed in the tick, the counter goes from CYCLES_PER_TICK - 1
+// down to zero, when the next tick begins
+#define ELAPSED_CYCLES(value)	((value) ? CYCLES_PER_TICK - (value) : 0)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Reads the ticks and the cycles elapsed in the current tick, both
+ * 		  from the same instant
+ * @param cycles	Cycles elapsed since the beginning of the tick
+ * @return Ticks since initialised
+ */
+static uint64_t readClock(uint32_t* cycles);
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void timestampInit(void)
+{
+	systickInit(NULL);
+}
+
+uint64_t timeNowTicks64(void)
+{
+	uint32_t cycles;
+	return readClock(&cycles);
+}
+
+uint64_t timeNowUs(void)
+{
+	uint32_t cycles;
+	uint64_t ticks = readClock(&cycles);
+	return ticks * US_PER_TICK + cycles / CYCLES_PER_US;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint64_t readClock(uint32_t* cycles)
+{
+	// The SysTick driver counts the tick of the last reload when reading, so
+	// the ticks never lag behind the counter, even while the SysTick ISR is
+	// pending or preempted by the caller, before counting the tick
+	uint32_t value;
+	uint64_t ticks = systickGetClock(&value);
+	*cycles = ELAPSED_CYCLES(value);
+	return ticks;
+}
+
+/******************************************************************************/
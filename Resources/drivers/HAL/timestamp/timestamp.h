@@ -0,0 +1,59 @@
+/*******************************************************************************
+  @file     timestamp.h
+  @brief    Timestamp driver, monotonic 64 bits clock on the SysTick
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef HAL_TIMESTAMP_TIMESTAMP_H_
+#define HAL_TIMESTAMP_TIMESTAMP_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// The clock combines the ticks counted by the SysTick ISR with the SysTick
+// counter, so it has the resolution of the CPU clock without any other
+// interrupt. It can be read from the main loop and from any ISR, also with
+// interrupts disabled or preempting the SysTick ISR, each reload of the
+// counter is counted once, by the first read or by the ISR. Reads keep the
+// clock running even with interrupts disabled for more than one tick, as
+// long as it is read at least once per tick.
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Initialises the clock, starting the SysTick if needed
+ */
+void timestampInit(void);
+
+/**
+ * @brief Returns the ticks of SYSTICK_TICK_MS since initialised
+ */
+uint64_t timeNowTicks64(void);
+
+/**
+ * @brief Returns the microseconds since initialised
+ */
+uint64_t timeNowUs(void);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif /* HAL_TIMESTAMP_TIMESTAMP_H_ */
@@ -10,6 +10,7 @@
 
 #include "MK64F12.h"
 #include "gpio.h"
+#include "../../../lib/isr_profiler/isr_profiler.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -35,12 +36,25 @@
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
+// IRQ registration of each pin
+typedef struct {
+	pinIrqFun_t			callback;			// Callback without context
+	pinIrqCtxFun_t		contextCallback;	// Callback with context, used first
+	void*				context;			// Context of the callback
+	volatile uint32_t	edges;				// Events counted by the port interrupt
+} pin_irq_t;
 
 /*******************************************************************************
  * VARIABLES WITH GLOBAL SCOPE
  ******************************************************************************/
 
-static void (*(drivers[5][32]))(void);
+static pin_irq_t pinIrqs[GPIO_PORT_COUNT][32];
+
+#ifdef ISR_PROFILER_ENABLED
+// Profiles of the interrupts of each port
+static isr_profile_t portProfiles[GPIO_PORT_COUNT];
+static const char* portProfileNames[GPIO_PORT_COUNT] = { "porta", "portb", "portc", "portd", "porte" };
+#endif
 
 /*******************************************************************************
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
@@ -60,13 +74,17 @@ static void clockGateEnable(pin_t pin);
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+static PORT_Type* const portBases[GPIO_PORT_COUNT] = PORT_BASE_PTRS;
+static GPIO_Type* const gpioBases[GPIO_PORT_COUNT] = GPIO_BASE_PTRS;
 
 
 /*******************************************************************************
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
-
+// Pins of each port in the interrupt modes, the flags of the pins in the DMA
+// modes are cleared by their requests, not by the port interrupt
+static uint32_t irqPins[GPIO_PORT_COUNT];
 
 /*******************************************************************************
  *******************************************************************************
@@ -134,105 +152,249 @@ static void clockGateEnable(pin_t pin)
 
 void gpioMode (pin_t pin, uint32_t mode)
 {
-	// Handy use of port and gpio pointers
-	PORT_Type* ports[] = PORT_BASE_PTRS;
-	GPIO_Type* gpios[] = GPIO_BASE_PTRS;
 	uint32_t setting = mode;
 
 	// Enabling the gate for the clock of each pin
 	clockGateEnable(pin);
 
 	// Save the current status of gpioIRQ
-	mode = ports[PIN2PORT(pin)]->PCR[PIN2NUM(pin)] & PORT_PCR_IRQC_MASK;
+	mode = portBases[PIN2PORT(pin)]->PCR[PIN2NUM(pin)] & PORT_PCR_IRQC_MASK;
 
 	// K64F converting mode flags
 	mode |= SETTING(setting, INPUT) 	| SETTING(setting, OUTPUT) 		| SETTING(setting, PULLDOWN) 	|  SETTING(setting, PULLUP);
 	mode |= SETTING(setting, SLEWRATE) 	| SETTING(setting, OPENDRAIN) 	| SETTING(setting, LOCK) 		|  SETTING(setting, GPIO_FILTER);
 
 	// Setting MUX to GPIO alternative.
-	ports[PIN2PORT(pin)]->PCR[PIN2NUM(pin)] = ( GPIO_MASK | ( mode & ~TYPE_MASK ) );
+	portBases[PIN2PORT(pin)]->PCR[PIN2NUM(pin)] = ( GPIO_MASK | ( mode & ~TYPE_MASK ) );
 
 	// Setting GPIOs to read/write. If mode is OUTPUT, mode=1, otherwise it's an input.
-	gpios[PIN2PORT(pin)]->PDDR |= ( (mode & TYPE_MASK) == OUTPUT_K64F) << PIN2NUM(pin);
+	gpioBases[PIN2PORT(pin)]->PDDR |= ( (mode & TYPE_MASK) == OUTPUT_K64F) << PIN2NUM(pin);
 }
 
 void gpioToggle (pin_t pin)
 {
-	// Port pointer, back up interrupt status flag
-	GPIO_Type* gpios[] = GPIO_BASE_PTRS;
-
-	// Toggling pin.
-	gpios[PIN2PORT(pin)]->PTOR |= 1 << PIN2NUM(pin);
+	// Toggling pin, PTOR reads as zero and only acts on the bits written
+	gpioHandleToggle(gpioHandle(pin));
 }
 
 void gpioWrite (pin_t pin, bool value)
 {
-	// Port pointer, back up interrupt status flag
-	GPIO_Type* gpios[] = GPIO_BASE_PTRS;
-	uint32_t mask = 0x1 << PIN2NUM(pin);
+	// Set and clear registers, no read-modify-write of PDOR which could
+	// undo the write of an interrupt on the same port
+	gpioHandleWrite(gpioHandle(pin), value);
+}
+
+bool gpioRead (pin_t pin)
+{
+	return gpioHandleRead(gpioHandle(pin));
+}
+
+void gpioWritePort (uint8_t port, uint32_t mask, uint32_t value)
+{
+	// Set and clear registers only change the pins written with one
+	gpioBases[port]->PSOR = value & mask;
+	gpioBases[port]->PCOR = ~value & mask;
+}
+
+void gpioSetMask (uint8_t port, uint32_t mask)
+{
+	gpioBases[port]->PSOR = mask;
+}
+
+void gpioClearMask (uint8_t port, uint32_t mask)
+{
+	gpioBases[port]->PCOR = mask;
+}
+
+void gpioToggleMask (uint8_t port, uint32_t mask)
+{
+	gpioBases[port]->PTOR = mask;
+}
+
+uint32_t gpioReadPort (uint8_t port)
+{
+	return gpioBases[port]->PDIR;
+}
+
+bool gpioGroupInit (gpio_group_t* group, const pin_t* pins, uint8_t count)
+{
+	bool succeed = false;
 
-	if (value == HIGH)
+	if (group && pins && count <= GPIO_GROUP_MAX_PINS)
 	{
-		gpios[PIN2PORT(pin)]->PDOR |= mask;
+		group->count = count;
+		group->ports = 0;
+		for (uint8_t port = 0 ; port < GPIO_PORT_COUNT ; port++)
+		{
+			group->masks[port] = 0;
+		}
+
+		// Port and mask of each bit, and the pins used in each port
+		for (uint8_t i = 0 ; i < count ; i++)
+		{
+			group->port[i] = PIN2PORT(pins[i]);
+			group->bit[i] = 1UL << PIN2NUM(pins[i]);
+			group->masks[group->port[i]] |= group->bit[i];
+			group->ports |= 1 << group->port[i];
+		}
+		succeed = true;
 	}
-	else
+
+	return succeed;
+}
+
+void gpioGroupMode (const gpio_group_t* group, uint32_t mode)
+{
+	for (uint8_t i = 0 ; i < group->count ; i++)
 	{
-		gpios[PIN2PORT(pin)]->PDOR &= (~mask);
+		gpioMode(PORTNUM2PIN(group->port[i], __builtin_ctz(group->bit[i])), mode);
 	}
 }
 
-bool gpioRead (pin_t pin)
+void gpioGroupWrite (const gpio_group_t* group, uint32_t value)
 {
-	// Port pointer, back up interrupt status flag
-	GPIO_Type* gpios[] = GPIO_BASE_PTRS;
+	uint32_t set[GPIO_PORT_COUNT] = { 0 };
+
+	// Pins of each port to be set, the rest of the group is cleared
+	for (uint8_t i = 0 ; i < group->count ; i++, value >>= 1)
+	{
+		if (value & 1)
+		{
+			set[group->port[i]] |= group->bit[i];
+		}
+	}
 
-	return (gpios[PIN2PORT(pin)]->PDIR & (1 << PIN2NUM(pin)) ) != LOW;
+	for (uint8_t port = 0 ; port < GPIO_PORT_COUNT ; port++)
+	{
+		if (group->ports & (1 << port))
+		{
+			gpioBases[port]->PSOR = set[port];
+			gpioBases[port]->PCOR = group->masks[port] & ~set[port];
+		}
+	}
 }
 
-bool gpioIRQ (pin_t pin, uint8_t irqMode, pinIrqFun_t irqFun)
+uint32_t gpioGroupRead (const gpio_group_t* group)
 {
-	PORT_Type* ports[] = PORT_BASE_PTRS;
-	IRQn_Type irqs[] = PORT_IRQS;
+	uint32_t inputs[GPIO_PORT_COUNT];
+	uint32_t value = 0;
 
+	// Every port is read once, so the pins are sampled together
+	for (uint8_t port = 0 ; port < GPIO_PORT_COUNT ; port++)
+	{
+		if (group->ports & (1 << port))
+		{
+			inputs[port] = gpioBases[port]->PDIR;
+		}
+	}
+
+	for (uint8_t i = 0 ; i < group->count ; i++)
+	{
+		if (inputs[group->port[i]] & group->bit[i])
+		{
+			value |= 1UL << i;
+		}
+	}
+
+	return value;
+}
+
+bool gpioIRQ (pin_t pin, uint8_t irqMode, pinIrqFun_t irqFun)
+{
 	if (irqFun || irqMode == GPIO_IRQ_MODE_DISABLE)
 	{
-		// PCR interruption mode configuration
-		ports[PIN2PORT(pin)]->PCR[PIN2NUM(pin)] |= PORT_PCR_IRQC(irqMode);
 		if (irqMode != GPIO_IRQ_MODE_DISABLE)
 		{
 			// Setting the driver's routine
-			drivers[PIN2PORT(pin)][PIN2NUM(pin)] = irqFun;
-
-			// NVIC local enable for the interrupt
-			NVIC_EnableIRQ(irqs[PIN2PORT(pin)]);
+			pin_irq_t* irq = &pinIrqs[PIN2PORT(pin)][PIN2NUM(pin)];
+			irq->callback = irqFun;
+			irq->contextCallback = NULL;
 		}
+		gpioIRQMode(pin, irqMode);
 	}
 
 	return !(irqFun);
 }
 
-void portHandler(uint8_t port)
+bool gpioIRQContext (pin_t pin, uint8_t irqMode, pinIrqCtxFun_t irqFun, void* context)
 {
-	// Port pointer, back up interrupt status flag
-	PORT_Type* ports[] = PORT_BASE_PTRS;
-	uint32_t isfr = ports[port]->ISFR;
-
-	// Clear interrupt status flag for every pin in the port
-	ports[port]->ISFR = 0xFFFFFFFF;
+	bool succeed = false;
 
-	// Verify which pin was interrupted, dispatches
-	uint8_t i = 0;
-	for (i = 0; i < 32 && isfr; i++)
+	if (irqFun || irqMode == GPIO_IRQ_MODE_DISABLE)
 	{
-		if (isfr & 1)
+		if (irqMode != GPIO_IRQ_MODE_DISABLE)
 		{
-			if (drivers[port][i])
-			{
-				drivers[port][i]();
-			}
+			// Setting the driver's routine
+			pin_irq_t* irq = &pinIrqs[PIN2PORT(pin)][PIN2NUM(pin)];
+			irq->context = context;
+			irq->contextCallback = irqFun;
+			irq->callback = NULL;
 		}
+		gpioIRQMode(pin, irqMode);
+		succeed = true;
+	}
+
+	return succeed;
+}
+
+uint32_t gpioIRQEdges (pin_t pin)
+{
+	return pinIrqs[PIN2PORT(pin)][PIN2NUM(pin)].edges;
+}
+
+void gpioIRQMode (pin_t pin, uint8_t irqMode)
+{
+	IRQn_Type irqs[] = PORT_IRQS;
+	uint8_t port = PIN2PORT(pin);
+	uint32_t pcr = portBases[port]->PCR[PIN2NUM(pin)] & ~(PORT_PCR_IRQC_MASK | PORT_PCR_ISF_MASK);
+	bool interrupt = irqMode >= GPIO_IRQ_MODE_INTERRUPT_LOGIC_0;
+
+	// The flag of a pin in an interrupt mode is always cleared by the port
+	// interrupt, so the pin is added before its mode and removed after it
+	if (interrupt)
+	{
+		irqPins[port] |= 1UL << PIN2NUM(pin);
+	}
+
+	// PCR interruption mode configuration, writing the flag clears it, so the
+	// new mode starts without pending edges
+	portBases[port]->PCR[PIN2NUM(pin)] = pcr | PORT_PCR_IRQC(irqMode) | PORT_PCR_ISF_MASK;
+
+	if (interrupt)
+	{
+		// NVIC local enable for the interrupt
+		NVIC_EnableIRQ(irqs[port]);
+		ISR_PROFILE_REGISTER(portProfileNames[port], &portProfiles[port]);
+	}
+	else
+	{
+		irqPins[port] &= ~(1UL << PIN2NUM(pin));
+	}
+}
+
+void portHandler(uint8_t port)
+{
+	// Only the flags read are cleared, so an edge arriving meanwhile keeps
+	// its flag and requests the interrupt again. The flags of the pins in the
+	// DMA modes are left, clearing them would drop their pending requests.
+	uint32_t isfr = portBases[port]->ISFR & irqPins[port];
+	portBases[port]->ISFR = isfr;
+
+	// Only the pins interrupted are visited, from the lowest one
+	while (isfr)
+	{
+		pin_irq_t* irq = &pinIrqs[port][__builtin_ctz(isfr)];
+		isfr &= isfr - 1;
 
-		isfr = isfr >> 1;
+		irq->edges++;
+		if (irq->contextCallback)
+		{
+			irq->contextCallback(irq->context);
+		}
+		else if (irq->callback)
+		{
+			irq->callback();
+		}
 	}
 }
 
@@ -244,27 +406,37 @@ void portHandler(uint8_t port)
 
 void PORTA_IRQHandler(void)
 {
+	ISR_PROFILE_BEGIN();
 	portHandler(PA);
+	ISR_PROFILE_END(&portProfiles[PA]);
 }
 
 void PORTB_IRQHandler(void)
 {
+	ISR_PROFILE_BEGIN();
 	portHandler(PB);
+	ISR_PROFILE_END(&portProfiles[PB]);
 }
 
 void PORTC_IRQHandler(void)
 {
+	ISR_PROFILE_BEGIN();
 	portHandler(PC);
+	ISR_PROFILE_END(&portProfiles[PC]);
 }
 
 void PORTD_IRQHandler(void)
 {
+	ISR_PROFILE_BEGIN();
 	portHandler(PD);
+	ISR_PROFILE_END(&portProfiles[PD]);
 }
 
 void PORTE_IRQHandler(void)
 {
+	ISR_PROFILE_BEGIN();
 	portHandler(PE);
+	ISR_PROFILE_END(&portProfiles[PE]);
 }
 
 /******************************************************************************/
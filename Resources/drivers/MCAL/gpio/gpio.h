@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include "MK64F12.h"
+
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
@@ -21,6 +23,8 @@
 // Ports declaration
 enum { PA, PB, PC, PD, PE };
 
+#define GPIO_PORT_COUNT     5
+
 // Convert port and number into pin ID
 // Ex: PTB5  -> PORTNUM2PIN(PB,5)  -> 0x25
 //     PTC22 -> PORTNUM2PIN(PC,22) -> 0x56
@@ -28,6 +32,10 @@ enum { PA, PB, PC, PD, PE };
 #define PIN2PORT(p)         (((p)>>5) & 0x07)
 #define PIN2NUM(p)          ((p) & 0x1F)
 
+// Handle of a pin, resolved at compile time when the pin is constant
+// Ex: static const gpio_handle_t led = GPIO_HANDLE(PORTNUM2PIN(PB,22));
+#define GPIO_HANDLE(p)      { (GPIO_Type*)(GPIOA_BASE + PIN2PORT(p) * (GPIOB_BASE - GPIOA_BASE)), 1UL << PIN2NUM(p) }
+
 // Modes of configuration for each pin, optional settings can be appendeable 
 // using INPUT | PULLDOWN | LOCK, for example...
 #define INPUT             0x001
@@ -65,6 +73,11 @@ enum {
 
 #define GPIO_IRQ_CANT_MODES 9
 
+// Maximum amount of pins of a group, one for each bit of its value, up to 32
+#ifndef GPIO_GROUP_MAX_PINS
+#define GPIO_GROUP_MAX_PINS 32
+#endif
+
 
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
@@ -74,6 +87,40 @@ typedef uint8_t pin_t;
 
 typedef void (*pinIrqFun_t)(void);
 
+// Callback of a pin IRQ with the context given when registered, so the same
+// function can serve many pins, for example each channel of an encoder
+typedef void (*pinIrqCtxFun_t)(void* context);
+
+// Pin handles
+// A handle keeps the GPIO block and the mask of a pin, so the inline
+// operations below are a single store to PSOR, PCOR or PTOR, or a single
+// load of PDIR. Those registers only act on the bits written with one,
+// so they are safe against interrupts using other pins of the same port.
+typedef struct {
+    GPIO_Type*  gpio;       // GPIO block of the port
+    uint32_t    mask;       // Mask of the pin in its port
+} gpio_handle_t;
+
+// Pin groups
+// A group maps the bits of a logical value to pins, which can be on different
+// ports, for example the segments of a display. The masks of each port are
+// computed once by gpioGroupInit(), so writing the group is one store to
+// PSOR and one to PCOR of each port used, instead of a read-modify-write
+// of PDOR for each pin.
+//
+// static const pin_t pins[] = { SEG_A, SEG_B, SEG_C };
+// static gpio_group_t segments;
+//
+// gpioGroupInit(&segments, pins, 3);
+// gpioGroupWrite(&segments, 0x5);	// SEG_A and SEG_C high, SEG_B low
+typedef struct {
+    uint8_t   count;                          // Amount of pins, bit 0 is the first one
+    uint8_t   ports;                          // Bit mask of the ports used
+    uint8_t   port[GPIO_GROUP_MAX_PINS];      // Port of each bit
+    uint32_t  bit[GPIO_GROUP_MAX_PINS];       // Mask of the pin of each bit, in its port
+    uint32_t  masks[GPIO_PORT_COUNT];         // Mask of the pins used in each port
+} gpio_group_t;
+
 /*******************************************************************************
  * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -98,6 +145,35 @@ void gpioMode (pin_t pin, uint32_t mode);
  */
 bool gpioIRQ (pin_t pin, uint8_t irqMode, pinIrqFun_t irqFun);
 
+/**
+ * @brief Configures how the pin reacts when an IRQ event ocurrs, the function
+ *        is called with the context given
+ * @param pin the pin whose IRQ mode you wish to set (according PORTNUM2PIN)
+ * @param irqMode disable, risingEdge, fallingEdge or bothEdges
+ * @param irqFun function to call on pin event
+ * @param context pointer passed to the function
+ * @return Registration succeed
+ */
+bool gpioIRQContext (pin_t pin, uint8_t irqMode, pinIrqCtxFun_t irqFun, void* context);
+
+/**
+ * @brief Sets the IRQ mode of the pin, replacing the previous one and clearing
+ *        its flag, the callback registered is kept. Only the pins in the
+ *        interrupt modes are dispatched by the port interrupt, so the flags of
+ *        the pins in the DMA modes, set by drivers such as gpio_capture, are
+ *        left to their requests.
+ * @param pin the pin whose IRQ mode you wish to set (according PORTNUM2PIN)
+ * @param irqMode any of the IRQ modes, also the DMA ones
+ */
+void gpioIRQMode (pin_t pin, uint8_t irqMode);
+
+/**
+ * @brief Returns the amount of IRQ events of the pin, counted by the port
+ *        interrupt and wrapping at 32 bits
+ * @param pin the pin (according PORTNUM2PIN)
+ */
+uint32_t gpioIRQEdges (pin_t pin);
+
 /**
  * @brief Write a HIGH or a LOW value to a digital pin
  * @param pin the pin to write (according PORTNUM2PIN)
@@ -118,6 +194,137 @@ void gpioToggle (pin_t pin);
  */
 bool gpioRead (pin_t pin);
 
+/**
+ * @brief Writes the pins of a port selected by the mask, the others are not
+ *        changed. Safe against interrupts writing other pins of the port.
+ * @param port the port to write (PA, PB, PC, PD or PE)
+ * @param mask pins to write, bit n is pin n of the port
+ * @param value values of the pins, only the bits in the mask are used
+ */
+void gpioWritePort (uint8_t port, uint32_t mask, uint32_t value);
+
+/**
+ * @brief Sets HIGH the pins of a port selected by the mask
+ * @param port the port to write (PA, PB, PC, PD or PE)
+ * @param mask pins to set, bit n is pin n of the port
+ */
+void gpioSetMask (uint8_t port, uint32_t mask);
+
+/**
+ * @brief Clears to LOW the pins of a port selected by the mask
+ * @param port the port to write (PA, PB, PC, PD or PE)
+ * @param mask pins to clear, bit n is pin n of the port
+ */
+void gpioClearMask (uint8_t port, uint32_t mask);
+
+/**
+ * @brief Toggles the pins of a port selected by the mask
+ * @param port the port to write (PA, PB, PC, PD or PE)
+ * @param mask pins to toggle, bit n is pin n of the port
+ */
+void gpioToggleMask (uint8_t port, uint32_t mask);
+
+/**
+ * @brief Reads every pin of a port at the same time
+ * @param port the port to read (PA, PB, PC, PD or PE)
+ * @return Values of the pins, bit n is pin n of the port
+ */
+uint32_t gpioReadPort (uint8_t port);
+
+/**
+ * @brief Computes the port masks of a group of pins, the pins are not configured
+ * @param group the group to initialize
+ * @param pins the pins of each bit of the group, from bit 0 (according PORTNUM2PIN)
+ * @param count amount of pins, up to GPIO_GROUP_MAX_PINS
+ * @return Initialization succeed
+ */
+bool gpioGroupInit (gpio_group_t* group, const pin_t* pins, uint8_t count);
+
+/**
+ * @brief Configures every pin of the group, as gpioMode()
+ * @param group the group to configure
+ * @param mode INPUT, OUTPUT, INPUT_PULLUP or INPUT_PULLDOWN.
+ */
+void gpioGroupMode (const gpio_group_t* group, uint32_t mode);
+
+/**
+ * @brief Writes every pin of the group, with one store to PSOR and PCOR of each port
+ * @param group the group to write
+ * @param value bit n is the value of the pin n of the group
+ */
+void gpioGroupWrite (const gpio_group_t* group, uint32_t value);
+
+/**
+ * @brief Reads every pin of the group, with one read of PDIR of each port
+ * @param group the group to read
+ * @return Bit n is the value of the pin n of the group
+ */
+uint32_t gpioGroupRead (const gpio_group_t* group);
+
+
+/**
+ * @brief Returns the handle of a pin, for pins known only at run time
+ * @param pin the pin (according PORTNUM2PIN)
+ */
+static inline gpio_handle_t gpioHandle (pin_t pin)
+{
+    gpio_handle_t handle = GPIO_HANDLE(pin);
+    return handle;
+}
+
+/**
+ * @brief Sets the pin HIGH
+ * @param handle the handle of the pin
+ */
+static inline void gpioHandleSet (gpio_handle_t handle)
+{
+    handle.gpio->PSOR = handle.mask;
+}
+
+/**
+ * @brief Clears the pin to LOW
+ * @param handle the handle of the pin
+ */
+static inline void gpioHandleClear (gpio_handle_t handle)
+{
+    handle.gpio->PCOR = handle.mask;
+}
+
+/**
+ * @brief Toggles the pin (HIGH<->LOW)
+ * @param handle the handle of the pin
+ */
+static inline void gpioHandleToggle (gpio_handle_t handle)
+{
+    handle.gpio->PTOR = handle.mask;
+}
+
+/**
+ * @brief Writes a HIGH or a LOW value to the pin
+ * @param handle the handle of the pin
+ * @param value Desired value (HIGH or LOW)
+ */
+static inline void gpioHandleWrite (gpio_handle_t handle, bool value)
+{
+    if (value)
+    {
+        handle.gpio->PSOR = handle.mask;
+    }
+    else
+    {
+        handle.gpio->PCOR = handle.mask;
+    }
+}
+
+/**
+ * @brief Reads the value of the pin
+ * @param handle the handle of the pin
+ * @return HIGH or LOW
+ */
+static inline bool gpioHandleRead (gpio_handle_t handle)
+{
+    return (handle.gpio->PDIR & handle.mask) != LOW;
+}
 
 /*******************************************************************************
  ******************************************************************************/
@@ -0,0 +1,265 @@
+/*******************************************************************************
+  @file     gpio_capture.c
+  @brief    GPIO edge capture with DMA, samples of a port into a ring buffer
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "MK64F12.h"
+#include "hardware.h"
+#include "gpio_capture.h"
+#include "../../../lib/isr_profiler/isr_profiler.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#if GPIO_CAPTURE_DMA_CHANNEL > 14
+#error "GPIO_CAPTURE_DMA_CHANNEL must leave the next channel for the timestamps"
+#endif
+
+#define PORT_CHANNEL            GPIO_CAPTURE_DMA_CHANNEL
+#define TIMER_CHANNEL           (GPIO_CAPTURE_DMA_CHANNEL + 1)
+
+// DMAMUX sources of the ports, from PORTA
+#define DMAMUX_SOURCE_PORTA     49
+
+// Interrupt handler of the port channel
+#define CAPTURE_IRQ_HANDLER_(channel)   DMA##channel##_IRQHandler
+#define CAPTURE_IRQ_HANDLER(channel)    CAPTURE_IRQ_HANDLER_(channel)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Returns the samples written by the port channel in the current major loop
+ */
+static size_t capturePosition(void);
+
+__ISR__ CAPTURE_IRQ_HANDLER(GPIO_CAPTURE_DMA_CHANNEL)(void);
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static GPIO_Type* const     gpioBases[] = GPIO_BASE_PTRS;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static gpio_capture_cfg_t   capture;            // Configuration of the capture running
+static volatile bool        running = false;    // Whether the capture is running
+static volatile bool        full = false;       // Whether the buffer was filled, when not looping
+static uint8_t              nextHalf;           // Half of the buffer the callback gets next, 0 or 1
+
+#ifdef ISR_PROFILER_ENABLED
+// Profile of the interrupt of the port channel
+static isr_profile_t        captureProfile;
+#endif
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool gpioCaptureStart (gpio_capture_cfg_t config)
+{
+	bool succeed = false;
+	bool timestamped = config.timestamps && config.timer;
+	size_t maxCount = timestamped ? GPIO_CAPTURE_MAX_TIMESTAMPED : GPIO_CAPTURE_MAX_SAMPLES;
+
+	if (!running && config.samples && config.count >= 2 && config.count <= maxCount && (config.count % 2) == 0
+		&& config.edge >= GPIO_IRQ_MODE_DMA_RISING_EDGE && config.edge <= GPIO_IRQ_MODE_DMA_BOTH_EDGES)
+	{
+		uint8_t port = PIN2PORT(config.trigger);
+		uint16_t citer = config.count;
+
+		capture = config;
+		if (!timestamped)
+		{
+			capture.timestamps = NULL;
+		}
+		full = false;
+		nextHalf = 0;
+
+		// Clock gating of the DMA and DMAMUX
+		SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+		SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+		// Stale flags of the trigger would request a sample right away
+		gpioIRQMode(config.trigger, GPIO_IRQ_MODE_DISABLE);
+		DMAMUX->CHCFG[PORT_CHANNEL] = 0;
+
+		if (timestamped)
+		{
+			// The timer channel runs one minor loop after each one of the port channel,
+			// linked on every minor loop and also on the last one of the major loop
+			DMA0->TCD[TIMER_CHANNEL].SADDR = (uint32_t)(config.timer);
+			DMA0->TCD[TIMER_CHANNEL].SOFF = 0;
+			DMA0->TCD[TIMER_CHANNEL].DADDR = (uint32_t)(config.timestamps);
+			DMA0->TCD[TIMER_CHANNEL].DOFF = sizeof(uint32_t);
+			DMA0->TCD[TIMER_CHANNEL].ATTR = DMA_ATTR_SSIZE(2) | DMA_ATTR_DSIZE(2);
+			DMA0->TCD[TIMER_CHANNEL].NBYTES_MLNO = sizeof(uint32_t);
+			DMA0->TCD[TIMER_CHANNEL].SLAST = 0;
+			DMA0->TCD[TIMER_CHANNEL].DLAST_SGA = config.loop ? -(int32_t)(config.count * sizeof(uint32_t)) : 0;
+			DMA0->TCD[TIMER_CHANNEL].CSR = 0;
+			DMA0->TCD[TIMER_CHANNEL].BITER_ELINKNO = config.count;
+			DMA0->TCD[TIMER_CHANNEL].CITER_ELINKNO = config.count;
+			citer = DMA_CITER_ELINKYES_ELINK(1) | DMA_CITER_ELINKYES_LINKCH(TIMER_CHANNEL) | DMA_CITER_ELINKYES_CITER(config.count);
+		}
+
+		// The port channel copies the PDIR on each request of the port
+		DMA0->TCD[PORT_CHANNEL].SADDR = (uint32_t)(&gpioBases[port]->PDIR);
+		DMA0->TCD[PORT_CHANNEL].SOFF = 0;
+		DMA0->TCD[PORT_CHANNEL].DADDR = (uint32_t)(config.samples);
+		DMA0->TCD[PORT_CHANNEL].DOFF = sizeof(uint32_t);
+		DMA0->TCD[PORT_CHANNEL].ATTR = DMA_ATTR_SSIZE(2) | DMA_ATTR_DSIZE(2);
+		DMA0->TCD[PORT_CHANNEL].NBYTES_MLNO = sizeof(uint32_t);
+		DMA0->TCD[PORT_CHANNEL].SLAST = 0;
+		DMA0->TCD[PORT_CHANNEL].DLAST_SGA = config.loop ? -(int32_t)(config.count * sizeof(uint32_t)) : 0;
+		DMA0->TCD[PORT_CHANNEL].CSR = DMA_CSR_INTHALF(1) | DMA_CSR_INTMAJOR(1) | DMA_CSR_DREQ(!config.loop)
+									| (timestamped ? DMA_CSR_MAJORELINK(1) | DMA_CSR_MAJORLINKCH(TIMER_CHANNEL) : 0);
+		DMA0->TCD[PORT_CHANNEL].BITER_ELINKNO = citer;
+		DMA0->TCD[PORT_CHANNEL].CITER_ELINKNO = citer;
+
+		// Interrupt for the halves of the buffer
+		DMA0->CINT = DMA_CINT_CINT(PORT_CHANNEL);
+		NVIC_ClearPendingIRQ(DMA0_IRQn + PORT_CHANNEL);
+		NVIC_EnableIRQ(DMA0_IRQn + PORT_CHANNEL);
+		ISR_PROFILE_REGISTER("capture", &captureProfile);
+
+		// Routing the port to the channel, and the edges of the trigger to the port
+		running = true;
+		DMAMUX->CHCFG[PORT_CHANNEL] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_TRIG(0) | DMAMUX_CHCFG_SOURCE(DMAMUX_SOURCE_PORTA + port);
+		DMA0->SERQ = DMA_SERQ_SERQ(PORT_CHANNEL);
+		gpioIRQMode(config.trigger, config.edge);
+		succeed = true;
+	}
+
+	return succeed;
+}
+
+size_t gpioCaptureStop (void)
+{
+	size_t count = 0;
+
+	if (running || full)
+	{
+		// No more requests, then the samples already in the buffer are counted
+		gpioIRQMode(capture.trigger, GPIO_IRQ_MODE_DISABLE);
+		DMA0->CERQ = DMA_CERQ_CERQ(PORT_CHANNEL);
+		DMAMUX->CHCFG[PORT_CHANNEL] = 0;
+		NVIC_DisableIRQ(DMA0_IRQn + PORT_CHANNEL);
+
+		count = gpioCaptureCount();
+		running = false;
+		full = false;
+	}
+
+	return count;
+}
+
+size_t gpioCaptureCount (void)
+{
+	size_t count = 0;
+
+	if (full)
+	{
+		count = capture.count;
+	}
+	else if (running)
+	{
+		count = capturePosition();
+	}
+
+	return count;
+}
+
+bool gpioCaptureRunning (void)
+{
+	return running;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static size_t capturePosition(void)
+{
+	// The major loop count goes down from the length of the buffer, and is
+	// reloaded with it at the end of the major loop
+	uint16_t mask = capture.timestamps ? DMA_CITER_ELINKYES_CITER_MASK : DMA_CITER_ELINKNO_CITER_MASK;
+	return capture.count - (DMA0->TCD[PORT_CHANNEL].CITER_ELINKNO & mask);
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						INTERRUPT SERVICE ROUTINES
+ *******************************************************************************
+ ******************************************************************************/
+
+__ISR__ CAPTURE_IRQ_HANDLER(GPIO_CAPTURE_DMA_CHANNEL)(void)
+{
+	ISR_PROFILE_BEGIN();
+
+	// The flag is cleared between two reads of the position in the same half, so
+	// it is raised again only for a half filled after the second read
+	size_t half = capture.count / 2;
+	bool secondWritten;
+	do
+	{
+		secondWritten = capturePosition() >= half;
+		DMA0->CINT = DMA_CINT_CINT(PORT_CHANNEL);
+	} while ((capturePosition() >= half) != secondWritten);
+
+	// The timestamp of the last sample is copied right after it
+	if (capture.timestamps)
+	{
+		while (DMA0->TCD[TIMER_CHANNEL].CSR & (DMA_CSR_START_MASK | DMA_CSR_ACTIVE_MASK));
+	}
+
+	// The last half filled is the one the channel is not writing. When the
+	// interrupts of the half and of the end of the major loop merge, the flag
+	// is raised once for both halves.
+	uint8_t lastHalf = secondWritten ? 0 : 1;
+	uint8_t halves = lastHalf == nextHalf ? 1 : 2;
+
+	for (uint8_t i = 0 ; i < halves ; i++)
+	{
+		size_t offset = nextHalf ? half : 0;
+		nextHalf = !nextHalf;
+
+		if (!capture.loop && offset)
+		{
+			// The request was disabled at the end of the major loop
+			full = true;
+			running = false;
+			gpioIRQMode(capture.trigger, GPIO_IRQ_MODE_DISABLE);
+		}
+
+		if (capture.callback)
+		{
+			capture.callback(capture.samples + offset, capture.timestamps ? capture.timestamps + offset : NULL, half);
+		}
+	}
+
+	ISR_PROFILE_END(&captureProfile);
+}
+
+/******************************************************************************/
@@ -0,0 +1,103 @@
+/*******************************************************************************
+  @file     gpio_capture.h
+  @brief    GPIO edge capture with DMA, samples of a port into a ring buffer
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef _GPIO_CAPTURE_H_
+#define _GPIO_CAPTURE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "gpio.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// DMA channel which copies the port, the next one copies the timer when used.
+// Channel 0 is used by the PWM DMA driver.
+#ifndef GPIO_CAPTURE_DMA_CHANNEL
+#define GPIO_CAPTURE_DMA_CHANNEL      1
+#endif
+
+// Maximum amount of samples of the buffer, with and without timestamps. The
+// timer channel is linked to the port channel, which limits its major loop.
+#define GPIO_CAPTURE_MAX_SAMPLES      32767
+#define GPIO_CAPTURE_MAX_TIMESTAMPED  511
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Called from the DMA interrupt when a half of the buffer was filled, with
+// the samples of that half, and their timestamps or NULL
+typedef void (*gpio_capture_callback_t)(uint32_t* samples, uint32_t* timestamps, size_t count);
+
+// GPIO Capture
+// On each selected edge of the trigger pin, the DMA copies the PDIR of its
+// port into the next sample of the buffer, and optionally the count of a
+// timer into the timestamps, without interrupting the CPU. The interrupt only
+// runs when each half of the buffer is full, to call the callback, so the
+// application processes one half while the other one is filled.
+//
+// static uint32_t samples[64];
+// gpio_capture_cfg_t config = { PIN_CLK, GPIO_IRQ_MODE_DMA_FALLING_EDGE, samples, NULL, 64, NULL, true, onHalf };
+//
+// gpioMode(PIN_CLK, INPUT);
+// gpioCaptureStart(config);
+typedef struct {
+    pin_t                     trigger;      // Pin whose edges request the samples, its port is sampled
+    uint8_t                   edge;         // GPIO_IRQ_MODE_DMA_RISING_EDGE, FALLING_EDGE or BOTH_EDGES
+    uint32_t*                 samples;      // Buffer of the samples of the port
+    uint32_t*                 timestamps;   // Buffer of the timestamps, same length, or NULL
+    size_t                    count;        // Length of the buffers, even
+    const volatile uint32_t*  timer;        // Counter register copied as timestamp, for example a PIT CVAL
+    bool                      loop;         // Whether the buffer is filled again when full
+    gpio_capture_callback_t   callback;     // Called with each half, or NULL
+} gpio_capture_cfg_t;
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Starts capturing the port of the trigger pin, which must be already
+ *        configured as input. Only one capture runs at a time.
+ * @param config Configuration of the capture
+ * @return Start succeed
+ */
+bool gpioCaptureStart (gpio_capture_cfg_t config);
+
+/**
+ * @brief Stops the capture, the trigger pin stops requesting the DMA
+ * @return Amount of samples in the buffer since its beginning
+ */
+size_t gpioCaptureStop (void);
+
+/**
+ * @brief Returns the amount of samples in the buffer since its beginning,
+ *        restarting from zero when the buffer loops
+ */
+size_t gpioCaptureCount (void);
+
+/**
+ * @brief Returns whether the capture is running, it stops by itself when the
+ *        buffer is full and not looping
+ */
+bool gpioCaptureRunning (void);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // _GPIO_CAPTURE_H_
@@ -12,6 +12,7 @@
 #include "MK64F12.h"
 #include "hardware.h"
 #include "drivers/MCAL/gpio/gpio.h"
+#include "lib/isr_profiler/isr_profiler.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -97,6 +98,12 @@ __ISR__   I2C2_IRQHandler(void);
 // I2C memory map pointer and context instances used to control the peripheral
 static uint8_t 			    i2cIrqs[] = I2C_IRQS;
 static I2C_Type * 		  i2cPointers[] = I2C_BASE_PTRS;
+
+#ifdef ISR_PROFILER_ENABLED
+// Profiles of the interrupts of each instance
+static isr_profile_t      i2cProfiles[I2C_INSTANCE_COUNT];
+static const char*        i2cProfileNames[I2C_INSTANCE_COUNT] = { "i2c0", "i2c1", "i2c2" };
+#endif
 static i2c_instance_t 	i2cInstances[I2C_INSTANCE_COUNT] = {
   { I2C_STATE_IDLE },
   { I2C_STATE_IDLE },
@@ -160,6 +167,7 @@ void i2cMasterInit(i2c_id_t id, uint32_t baudRate)
 
     // Enable the NVIC for the I2C peripheral
     NVIC_EnableIRQ(i2cIrqs[id]);
+    ISR_PROFILE_REGISTER(i2cProfileNames[id], &i2cProfiles[id]);
 
     // Enable I2C module and interrupts
     i2cPointers[id]->S = I2C_S_TCF_MASK | I2C_S_IICIF_MASK;
@@ -381,17 +389,23 @@ void I2C_IRQDispatcher(i2c_id_t id)
 
 __ISR__ I2C0_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   I2C_IRQDispatcher(I2C_INSTANCE_0);
+  ISR_PROFILE_END(&i2cProfiles[I2C_INSTANCE_0]);
 }
 
 __ISR__ I2C1_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   I2C_IRQDispatcher(I2C_INSTANCE_1);
+  ISR_PROFILE_END(&i2cProfiles[I2C_INSTANCE_1]);
 }
 
 __ISR__ I2C2_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   I2C_IRQDispatcher(I2C_INSTANCE_2);
+  ISR_PROFILE_END(&i2cProfiles[I2C_INSTANCE_2]);
 }
 
 /******************************************************************************/
@@ -0,0 +1,180 @@
+/*******************************************************************************
+  @file     pit.c
+  @brief    PIT Driver, free running tick time base and one shot alarm
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "hardware.h"
+#include "pit.h"
+#include "../../../CMSIS/MK64F12.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define PIT_CHANNEL_PRESCALER	0
+#define PIT_CHANNEL_TICKS		1
+#define PIT_CHANNEL_ALARM		2
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Reads the time base, both channels from the same tick
+ * @param cycles	Count of channel 0, the cycles until the next tick minus one
+ * @return Ticks since the time base started
+ */
+static uint32_t readTimebase(uint32_t* cycles);
+
+__ISR__ PIT2_IRQHandler(void);
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint32_t			tickCycles;			// Bus clock cycles of each tick
+static uint32_t			alarmTick;			// Tick of the alarm running
+static pit_callback_t	alarmCallback;		// Callback of the alarm running
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void pitTimebaseInit(uint32_t cyclesPerTick)
+{
+	tickCycles = cyclesPerTick;
+
+	// Enable the clock gating and the module, the timers are frozen
+	// while debugging
+	SIM->SCGC6 |= SIM_SCGC6_PIT_MASK;
+	PIT->MCR = PIT_MCR_FRZ_MASK;
+
+	// Channel 1 counts down the ticks of channel 0, both reloaded when reaching zero
+	PIT->CHANNEL[PIT_CHANNEL_PRESCALER].TCTRL = 0;
+	PIT->CHANNEL[PIT_CHANNEL_TICKS].TCTRL = 0;
+	PIT->CHANNEL[PIT_CHANNEL_PRESCALER].LDVAL = cyclesPerTick - 1;
+	PIT->CHANNEL[PIT_CHANNEL_TICKS].LDVAL = 0xFFFFFFFF;
+	PIT->CHANNEL[PIT_CHANNEL_TICKS].TCTRL = PIT_TCTRL_CHN_MASK | PIT_TCTRL_TEN_MASK;
+	PIT->CHANNEL[PIT_CHANNEL_PRESCALER].TCTRL = PIT_TCTRL_TEN_MASK;
+
+	// The alarm is stopped until requested
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TCTRL = 0;
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TFLG = PIT_TFLG_TIF_MASK;
+	NVIC_EnableIRQ(PIT2_IRQn);
+}
+
+uint32_t pitTimebaseTicks(void)
+{
+	uint32_t cycles;
+	return readTimebase(&cycles);
+}
+
+void pitAlarmAt(uint32_t tick, pit_callback_t callback)
+{
+	hardwareDisableInterrupts();
+
+	alarmTick = tick;
+	alarmCallback = callback;
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TCTRL = 0;
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TFLG = PIT_TFLG_TIF_MASK;
+
+	uint32_t cycles;
+	uint32_t ticks = readTimebase(&cycles);
+	int32_t ticksAhead = (int32_t)(tick - ticks);
+
+	if (ticksAhead <= 0)
+	{
+		NVIC_SetPendingIRQ(PIT2_IRQn);
+	}
+	else
+	{
+		// Alarms farther than the counter allows are loaded again when
+		// the first part elapses
+		uint32_t maxTicks = (0xFFFFFFFF - cycles) / tickCycles;
+		uint32_t wholeTicks = (uint32_t)ticksAhead - 1;
+		PIT->CHANNEL[PIT_CHANNEL_ALARM].LDVAL = cycles + (wholeTicks < maxTicks ? wholeTicks : maxTicks) * tickCycles;
+		PIT->CHANNEL[PIT_CHANNEL_ALARM].TCTRL = PIT_TCTRL_TIE_MASK | PIT_TCTRL_TEN_MASK;
+	}
+
+	hardwareEnableInterrupts();
+}
+
+void pitAlarmStop(void)
+{
+	hardwareDisableInterrupts();
+
+	alarmCallback = NULL;
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TCTRL = 0;
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TFLG = PIT_TFLG_TIF_MASK;
+	NVIC_ClearPendingIRQ(PIT2_IRQn);
+
+	hardwareEnableInterrupts();
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint32_t readTimebase(uint32_t* cycles)
+{
+	// Channel 1 counts down, read again if it changed meanwhile
+	uint32_t ticks;
+	do
+	{
+		ticks = PIT->CHANNEL[PIT_CHANNEL_TICKS].CVAL;
+		*cycles = PIT->CHANNEL[PIT_CHANNEL_PRESCALER].CVAL;
+	} while (ticks != PIT->CHANNEL[PIT_CHANNEL_TICKS].CVAL);
+
+	return ~ticks;
+}
+
+/*******************************************************************************
+ *******************************************************************************
+						INTERRUPT SERVICE ROUTINES
+ *******************************************************************************
+ ******************************************************************************/
+
+__ISR__ PIT2_IRQHandler(void)
+{
+	// One shot, the channel is stopped until the next alarm
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TFLG = PIT_TFLG_TIF_MASK;
+	PIT->CHANNEL[PIT_CHANNEL_ALARM].TCTRL = 0;
+
+	if (alarmCallback)
+	{
+		if ((int32_t)(pitTimebaseTicks() - alarmTick) < 0)
+		{
+			// Only the first part of a long alarm elapsed
+			pitAlarmAt(alarmTick, alarmCallback);
+		}
+		else
+		{
+			pit_callback_t callback = alarmCallback;
+			alarmCallback = NULL;
+			callback();
+		}
+	}
+}
+
+/******************************************************************************/
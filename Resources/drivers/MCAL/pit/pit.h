@@ -0,0 +1,70 @@
+/*******************************************************************************
+  @file     pit.h
+  @brief    PIT Driver, free running tick time base and one shot alarm
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef MCAL_PIT_PIT_H_
+#define MCAL_PIT_PIT_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// The PIT is clocked by the bus clock
+#define PIT_BUS_CLOCK_HZ		50000000U
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Channels 0 and 1 are chained as the time base, channel 0 divides the bus
+// clock down to one tick and channel 1 counts the ticks, so the time base
+// runs without interrupts. Channel 2 is the alarm, loaded with the cycles
+// until the boundary of the tick requested and stopped when it fires.
+typedef void (*pit_callback_t)(void);
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Starts the free running time base, from tick zero
+ * @param cyclesPerTick		Bus clock cycles of each tick
+ */
+void pitTimebaseInit(uint32_t cyclesPerTick);
+
+/**
+ * @brief Returns the ticks since the time base started, wrapping at 32 bits
+ */
+uint32_t pitTimebaseTicks(void);
+
+/**
+ * @brief Starts the alarm, the callback is called from the interrupt at the
+ * 		  beginning of the given tick, or right away if the tick already started.
+ * 		  Starting it again replaces the previous alarm.
+ * @param tick				Tick of the time base when the alarm fires
+ * @param callback			Callback to be called when the alarm fires
+ */
+void pitAlarmAt(uint32_t tick, pit_callback_t callback);
+
+/**
+ * @brief Stops the alarm, if running
+ */
+void pitAlarmStop(void);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif /* MCAL_PIT_PIT_H_ */
@@ -13,6 +13,7 @@
 #include "pwm_dma.h"
 #include "MK64F12.h"
 #include "hardware.h"
+#include "../../../lib/isr_profiler/isr_profiler.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -101,6 +102,11 @@ static pwmdma_context_t context;
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+#ifdef ISR_PROFILER_ENABLED
+// Profile of the interrupt of the DMA channel
+static isr_profile_t dmaProfile;
+#endif
+
 /*******************************************************************************
  *******************************************************************************
                         GLOBAL FUNCTION DEFINITIONS
@@ -132,6 +138,7 @@ void pwmdmaInit(uint8_t prescaler, uint16_t mod, ftm_instance_t ftmInstance, ftm
 
     // Enable NVIC for DMA channel 0
     NVIC_EnableIRQ(DMA0_IRQn);
+    ISR_PROFILE_REGISTER("dma0", &dmaProfile);
   
     // Enable DMAMUX for DMA_CHANNEL and select source
     DMAMUX->CHCFG[DMA_CHANNEL] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_TRIG(0) | DMAMUX_CHCFG_SOURCE(pwmdmaFtm2DmaChannel(context.ftmInstance, context.ftmChannel));
@@ -224,6 +231,7 @@ bool pwmdmaStart(uint16_t* firstFrame, uint16_t* secondFrame, size_t frameSize,
  ******************************************************************************/
 __ISR__ DMA0_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   uint16_t status = DMA0->INT;
 
   if (status & (DMA_INT_INT0_MASK << DMA_CHANNEL))
@@ -266,6 +274,8 @@ __ISR__ DMA0_IRQHandler(void)
       }
     } 
   }
+
+  ISR_PROFILE_END(&dmaProfile);
 }
 
 uint8_t pwmdmaFtm2DmaChannel(ftm_instance_t ftmInstance, ftm_channel_t ftmChannel)
@@ -14,7 +14,8 @@
 
 #include "../CMSIS/MK64F12.h"
 
-#include "lib/queue/queue.h"
+#include "lib/typed_queue/typed_queue.h"
+#include "lib/isr_profiler/isr_profiler.h"
 
 #include "hardware.h"
 
@@ -24,8 +25,9 @@
 
 #define SPI_PORT_ALTERNATIVE    2             // All pins have the SPI peripheral connected to the 2nd alternative
 #define SPI_CLOCK_FREQUENCY     100000000U    // Clock connected to the SPI peripheral in the MCU
-#define TX_QUEUE_MAX_SIZE       100           // Maximum size of the FIFO for transmitter
-#define RX_QUEUE_MAX_SIZE       100           // Maximum size of the FIFO for the receiver
+#define TX_QUEUE_MAX_SIZE       128           // Maximum size of the FIFO for transmitter, must be a power of two
+#define RX_QUEUE_MAX_SIZE       128           // Maximum size of the FIFO for the receiver, must be a power of two
+#define TX_PACKAGE_BATCH_SIZE   8             // Packages built in the stack before pushing them to the tx queue
 
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
@@ -60,6 +62,10 @@ typedef struct {
   uint16_t      frame;
 } spi_package_t;
 
+// Declaring the typed queues used for buffering
+DECLARE_QUEUE(spiTxQueue, spi_package_t, TX_QUEUE_MAX_SIZE)
+DECLARE_QUEUE(spiRxQueue, uint16_t, RX_QUEUE_MAX_SIZE)
+
 // Declaring SPI instance data structure
 typedef struct {
 
@@ -67,10 +73,8 @@ typedef struct {
   uint8_t           hwFifoSize;
 
   // Buffering interface  
-  spi_package_t     txBuffer[TX_QUEUE_MAX_SIZE];  // Data buffer for tx
-  uint16_t          rxBuffer[RX_QUEUE_MAX_SIZE];  // Data buffer for rx
-  queue_t           txQueue;                      // Queue instance for tx
-  queue_t           rxQueue;                      // Queue instance for rx
+  spiTxQueue_t      txQueue;                      // Queue instance for tx
+  spiRxQueue_t      rxQueue;                      // Queue instance for rx
 
   // Configuration of SPI hardware
   spi_cfg_t         config;
@@ -116,8 +120,8 @@ static uint32_t computeBaudRate(uint8_t dbr, uint8_t br, uint8_t pbr);
  * @param slave   		Slaves to be selected
  * @param message     Message to be sent
  * @param len         Message length
- * @param sendTrash   When true, message content is ignored and just the software queue
- *                    is incremented in len.If false, sends the message
+ * @param sendTrash   When true, message content is ignored and zeros are sent
+ *                    to the slaves. If false, sends the message
  * @return Whether it could send or not
  */
 static bool smartSend(spi_id_t id, spi_slave_id_t slave, const uint16_t message[], size_t len, bool sendTrash);
@@ -165,6 +169,22 @@ static spi_instance_t spiInstances[SPI_INSTANCE_AMOUNT] = {
 
 static uint8_t spiIrqs[] = SPI_IRQS;
 
+#ifdef QUEUE_STATS_ENABLED
+// Names of the queues registered in the queue statistics
+static const char* spiQueueNames[SPI_INSTANCE_AMOUNT][2] = {
+//  RX          TX
+  { "spi0.rx",  "spi0.tx" },
+  { "spi1.rx",  "spi1.tx" },
+  { "spi2.rx",  "spi2.tx" }
+};
+#endif
+
+#ifdef ISR_PROFILER_ENABLED
+// Profiles of the interrupts of each instance
+static isr_profile_t spiProfiles[SPI_INSTANCE_AMOUNT];
+static const char* spiProfileNames[SPI_INSTANCE_AMOUNT] = { "spi0", "spi1", "spi2" };
+#endif
+
 // Look-up table for the SPI Prescaler
 static uint8_t spiPrescaler[] = {
   2,
@@ -248,8 +268,11 @@ void spiInit(spi_id_t id, spi_slave_id_t slave, spi_cfg_t config)
   spiPointers[id]->MCR = (SPI0->MCR & ~SPI_MCR_MDIS_MASK) | SPI_MCR_MDIS(0);
 
   // Instance initialization
-  spiInstances[id].rxQueue = createQueue(spiInstances[id].rxBuffer, RX_QUEUE_MAX_SIZE, sizeof(uint16_t));
-  spiInstances[id].txQueue = createQueue(spiInstances[id].txBuffer, TX_QUEUE_MAX_SIZE, sizeof(spi_package_t));
+  spiRxQueueInit(&spiInstances[id].rxQueue);
+  spiTxQueueInit(&spiInstances[id].txQueue);
+  QUEUE_STATS_REGISTER(spiQueueNames[id][0], &spiInstances[id].rxQueue, RX_QUEUE_MAX_SIZE);
+  QUEUE_STATS_REGISTER(spiQueueNames[id][1], &spiInstances[id].txQueue, TX_QUEUE_MAX_SIZE);
+  ISR_PROFILE_REGISTER(spiProfileNames[id], &spiProfiles[id]);
 }
 
 bool spiSend(spi_id_t id, spi_slave_id_t slave, const uint16_t message[], size_t len)
@@ -259,7 +282,7 @@ bool spiSend(spi_id_t id, spi_slave_id_t slave, const uint16_t message[], size_t
 
 bool spiCanSend(spi_id_t id, size_t len)
 {
-  return emptySize(&(spiInstances[id].txQueue)) >= len; // checks for empty space in driver's tx queue
+  return spiTxQueueEmptySize(&(spiInstances[id].txQueue)) >= len; // checks for empty space in driver's tx queue
 }
 
 bool spiReceive(spi_id_t id, spi_slave_id_t slave, size_t len)
@@ -269,11 +292,11 @@ bool spiReceive(spi_id_t id, spi_slave_id_t slave, size_t len)
 
 bool spiRead(spi_id_t id, uint16_t readBuffer[], size_t len)
 {
-  queue_t *rxQueue = &(spiInstances[id].rxQueue);
+  spiRxQueue_t *rxQueue = &(spiInstances[id].rxQueue);
 
-  if (size(rxQueue) >= len) // check if there is enough data to copy
+  if (spiRxQueueSize(rxQueue) >= len) // check if there is enough data to copy
   {
-    popMany(rxQueue, (void*)readBuffer, len); // pop from rx queue
+    spiRxQueuePopMany(rxQueue, readBuffer, len); // pop from rx queue
     return true;
   }
   else
@@ -284,12 +307,12 @@ bool spiRead(spi_id_t id, uint16_t readBuffer[], size_t len)
 
 size_t spiGetReceiveCount(spi_id_t id)
 {
-  return size(&(spiInstances[id].rxQueue));
+  return spiRxQueueSize(&(spiInstances[id].rxQueue));
 }
 
 void spiReceiveFlush(spi_id_t id)
 {
-  clear(&(spiInstances[id].rxQueue));
+  spiRxQueueClear(&(spiInstances[id].rxQueue));
 }
 
 bool spiTransferComplete(spi_id_t id)
@@ -323,31 +346,32 @@ bool smartSend(spi_id_t id, spi_slave_id_t slave, const uint16_t message[], size
   }
 
   // If there is enough space, proceed to write the message in the software queue.
-  if (sendTrash)
+  // When sending trash, the slaves still need to be selected, so zeros are sent.
+  // Packages are built in batches and pushed with a single copy to the queue.
+  spi_package_t batch[TX_PACKAGE_BATCH_SIZE];
+  uint8_t       batchCount = 0;
+  for (size_t i = 0; i < len; i++)
   {
-    return pushTrash(&(spiInstances[id].txQueue), len);
-  }
-  else
-  {
-    for (uint8_t i=0; i < len; i++)
+    // Creating package.
+    batch[batchCount].slaves = slave;
+    batch[batchCount].frame = sendTrash ? 0 : message[i];
+    batch[batchCount].eoq = ( ((i % spiInstances[id].hwFifoSize) == (spiInstances[id].hwFifoSize - 1) && (i > 0)) || i == len-1)  ? 1 : 0;
+
+    // Pushing the batch of packages to software queue.
+    if (++batchCount == TX_PACKAGE_BATCH_SIZE || i == len - 1)
     {
-      // Creating package.
-      spi_package_t newPackage = {
-    		  .slaves = slave,
-			  .frame = message[i],
-			  .eoq = ( ((i % spiInstances[id].hwFifoSize) == (spiInstances[id].hwFifoSize - 1) && (i > 0)) || i == len-1)  ? 1 : 0
-      };
-      // Pushing package to software queue.
-      push(&(spiInstances[id].txQueue), (void *)(&newPackage));
+      spiTxQueuePushMany(&(spiInstances[id].txQueue), batch, batchCount);
+      batchCount = 0;
     }
   }
 
-  // If the transmission is not currently active (TXRXS is set), the firsts elements in the software queue
-  // should be sent to the hardware FIFO to start the transmission.
+  // If the transmission is not currently active (TXRXS is set), the TFFF interruption is enabled
+  // to send the firsts elements of the software queue to the hardware FIFO, it is raised right away
+  // because the FIFO is not full, so the ISR is the single consumer of the queue
   if ( (spiPointers[id]->SR & SPI_SR_TXRXS_MASK ) != SPI_SR_TXRXS_MASK)
   {
-    softQueue2HardFIFO(id);
     spiPointers[id]->MCR = (spiPointers[id]->MCR & ~SPI_MCR_HALT_MASK) | SPI_MCR_HALT(0);
+    spiPointers[id]->RSER |= SPI_RSER_TFFF_RE(1);
   }
 
   return true;
@@ -356,14 +380,13 @@ bool smartSend(spi_id_t id, spi_slave_id_t slave, const uint16_t message[], size
 void softQueue2HardFIFO(spi_id_t id)
 {
 
-  while ((spiPointers[id]->SR & SPI_SR_TFFF_MASK) && !isEmpty(&(spiInstances[id].txQueue)))
+  spi_package_t package;
+
+  while ((spiPointers[id]->SR & SPI_SR_TFFF_MASK) && spiTxQueuePop(&(spiInstances[id].txQueue), &package))
   {
-    // Getting package in software queue.
-    spi_package_t* package = (spi_package_t*)pop(&(spiInstances[id].txQueue));
-    
     // Writing message to hardware TX FIFO.
-    spiPointers[id]->PUSHR = SPI_PUSHR_CONT(spiInstances[id].config.continuousPcs) | SPI_PUSHR_CTAS(0b000) | SPI_PUSHR_EOQ(package->eoq) | 
-                             SPI_PUSHR_CTCNT(1) | SPI_PUSHR_PCS(package->slaves) | SPI_PUSHR_TXDATA(package->frame);
+    spiPointers[id]->PUSHR = SPI_PUSHR_CONT(spiInstances[id].config.continuousPcs) | SPI_PUSHR_CTAS(0b000) | SPI_PUSHR_EOQ(package.eoq) | 
+                             SPI_PUSHR_CTCNT(1) | SPI_PUSHR_PCS(package.slaves) | SPI_PUSHR_TXDATA(package.frame);
 
     // Clear the flag just in case
     spiPointers[id]->SR = SPI_SR_TFFF_MASK;
@@ -412,17 +435,23 @@ static uint32_t computeBaudRate(uint8_t dbr, uint8_t br, uint8_t pbr)
 
 __ISR__  SPI0_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   SPI_IRQDispatcher(SPI_INSTANCE_0);
+  ISR_PROFILE_END(&spiProfiles[SPI_INSTANCE_0]);
 }
 
 __ISR__  SPI1_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   SPI_IRQDispatcher(SPI_INSTANCE_1);
+  ISR_PROFILE_END(&spiProfiles[SPI_INSTANCE_1]);
 }
 
 __ISR__  SPI2_IRQHandler(void)
 {
-  SPI_IRQDispatcher(SPI_INSTANCE_2); 
+  ISR_PROFILE_BEGIN();
+  SPI_IRQDispatcher(SPI_INSTANCE_2);
+  ISR_PROFILE_END(&spiProfiles[SPI_INSTANCE_2]); 
 }
 
 static void SPI_IRQDispatcher(spi_id_t id)
@@ -430,6 +459,14 @@ static void SPI_IRQDispatcher(spi_id_t id)
   // Read Status Register
   uint32_t sr = spiPointers[id]->SR;
 
+  // If a transmission was started, the TFFF request is used only once
+  // to fill the FIFO, then each end of queue refills it
+  if ((sr & SPI_SR_TFFF_MASK) && (spiPointers[id]->RSER & SPI_RSER_TFFF_RE_MASK))
+  {
+    spiPointers[id]->RSER &= ~SPI_RSER_TFFF_RE_MASK;
+    softQueue2HardFIFO(id);
+  }
+
   // If last package was sent
   if (sr & SPI_SR_EOQF_MASK)
   {
@@ -451,7 +488,7 @@ static void SPI_IRQDispatcher(spi_id_t id)
 
 static void SPI_EOQFDispatcher(spi_id_t id)
 {
-  if (isEmpty(&(spiInstances[id].txQueue)))
+  if (spiTxQueueIsEmpty(&(spiInstances[id].txQueue)))
   {
     spiPointers[id]->MCR = (spiPointers[id]->MCR & ~SPI_MCR_HALT_MASK) | SPI_MCR_HALT(1);
     if (spiInstances[id].onTransferCompleted)
@@ -475,9 +512,6 @@ static void SPI_RFDFDispatcher(spi_id_t id)
   if (spiPointers[id]->SR & SPI_SR_RXCTR_MASK)
   {
     uint16_t newFrame = spiPointers[id]->POPR;
-    if (emptySize(&(spiInstances[id].rxQueue)) > 0)
-    {
-	  push(&(spiInstances[id].rxQueue), (void*) &newFrame);
-    }
+    spiRxQueuePush(&(spiInstances[id].rxQueue), newFrame);
   }
 }
@@ -8,21 +8,32 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 
-#include "SysTick.h"
+#include "systick.h"
 #include "MK64F12.h"
 #include "core_cm4.h"
 #include "hardware.h"
+#include "../../../lib/isr_profiler/isr_profiler.h"
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
-#define MAX_AMOUT_OF_SUBSCRIBERS	5
+// The profiles of the subscribers are named with two digits of the ID
+#if defined(ISR_PROFILER_ENABLED) && SYSTICK_MAX_SUBSCRIBERS > 100
+#error "SYSTICK_MAX_SUBSCRIBERS must be at most 100 to name the profiles"
+#endif
 
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
+typedef struct {
+	systick_callback_t	callback;		// Function called, NULL when the subscriber is free
+	uint32_t			period;			// Ticks between calls
+	uint32_t			next;			// Tick of the next call
+	bool				paused;			// Whether the calls are paused
+} subscriber_t;
+
 /*******************************************************************************
  * VARIABLES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -31,6 +42,25 @@
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+/**
+ * @brief Configures and starts the SysTick, only the first time
+ * @return Whether the SysTick is running
+ */
+static bool startPeripheral(void);
+
+/**
+ * @brief Updates the tick of the nearest call, with interrupts disabled
+ * @param now Current tick
+ */
+static void updateNextDue(uint32_t now);
+
+/**
+ * @brief Counts the tick of the last reload of the counter, if the COUNTFLAG
+ *        shows it was not counted yet, with interrupts disabled
+ * @return Whether the tick was counted
+ */
+static bool countReload(void);
+
 __ISR__ SysTick_Handler(void);
 
 /*******************************************************************************
@@ -41,8 +71,19 @@ __ISR__ SysTick_Handler(void);
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
-static void 	(*drivers[MAX_AMOUT_OF_SUBSCRIBERS])(void);	// Each driver function added to receive systick ticks
-static uint8_t 	subscribers = 0;							// Amount of functions subscribed to ticks
+static subscriber_t				subscribers[SYSTICK_MAX_SUBSCRIBERS];	// Each driver function added to receive systick ticks
+static volatile uint64_t		tickCount = 0;							// Amount of ticks since initialised
+static bool						reloadCounted = false;					// Whether the last reload was counted before its ISR
+static uint32_t					processedTick = 0;						// Last tick processed by the ISR
+static uint32_t					nextDue;								// Tick of the nearest call
+static bool						anyDue = false;							// Whether any subscriber is active
+
+#ifdef ISR_PROFILER_ENABLED
+// Profiles of the ISR and of each subscriber, named systick.<ID>
+static isr_profile_t			systickProfile;
+static isr_profile_t			subscriberProfiles[SYSTICK_MAX_SUBSCRIBERS];
+static char						subscriberNames[SYSTICK_MAX_SUBSCRIBERS][sizeof("systick.00")];
+#endif
 
 /*******************************************************************************
  *******************************************************************************
@@ -50,6 +91,134 @@ static uint8_t 	subscribers = 0;							// Amount of functions subscribed to tick
  *******************************************************************************
  ******************************************************************************/
 
+bool systickInit (void (*funcallback)(void))
+{
+	bool succeed;
+
+	if (funcallback)
+	{
+		succeed = systickSubscribe(funcallback, 1, 0) != SYSTICK_INVALID_ID;
+	}
+	else
+	{
+		succeed = startPeripheral();
+	}
+
+	// Return status of the initialization
+	return succeed;
+}
+
+systick_id_t systickSubscribe (systick_callback_t callback, uint32_t period, uint32_t phase)
+{
+	systick_id_t id = SYSTICK_INVALID_ID;
+
+	if (callback && period && startPeripheral())
+	{
+		hardwareDisableInterrupts();
+
+		// Looking for a free subscriber
+		for (systick_id_t index = 0 ; index < SYSTICK_MAX_SUBSCRIBERS && id == SYSTICK_INVALID_ID ; index++)
+		{
+			if (!subscribers[index].callback)
+			{
+				uint32_t now = (uint32_t)tickCount;
+				subscribers[index].callback = callback;
+				subscribers[index].period = period;
+				subscribers[index].next = now + period + phase;
+				subscribers[index].paused = false;
+				updateNextDue(now);
+				id = index;
+
+#ifdef ISR_PROFILER_ENABLED
+				// The profile starts again for the new subscriber
+				const char prefix[] = "systick.";
+				for (uint8_t i = 0 ; i < sizeof(prefix) - 1 ; i++)
+				{
+					subscriberNames[index][i] = prefix[i];
+				}
+				subscriberNames[index][sizeof(prefix) - 1] = '0' + index / 10;
+				subscriberNames[index][sizeof(prefix)] = '0' + index % 10;
+				subscriberNames[index][sizeof(prefix) + 1] = '\0';
+				subscriberProfiles[index].resetRequested = true;
+				ISR_PROFILE_REGISTER(subscriberNames[index], &subscriberProfiles[index]);
+#endif
+			}
+		}
+
+		hardwareEnableInterrupts();
+	}
+
+	return id;
+}
+
+void systickUnsubscribe (systick_id_t id)
+{
+	if (id < SYSTICK_MAX_SUBSCRIBERS)
+	{
+		hardwareDisableInterrupts();
+		subscribers[id].callback = NULL;
+		updateNextDue((uint32_t)tickCount);
+		hardwareEnableInterrupts();
+	}
+}
+
+void systickPause (systick_id_t id)
+{
+	if (id < SYSTICK_MAX_SUBSCRIBERS)
+	{
+		hardwareDisableInterrupts();
+		subscribers[id].paused = true;
+		hardwareEnableInterrupts();
+	}
+}
+
+void systickResume (systick_id_t id)
+{
+	if (id < SYSTICK_MAX_SUBSCRIBERS)
+	{
+		hardwareDisableInterrupts();
+		if (subscribers[id].callback && subscribers[id].paused)
+		{
+			uint32_t now = (uint32_t)tickCount;
+			subscribers[id].next = now + subscribers[id].period;
+			subscribers[id].paused = false;
+			updateNextDue(now);
+		}
+		hardwareEnableInterrupts();
+	}
+}
+
+uint64_t systickGetTicks (void)
+{
+	// The two halves are read again if the ISR updated them meanwhile
+	uint64_t ticks;
+	do
+	{
+		ticks = tickCount;
+	} while (ticks != tickCount);
+
+	return ticks;
+}
+
+uint64_t systickGetClock (uint32_t* value)
+{
+	hardwareDisableInterrupts();
+
+	// A reload between both reads is counted, and the counter is read again
+	// in the new tick, so the ticks and the counter are from the same instant
+	countReload();
+	uint32_t current = SysTick->VAL;
+	if (countReload())
+	{
+		current = SysTick->VAL;
+	}
+	uint64_t ticks = tickCount;
+
+	hardwareEnableInterrupts();
+
+	*value = current;
+	return ticks;
+}
 
 /*******************************************************************************
  *******************************************************************************
@@ -57,36 +226,54 @@ static uint8_t 	subscribers = 0;							// Amount of functions subscribed to tick
  *******************************************************************************
  ******************************************************************************/
 
-bool systickInit (void (*funcallback)(void))
+static bool startPeripheral(void)
 {
-	// Computing the tick amount with the frequency
-	uint32_t ticks = CPU_FREQUENCY_HZ / SYSTICK_ISR_FREQUENCY_HZ;
-	bool succeed = true;
-
 	static bool alreadyInit = false;
 
-	// Verifying if there are subscribers available
-	if (subscribers < MAX_AMOUT_OF_SUBSCRIBERS)
+	// Setting up the SysTick peripheral, SysTick_Config() returns 0 on success
+	if (!alreadyInit)
+	{
+		SysTick->CTRL = 0x00;
+		NVIC_EnableIRQ(SysTick_IRQn);
+		alreadyInit = SysTick_Config(CPU_FREQUENCY_HZ / SYSTICK_ISR_FREQUENCY_HZ) == 0;
+		ISR_PROFILE_REGISTER("systick", &systickProfile);
+	}
+
+	return alreadyInit;
+}
+
+static void updateNextDue(uint32_t now)
+{
+	uint32_t nearest = 0;
+	anyDue = false;
+
+	for (systick_id_t index = 0 ; index < SYSTICK_MAX_SUBSCRIBERS ; index++)
 	{
-		// Setting up the SysTick peripheral
-		if (!alreadyInit)
+		if (subscribers[index].callback && !subscribers[index].paused)
 		{
-			SysTick->CTRL = 0x00;
-			NVIC_EnableIRQ(SysTick_IRQn);
-			succeed = (bool)SysTick_Config(ticks);
-			alreadyInit = true;
+			uint32_t distance = subscribers[index].next - now;
+			if (!anyDue || distance < nearest)
+			{
+				nearest = distance;
+				anyDue = true;
+			}
 		}
-
-		// Adding the driver callback
-		drivers[subscribers++] = funcallback;
 	}
-	else
+
+	nextDue = now + nearest;
+}
+
+static bool countReload(void)
+{
+	// The COUNTFLAG is cleared when read, so each reload is counted once,
+	// by the ISR or by the first clock read after it
+	bool counted = SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk;
+	if (counted)
 	{
-		succeed = false;
+		tickCount++;
+		reloadCounted = true;
 	}
-
-	// Return status of the initialization
-	return succeed;
+	return counted;
 }
 
 /*******************************************************************************
@@ -97,14 +284,52 @@ bool systickInit (void (*funcallback)(void))
 
 __ISR__ SysTick_Handler(void)
 {
-	uint8_t index;
-	for (index = 0 ; index < subscribers ; index++)
+	ISR_PROFILE_BEGIN();
+
+	// The tick may be already counted by a clock read, from a higher priority
+	// ISR or with interrupts disabled. Without the COUNTFLAG and without a read
+	// counting it, the flag was cleared by a debugger, so the tick is counted.
+	hardwareDisableInterrupts();
+	if (!countReload() && !reloadCounted)
+	{
+		tickCount++;
+	}
+	reloadCounted = false;
+	uint32_t last = (uint32_t)tickCount;
+	hardwareEnableInterrupts();
+
+	// Every tick counted since the last ISR is processed, usually only one
+	while (processedTick != last)
 	{
-		if (drivers[index])
+		uint32_t now = ++processedTick;
+
+		// Most ticks have no subscriber due
+		if (anyDue && now == nextDue)
 		{
-			drivers[index]();
+			for (systick_id_t index = 0 ; index < SYSTICK_MAX_SUBSCRIBERS ; index++)
+			{
+				subscriber_t* subscriber = &subscribers[index];
+				if (subscriber->callback && !subscriber->paused && subscriber->next == now)
+				{
+					// Scheduled before calling, so the callback can pause itself
+					subscriber->next = now + subscriber->period;
+#ifdef ISR_PROFILER_ENABLED
+					uint32_t start = ISR_PROFILER_CYCLES();
+					subscriber->callback();
+					isrProfilerRecord(&subscriberProfiles[index], ISR_PROFILER_CYCLES() - start);
+#else
+					subscriber->callback();
+#endif
+				}
+			}
+
+			hardwareDisableInterrupts();
+			updateNextDue(now);
+			hardwareEnableInterrupts();
 		}
 	}
+
+	ISR_PROFILE_END(&systickProfile);
 }
 
-/******************************************************************************/
\ No newline at end of file
+/******************************************************************************/
@@ -12,6 +12,8 @@
  ******************************************************************************/
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -22,10 +24,31 @@
 #define SYSTICK_TICK_MS			   	(1000U / SYSTICK_ISR_FREQUENCY_HZ)
 #define SYSTICK_MS2TICKS(x)			((x) / SYSTICK_TICK_MS)
 
+// Maximum amount of subscribers
+#ifndef SYSTICK_MAX_SUBSCRIBERS
+#define SYSTICK_MAX_SUBSCRIBERS		8
+#endif
+
+#define SYSTICK_INVALID_ID			0xFF
+
+// The IDs are systick_id_t, and none of them can be SYSTICK_INVALID_ID
+#if SYSTICK_MAX_SUBSCRIBERS >= SYSTICK_INVALID_ID
+#error "SYSTICK_MAX_SUBSCRIBERS must be less than SYSTICK_INVALID_ID"
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
+// Subscribers are called every given period of ticks, the phase delays the
+// first call, so subscribers with the same period can be spread over different
+// ticks. The ISR only walks the subscribers in the ticks when one of them is due.
+//
+// systickSubscribe(sampleISR, SYSTICK_MS2TICKS(50), 0);
+// systickSubscribe(refreshISR, SYSTICK_MS2TICKS(50), SYSTICK_MS2TICKS(25));
+typedef uint8_t systick_id_t;
+typedef void (*systick_callback_t)(void);
+
 /*******************************************************************************
  * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -36,11 +59,53 @@
 
 /**
  * @brief Initialise SysTic driver
- * @param funcallback Function to be call every SysTick
+ * @param funcallback Function to be call every SysTick, or NULL to only start the peripheral
  * @return Initialization and registration succeed
  */
 bool systickInit (void (*funcallback)(void));
 
+/**
+ * @brief Subscribes a callback to the SysTick, starting the peripheral if needed
+ * @param callback Function to be called from the SysTick ISR
+ * @param period Ticks between calls, at least 1
+ * @param phase Ticks of delay of the first call, after the first period
+ * @return ID of the subscriber, or SYSTICK_INVALID_ID if there are no more available
+ */
+systick_id_t systickSubscribe (systick_callback_t callback, uint32_t period, uint32_t phase);
+
+/**
+ * @brief Removes the subscriber, its ID can be given to a new one
+ * @param id ID of the subscriber
+ */
+void systickUnsubscribe (systick_id_t id);
+
+/**
+ * @brief Stops calling the subscriber until resumed
+ * @param id ID of the subscriber
+ */
+void systickPause (systick_id_t id);
+
+/**
+ * @brief Calls the subscriber again, a whole period after now
+ * @param id ID of the subscriber
+ */
+void systickResume (systick_id_t id);
+
+/**
+ * @brief Returns the amount of SysTick interrupts since initialised. A tick
+ * 		  pending while interrupts are disabled is not counted yet, see
+ * 		  timestamp.h for a clock which accounts for it.
+ */
+uint64_t systickGetTicks (void);
+
+/**
+ * @brief Returns the ticks since initialised, counting the tick of the last
+ * 		  reload even if its ISR is pending or preempted, and the value of
+ * 		  the counter at the same instant. It can be called from any ISR.
+ * @param value Value of the counter, from the reload value down to zero
+ */
+uint64_t systickGetClock (uint32_t* value);
+
 
 /*******************************************************************************
  ******************************************************************************/
@@ -14,7 +14,8 @@
 #include <string.h>
 
 #include "../../../startup/hardware.h"
-#include "../../../lib/queue/queue.h"
+#include "../../../lib/typed_queue/typed_queue.h"
+#include "../../../lib/isr_profiler/isr_profiler.h"
 #include "../gpio/gpio.h"
 #include "uart.h"
 
@@ -22,16 +23,51 @@
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
-#define RX_BUFFER_SIZE       	100
-#define TX_BUFFER_SIZE       	100
+#define RX_BUFFER_SIZE       	128		// Must be a power of two
+#define TX_BUFFER_SIZE       	128		// Must be a power of two
+#define RX_DMA_BUFFER_SIZE    	64		// Must be a power of two, circular buffer of the receiver DMA
+
 
 #define SYSTEM_CLOCK 	     	  ((uint32_t)100000000U)
 #define BUS_CLOCK            	(SYSTEM_CLOCK / 2)
 
+#ifdef UART_DMA_ENABLED
+// DMA channels of each instance, transmitter and then receiver, from UART0.
+// Channel 0 is used by the PWM DMA driver, 1 and 2 by the GPIO capture.
+#define UART_DMA_CHANNEL_BASE   3
+#define UART_DMA_TX_CHANNEL(id) (UART_DMA_CHANNEL_BASE + 2 * (id))
+#define UART_DMA_RX_CHANNEL(id) (UART_DMA_CHANNEL_BASE + 2 * (id) + 1)
+
+// DMAMUX sources of each instance, receiver and then transmitter, from UART0
+#define UART_DMA_RX_SOURCE(id)  (2 + 2 * (id))
+#define UART_DMA_TX_SOURCE(id)  (3 + 2 * (id))
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
+// Declaring the typed queues used for buffering
+DECLARE_QUEUE(uartRxQueue, word_t, RX_BUFFER_SIZE)
+DECLARE_QUEUE(uartTxQueue, word_t, TX_BUFFER_SIZE)
+
+#ifdef UART_DMA_ENABLED
+// DMA TCD Structure
+typedef struct {
+  uint32_t SADDR;
+  uint16_t SOFF;
+  uint16_t ATTR;
+  uint32_t NBYTES_MLNO;
+  uint32_t SLAST;
+  uint32_t DADDR;
+  uint16_t DOFF;
+  uint16_t CITER_ELINKNO;
+  uint32_t DLAST_SGA;
+  uint16_t CSR;
+  uint16_t BITER_ELINKNO;
+} uart_TCD_t;
+#endif
+
 // Declaring the instance structure
 typedef struct {
   // MCU Peripheral data
@@ -46,14 +82,22 @@ typedef struct {
   uint8_t           rxSize;       // Size of the frame to be notified
   
   // Buffering interface
-  word_t            rxBuffer[RX_BUFFER_SIZE]; 	// Data buffer for Rx
-  word_t            txBuffer[TX_BUFFER_SIZE];  	// Data buffer for Tx
-  queue_t           txQueue;      				// Queue for Tx (must be initialized with txBuffer)
-  queue_t           rxQueue;      				// Queue for Rx (must be initialized with rxBuffer)
+  uartTxQueue_t     txQueue;      				// Queue for Tx, main loop to ISR
+  uartRxQueue_t     rxQueue;      				// Queue for Rx, ISR to main loop
   
   // Flags
   bool              txCompleted;   // asserts if transmission completed
 
+  // DMA mode
+  bool              dma;                              // Whether the DMA moves the words
+#ifdef UART_DMA_ENABLED
+  size_t            txDmaLength;                      // Words of the queue being sent, 0 when idle
+  size_t            rxDmaIndex;                       // Words of the circular buffer already queued
+  uint32_t          rxDmaOverruns;                    // Times the DMA overwrote words not queued yet
+  word_t            rxDmaBuffer[RX_DMA_BUFFER_SIZE];  // Circular buffer written by the receiver DMA
+  uart_TCD_t        txTcd __attribute__ ((aligned(32))); // Transmission of the words after the queue wraps
+#endif
+
   // Configuration of the UART protocol
   uart_cfg_t        cfg;
 } uart_instance_t;
@@ -86,6 +130,24 @@ static void UART_IRQDispatcher(uart_id_t id);
 static void UART_TxDispatcher(uart_id_t id);
 static void UART_RxDispatcher(uart_id_t id);
 static void readFifo(uart_id_t id);
+#ifdef UART_DMA_ENABLED
+static void dmaInit(uart_id_t id);
+static void txDmaStart(uart_id_t id);
+static void readDmaBuffer(uart_id_t id);
+static size_t rxDmaPosition(uint8_t channel);
+static void clearIdleDma(uart_id_t id);
+static void UART_TxDmaDispatcher(uart_id_t id);
+
+// Declaring the IRQ Handlers of the DMA channels of UART0 to UART3
+__ISR__ DMA3_IRQHandler(void);
+__ISR__ DMA4_IRQHandler(void);
+__ISR__ DMA5_IRQHandler(void);
+__ISR__ DMA6_IRQHandler(void);
+__ISR__ DMA7_IRQHandler(void);
+__ISR__ DMA8_IRQHandler(void);
+__ISR__ DMA9_IRQHandler(void);
+__ISR__ DMA10_IRQHandler(void);
+#endif
 
 /*******************************************************************************
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
@@ -129,6 +191,24 @@ static const uint8_t  uartPinAlts[UART_AMOUNT][UART_PIN_COUNT] = {
 static UART_Type*    	uartPointers[] = UART_BASE_PTRS;
 static const uint8_t 	uartRxTxIrqs[] = UART_RX_TX_IRQS;
 
+#ifdef QUEUE_STATS_ENABLED
+// Names of the queues registered in the queue statistics
+static const char*		uartQueueNames[UART_AMOUNT][2] = {
+  //  RX			TX
+  { "uart0.rx",	"uart0.tx" },
+  { "uart1.rx",	"uart1.tx" },
+  { "uart2.rx",	"uart2.tx" },
+  { "uart3.rx",	"uart3.tx" },
+  { "uart4.rx",	"uart4.tx" }
+};
+#endif
+
+#ifdef ISR_PROFILER_ENABLED
+// Profiles of the interrupts of each instance
+static isr_profile_t	uartProfiles[UART_AMOUNT];
+static const char*		uartProfileNames[UART_AMOUNT] = { "uart0", "uart1", "uart2", "uart3", "uart4" };
+#endif
+
 
 /*******************************************************************************
  *******************************************************************************
@@ -214,15 +294,28 @@ void uartInit (uint8_t id, uart_cfg_t config)
   // Enable NVIC
   NVIC_EnableIRQ(uartRxTxIrqs[id]);
 
-  // UART IRQs initialization
-  uartInstance->C2 |= UART_C2_RIE(1);
-
   // Receiver and transmitter queue initialization
-  for (uint8_t i = 0 ; i < UART_AMOUNT ; i++)
+  uartRxQueueInit(&uartInstances[id].rxQueue);
+  uartTxQueueInit(&uartInstances[id].txQueue);
+
+  // UART4 shares one DMA request between the receiver and the transmitter,
+  // and the DMA cannot move the ninth bit
+  uartInstances[id].cfg = config;
+#ifdef UART_DMA_ENABLED
+  uartInstances[id].dma = config.dmaEnable && id != UART_INSTANCE_4 && !(config.length == UART_DATA_9_BITS && !config.parityEnable);
+  if (uartInstances[id].dma)
   {
-    uartInstances[i].rxQueue = createQueue(uartInstances[i].rxBuffer, RX_BUFFER_SIZE, sizeof(word_t)); 
-    uartInstances[i].txQueue = createQueue(uartInstances[i].txBuffer, TX_BUFFER_SIZE, sizeof(word_t));
+    dmaInit(id);
   }
+#else
+  uartInstances[id].dma = false;
+#endif
+
+  // UART IRQs initialization, requesting the DMA instead when enabled
+  uartInstance->C2 |= UART_C2_RIE(1);
+  QUEUE_STATS_REGISTER(uartQueueNames[id][0], &uartInstances[id].rxQueue, RX_BUFFER_SIZE);
+  QUEUE_STATS_REGISTER(uartQueueNames[id][1], &uartInstances[id].txQueue, TX_BUFFER_SIZE);
+  ISR_PROFILE_REGISTER(uartProfileNames[id], &uartProfiles[id]);
   
   // Clearing the flags before starting
   uartInstance->S1;
@@ -260,60 +353,53 @@ bool uartSubscribeRxMsg(uart_id_t id, uart_rx_callback callback, uint8_t frameSi
 
 bool uartHasRxMsg(uint8_t id)
 {
-  return !isEmpty(&(uartInstances[id].rxQueue));
+  return !uartRxQueueIsEmpty(&(uartInstances[id].rxQueue));
 }
 
 uint8_t uartGetRxMsgLength(uint8_t id)
 {
-  return size(&uartInstances[id].rxQueue);
+  return uartRxQueueSize(&uartInstances[id].rxQueue);
+}
+
+uint32_t uartGetRxOverruns(uart_id_t id)
+{
+#ifdef UART_DMA_ENABLED
+  return uartInstances[id].rxDmaOverruns;
+#else
+  return 0;
+#endif
 }
 
 uint8_t uartReadMsg(uint8_t id, word_t* msg, uint8_t length)
 {
-  queue_t *rxQueue = &uartInstances[id].rxQueue;
-  uint8_t rxWords = length <= size(rxQueue) ? length : size(rxQueue);
-  popMany(rxQueue, msg, rxWords);
-  return rxWords;
+  return uartRxQueuePopMany(&uartInstances[id].rxQueue, msg, length);
 }
 
 uint8_t uartWriteMsg(uint8_t id, const word_t* msg, uint8_t length)
 {
-  queue_t *txQueue = &(uartInstances[id].txQueue);
-  uint8_t txWords = length <= emptySize(txQueue) ? length : emptySize(txQueue);
-  uint8_t i = 0;
+  // Fill the software FIFO with the message, as much as it fits
+  uint8_t txWords = uartTxQueuePushMany(&(uartInstances[id].txQueue), msg, length);
 
   if (txWords)
   {
     // Reset "completed transmission" flag if there is data to send
     uartInstances[id].txCompleted = false;
 
-    // Fill the software FIFO with the message
-    for ( i = 0 ; i < txWords ; i++ )
+#ifdef UART_DMA_ENABLED
+    if (uartInstances[id].dma)
     {
-      push(txQueue, (void*)&msg[i]);
+      // The DMA interruption starts the next transfer when one is running
+      hardwareDisableInterrupts();
+      txDmaStart(id);
+      hardwareEnableInterrupts();
+    }
+    else
+#endif
+    {
+      // Enable Transmitter, the hardware FIFO is filled only by the TDRE interruption
+      // which is raised right away when it is empty, so the ISR is the single consumer
+      uartPointers[id]->C2 = (uartPointers[id]->C2 & ~UART_C2_TE_MASK & ~UART_C2_TIE_MASK & ~UART_C2_TCIE_MASK) | UART_C2_TE(1) | UART_C2_TIE(1) | UART_C2_TCIE(1);
     }
-
-	// Fill hardware FIFO, if empty, to start the process
-	if (uartPointers[id]->S1 & UART_S1_TDRE_MASK)
-	{
-		uint8_t tcfifo = uartPointers[id]->TCFIFO;
-		for ( i = 0 ; (i < txWords) && (i < (uartInstances[id].txFifoSize - tcfifo)) ; i++ )
-		{
-			// Clear the flag
-			uartPointers[id]->S1;
-
-			// Pop the next element from the Queue and transmit it
-			word_t word = *(word_t*)pop(txQueue);
-		    if (uartInstances[id].cfg.length == UART_DATA_9_BITS && !uartInstances[id].cfg.parityEnable)
-		    {
-		      uartPointers[id]->C3 = (uartPointers[id]->C3 & ~UART_C3_T8_MASK) | UART_C3_T8((word & 0x100) >> 8);
-		    }
-		    uartPointers[id]->D = word;
-		}
-	}
-
-	// Enable Transmitter
-	uartPointers[id]->C2 = (uartPointers[id]->C2 & ~UART_C2_TE_MASK & ~UART_C2_TIE_MASK & ~UART_C2_TCIE_MASK) | UART_C2_TE(1) | UART_C2_TIE(1) | UART_C2_TCIE(1);
   }
 
   return txWords;
@@ -328,8 +414,7 @@ bool uartIsTxMsgComplete(uint8_t id)
 
 bool uartCanTx(uart_id_t id, size_t length)
 {
-  queue_t *txQueue = &(uartInstances[id].txQueue);
-  return length <= emptySize(txQueue);
+  return length <= uartTxQueueEmptySize(&(uartInstances[id].txQueue));
 }
 
 /*******************************************************************************
@@ -343,35 +428,242 @@ void readFifo(uart_id_t id)
   uart_instance_t*  uartInstance  = &uartInstances[id];
   UART_Type*        uart          = uartPointers[id];
   uint8_t           bufferCount;
-  uint16_t          word;
+  word_t*           words;
+  size_t            length;
 
   // Get the buffer count, the current amount of elements in the receiver FIFO,
-  // and push every element from the FIFO to the driver receiver queue
+  // and move every element from the FIFO straight into the driver receiver queue,
+  // which may take two spans when the queue buffer wraps around
   bufferCount = uart->RCFIFO;
-  if (emptySize(&uartInstance->rxQueue) >= bufferCount)
+  while (bufferCount && (length = uartRxQueueReserve(&uartInstance->rxQueue, &words, bufferCount)))
   {
-    while (bufferCount)
+    for (size_t i = 0 ; i < length ; i++)
     {
-      if (uartInstance->cfg.length == UART_DATA_9_BITS && !uartInstance->cfg.parityEnable)
+      words[i] = uart->D;
+    }
+    uartRxQueueCommit(&uartInstance->rxQueue, length);
+    bufferCount -= length;
+  }
+
+  // When the receiver queue is full, the remaining words are discarded
+  // reading D, to clear the RDRF flag
+  QUEUE_STATS_ON_DISCARD(&uartInstance->rxQueue, bufferCount);
+  while (bufferCount)
+  {
+    uart->D;
+    bufferCount--;
+  }
+}
+
+#ifdef UART_DMA_ENABLED
+static void dmaInit(uart_id_t id)
+{
+  uart_instance_t*  uartInstance  = &uartInstances[id];
+  UART_Type*        uart          = uartPointers[id];
+  uint8_t           txChannel     = UART_DMA_TX_CHANNEL(id);
+  uint8_t           rxChannel     = UART_DMA_RX_CHANNEL(id);
+
+  // Clock gating of the DMA and DMAMUX
+  SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+  SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+
+  // Every word received requests the DMA, and the idle count starts after
+  // the stop bit, so the idle line only flags the end of a frame
+  uart->RWFIFO = 1;
+  uart->C1 |= UART_C1_ILT(1);
+  uart->C5 |= UART_C5_TDMAS(1) | UART_C5_RDMAS(1);
+  uart->C2 |= UART_C2_ILIE(1);
+
+  // The transmitter channel is loaded on each transfer, only the constant fields here
+  DMA0->CERQ = DMA_CERQ_CERQ(txChannel);
+  DMA0->TCD[txChannel].SOFF = sizeof(word_t);
+  DMA0->TCD[txChannel].DADDR = (uint32_t)(&uart->D);
+  DMA0->TCD[txChannel].DOFF = 0;
+  DMA0->TCD[txChannel].ATTR = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0);
+  DMA0->TCD[txChannel].NBYTES_MLNO = sizeof(word_t);
+  DMA0->TCD[txChannel].SLAST = 0;
+  uartInstance->txDmaLength = 0;
+
+  // The receiver channel runs forever over the circular buffer,
+  // interrupting on each half
+  DMA0->CERQ = DMA_CERQ_CERQ(rxChannel);
+  DMA0->TCD[rxChannel].SADDR = (uint32_t)(&uart->D);
+  DMA0->TCD[rxChannel].SOFF = 0;
+  DMA0->TCD[rxChannel].DADDR = (uint32_t)(uartInstance->rxDmaBuffer);
+  DMA0->TCD[rxChannel].DOFF = sizeof(word_t);
+  DMA0->TCD[rxChannel].ATTR = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0);
+  DMA0->TCD[rxChannel].NBYTES_MLNO = sizeof(word_t);
+  DMA0->TCD[rxChannel].SLAST = 0;
+  DMA0->TCD[rxChannel].DLAST_SGA = -(int32_t)(RX_DMA_BUFFER_SIZE * sizeof(word_t));
+  DMA0->TCD[rxChannel].CSR = DMA_CSR_INTHALF(1) | DMA_CSR_INTMAJOR(1);
+  DMA0->TCD[rxChannel].BITER_ELINKNO = RX_DMA_BUFFER_SIZE;
+  DMA0->TCD[rxChannel].CITER_ELINKNO = RX_DMA_BUFFER_SIZE;
+  uartInstance->rxDmaIndex = 0;
+  uartInstance->rxDmaOverruns = 0;
+
+  // Routing the requests of the instance to its channels
+  DMAMUX->CHCFG[txChannel] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(UART_DMA_TX_SOURCE(id));
+  DMAMUX->CHCFG[rxChannel] = DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(UART_DMA_RX_SOURCE(id));
+  DMA0->CINT = DMA_CINT_CINT(txChannel);
+  DMA0->CINT = DMA_CINT_CINT(rxChannel);
+  NVIC_EnableIRQ(DMA0_IRQn + txChannel);
+  NVIC_EnableIRQ(DMA0_IRQn + rxChannel);
+  DMA0->SERQ = DMA_SERQ_SERQ(rxChannel);
+}
+
+static void txDmaStart(uart_id_t id)
+{
+  uart_instance_t*  uartInstance  = &uartInstances[id];
+  uint8_t           channel       = UART_DMA_TX_CHANNEL(id);
+  word_t*           words;
+  size_t            length;
+  size_t            total;
+
+  if (uartInstance->txDmaLength == 0)
+  {
+    // The DMA reads the words in place, from the front of the queue to the end
+    // of its buffer, and the scatter/gather loads the words after the wrap
+    length = uartTxQueuePeekSpan(&uartInstance->txQueue, &words, TX_BUFFER_SIZE);
+    total = uartTxQueueSize(&uartInstance->txQueue);
+    if (length)
+    {
+      DMA0->TCD[channel].SADDR = (uint32_t)(words);
+      DMA0->TCD[channel].BITER_ELINKNO = length;
+      DMA0->TCD[channel].CITER_ELINKNO = length;
+      if (total > length)
       {
-        word = (uart->C3 & UART_C3_R8_MASK) << 1;
+        uartInstance->txTcd = (uart_TCD_t) {
+          .SADDR = (uint32_t)(uartInstance->txQueue.buffer),
+          .SOFF = sizeof(word_t),
+          .ATTR = DMA_ATTR_SSIZE(0) | DMA_ATTR_DSIZE(0),
+          .NBYTES_MLNO = sizeof(word_t),
+          .SLAST = 0,
+          .DADDR = (uint32_t)(&uartPointers[id]->D),
+          .DOFF = 0,
+          .CITER_ELINKNO = total - length,
+          .DLAST_SGA = 0,
+          .CSR = DMA_CSR_INTMAJOR(1) | DMA_CSR_DREQ(1),
+          .BITER_ELINKNO = total - length
+        };
+        DMA0->TCD[channel].DLAST_SGA = (uint32_t)(&uartInstance->txTcd);
+        DMA0->TCD[channel].CSR = DMA_CSR_ESG(1);
       }
       else
       {
-        word = 0x0000;
+        DMA0->TCD[channel].DLAST_SGA = 0;
+        DMA0->TCD[channel].CSR = DMA_CSR_INTMAJOR(1) | DMA_CSR_DREQ(1);
       }
-      word = (word & 0x0100) | uart->D;
-      push(&uartInstance->rxQueue, &word);
-      bufferCount--;
+      uartInstance->txDmaLength = total;
+
+      // Enable Transmitter, the TDRE requests the DMA, and the transmission
+      // complete is only waited for when the queue is empty
+      DMA0->SERQ = DMA_SERQ_SERQ(channel);
+      uartPointers[id]->C2 = (uartPointers[id]->C2 & ~UART_C2_TCIE_MASK) | UART_C2_TE(1) | UART_C2_TIE(1);
     }
   }
-  else 
+}
+
+static void readDmaBuffer(uart_id_t id)
+{
+  uart_instance_t*  uartInstance  = &uartInstances[id];
+  uint8_t           channel       = UART_DMA_RX_CHANNEL(id);
+  size_t            read          = uartInstance->rxDmaIndex;
+  bool              raised        = false;
+  size_t            write;
+  size_t            bufferCount;
+  word_t*           words;
+  size_t            length;
+
+  // The flag of the channel is cleared between two reads of the position in the
+  // same half, so it is only raised for the halves filled after the read
+  do
   {
-    // Read D to clear RDRF flag
-    uart->D;
+    raised |= (DMA0->INT >> channel) & 1;
+    write = rxDmaPosition(channel);
+    DMA0->CINT = DMA_CINT_CINT(channel);
+  } while ((rxDmaPosition(channel) ^ write) & (RX_DMA_BUFFER_SIZE / 2));
+  bufferCount = (write - read) & (RX_DMA_BUFFER_SIZE - 1);
+
+  // Both halves were filled since the last read when the flag was raised and
+  // the DMA is back in the same half, so the words not queued yet are a whole
+  // buffer or were overwritten, then they are all discarded
+  if (raised && !((write ^ read) & (RX_DMA_BUFFER_SIZE / 2)) && write >= read)
+  {
+    if (write == read)
+    {
+      bufferCount = RX_DMA_BUFFER_SIZE;
+    }
+    else
+    {
+      uartInstance->rxDmaOverruns++;
+      QUEUE_STATS_ON_DISCARD(&uartInstance->rxQueue, RX_DMA_BUFFER_SIZE + bufferCount);
+      read = write;
+      bufferCount = 0;
+    }
   }
+
+  // Move the words written by the DMA since the last time into the receiver queue,
+  // which may take up to four spans when both buffers wrap around
+  while (bufferCount && (length = uartRxQueueReserve(&uartInstance->rxQueue, &words,
+                          bufferCount < RX_DMA_BUFFER_SIZE - read ? bufferCount : RX_DMA_BUFFER_SIZE - read)))
+  {
+    for (size_t i = 0 ; i < length ; i++)
+    {
+      words[i] = uartInstance->rxDmaBuffer[read + i];
+    }
+    uartRxQueueCommit(&uartInstance->rxQueue, length);
+    read = (read + length) & (RX_DMA_BUFFER_SIZE - 1);
+    bufferCount -= length;
+  }
+
+  // When the receiver queue is full, the remaining words are discarded
+  QUEUE_STATS_ON_DISCARD(&uartInstance->rxQueue, bufferCount);
+  uartInstance->rxDmaIndex = write;
 }
 
+static size_t rxDmaPosition(uint8_t channel)
+{
+  uint16_t citer = DMA0->TCD[channel].CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK;
+  return (RX_DMA_BUFFER_SIZE - citer) & (RX_DMA_BUFFER_SIZE - 1);
+}
+
+static void clearIdleDma(uart_id_t id)
+{
+  uart_instance_t*  uartInstance  = &uartInstances[id];
+  UART_Type*        uart          = uartPointers[id];
+  word_t            word;
+  word_t*           words;
+
+  // The idle flag is cleared reading S1 and then D. The receiver does not request
+  // the DMA meanwhile, so a word arriving right then is read here, after the ones
+  // the DMA already moved, instead of being lost
+  uart->C5 &= ~UART_C5_RDMAS_MASK;
+  while (DMA0->TCD[UART_DMA_RX_CHANNEL(id)].CSR & DMA_CSR_ACTIVE_MASK);
+  uart->SFIFO = UART_SFIFO_RXUF_MASK;
+  uart->S1;
+  word = uart->D;
+  if (uart->SFIFO & UART_SFIFO_RXUF_MASK)
+  {
+    // The FIFO was empty, the underflow of the read is cleared
+    uart->SFIFO = UART_SFIFO_RXUF_MASK;
+  }
+  else
+  {
+    readDmaBuffer(id);
+    if (uartRxQueueReserve(&uartInstance->rxQueue, &words, 1))
+    {
+      words[0] = word;
+      uartRxQueueCommit(&uartInstance->rxQueue, 1);
+    }
+    else
+    {
+      QUEUE_STATS_ON_DISCARD(&uartInstance->rxQueue, 1);
+    }
+  }
+  uart->C5 |= UART_C5_RDMAS(1);
+}
+#endif
+
 static void UART_IRQDispatcher(uart_id_t id)
 {
   UART_Type* uart = uartPointers[id];
@@ -380,13 +672,18 @@ static void UART_IRQDispatcher(uart_id_t id)
   // If the UART transmitter is enabled, check the flags
   if (uart->C2 & UART_C2_TE_MASK)
   {
-	  if (s1 & UART_S1_TDRE_MASK)
+	  if ((s1 & UART_S1_TDRE_MASK) && !uartInstances[id].dma)
 	  {
 	    UART_TxDispatcher(id);
 	  }
-	  if (s1 & UART_S1_TC_MASK)
+	  if ((s1 & UART_S1_TC_MASK) && (uart->C2 & UART_C2_TCIE_MASK))
 	  {
-	    if (isEmpty(&uartInstances[id].txQueue))
+	    if (uartInstances[id].dma && !uartTxQueueIsEmpty(&uartInstances[id].txQueue))
+	    {
+	      // Written meanwhile, the DMA interruption waits again when done
+	      uart->C2 &= ~UART_C2_TCIE_MASK;
+	    }
+	    else if (uartTxQueueIsEmpty(&uartInstances[id].txQueue))
 	    {
 	      // Disable Transmitter
 	  	  uartPointers[id]->C2 = uartPointers[id]->C2 & ~UART_C2_TE_MASK & ~UART_C2_TIE_MASK & ~UART_C2_TCIE_MASK;
@@ -407,10 +704,19 @@ static void UART_IRQDispatcher(uart_id_t id)
   // If the UART receiver is enabled, check the flag
   if (uart->C2 & UART_C2_RE_MASK)
   {
-	  if (s1 & UART_S1_RDRF_MASK)
+	  if ((s1 & UART_S1_RDRF_MASK) && !uartInstances[id].dma)
+	  {
+	    UART_RxDispatcher(id);
+	  }
+#ifdef UART_DMA_ENABLED
+	  if ((s1 & UART_S1_IDLE_MASK) && uartInstances[id].dma)
 	  {
+	    clearIdleDma(id);
+
+	    // The end of the frame is flushed, even when the buffer is not half full
 	    UART_RxDispatcher(id);
 	  }
+#endif
   }
 }
 
@@ -418,20 +724,24 @@ static void UART_TxDispatcher(uart_id_t id)
 {
   uart_instance_t*  uartInstance  = &uartInstances[id];
   UART_Type*        uart          = uartPointers[id];
-  uint8_t			queueSize     = size(&uartInstance->txQueue);
   uint8_t			fifoSize      = uartInstance->txFifoSize - uart->TCFIFO;
-  uint8_t			length        = queueSize < fifoSize ? queueSize : fifoSize;
+  word_t*			words;
+  size_t			length;
 
-  for (uint8_t i = 0 ; i < length; i++)
+  // Send the words of the transmission queue in place via the UART D register
+  // to the FIFO, verifying when the 9 bits is enabled, and then pop them
+  while (fifoSize && (length = uartTxQueuePeekSpan(&uartInstance->txQueue, &words, fifoSize)))
   {
-    // Pop an element from the transmission queue, and send it via the
-    // UART D register to the FIFO, verifying when the 9 bits is enabled
-    word_t word = *(word_t*)pop(&uartInstance->txQueue);
-    if (uartInstance->cfg.length == UART_DATA_9_BITS && !uartInstance->cfg.parityEnable)
+    for (size_t i = 0 ; i < length ; i++)
     {
-      uart->C3 = (uart->C3 & ~UART_C3_T8_MASK) | UART_C3_T8((word & 0x100) >> 8);
+      if (uartInstance->cfg.length == UART_DATA_9_BITS && !uartInstance->cfg.parityEnable)
+      {
+        uart->C3 = (uart->C3 & ~UART_C3_T8_MASK) | UART_C3_T8((words[i] & 0x100) >> 8);
+      }
+      uart->D = words[i];
     }
-    uart->D = word;
+    uartTxQueueRelease(&uartInstance->txQueue, length);
+    fifoSize -= length;
   }
 }
 
@@ -439,12 +749,21 @@ static void UART_RxDispatcher(uart_id_t id)
 {
   uart_instance_t*  uartInstance  = &uartInstances[id];
 
-  // Read the FIFO and push the elements into the software queue
-  readFifo(id);
+  // Read the FIFO, or the buffer of the DMA, and push the elements into the software queue
+#ifdef UART_DMA_ENABLED
+  if (uartInstance->dma)
+  {
+    readDmaBuffer(id);
+  }
+  else
+#endif
+  {
+    readFifo(id);
+  }
 
   // When the current size of the receiver queue is higher than the frame size
   // configured for interruption, the user is notified via the given callback
-  if (size(&uartInstance->rxQueue) >= uartInstance->rxSize)
+  if (uartRxQueueSize(&uartInstance->rxQueue) >= uartInstance->rxSize)
   {
     if (uartInstance->rxCallback)
     {
@@ -453,6 +772,26 @@ static void UART_RxDispatcher(uart_id_t id)
   }
 }
 
+#ifdef UART_DMA_ENABLED
+static void UART_TxDmaDispatcher(uart_id_t id)
+{
+  uart_instance_t*  uartInstance  = &uartInstances[id];
+
+  // The words sent leave the queue, then the next ones are sent or,
+  // when none, the transmission complete flags the last word shifted out
+  uartTxQueueRelease(&uartInstance->txQueue, uartInstance->txDmaLength);
+  uartInstance->txDmaLength = 0;
+  if (uartTxQueueIsEmpty(&uartInstance->txQueue))
+  {
+    uartPointers[id]->C2 |= UART_C2_TCIE(1);
+  }
+  else
+  {
+    txDmaStart(id);
+  }
+}
+#endif
+
 /*******************************************************************************
  *******************************************************************************
 						            INTERRUPT SERVICE ROUTINES
@@ -461,27 +800,99 @@ static void UART_RxDispatcher(uart_id_t id)
 
 __ISR__ UART0_RX_TX_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   UART_IRQDispatcher(UART_INSTANCE_0);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_0]);
 }
 
 __ISR__ UART1_RX_TX_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   UART_IRQDispatcher(UART_INSTANCE_1);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_1]);
 }
 
 __ISR__ UART2_RX_TX_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   UART_IRQDispatcher(UART_INSTANCE_2);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_2]);
 }
 
 __ISR__ UART3_RX_TX_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   UART_IRQDispatcher(UART_INSTANCE_3);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_3]);
 }
 
 __ISR__ UART4_RX_TX_IRQHandler(void)
 {
+  ISR_PROFILE_BEGIN();
   UART_IRQDispatcher(UART_INSTANCE_4);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_4]);
+}
+
+#ifdef UART_DMA_ENABLED
+__ISR__ DMA3_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  DMA0->CINT = DMA_CINT_CINT(UART_DMA_TX_CHANNEL(UART_INSTANCE_0));
+  UART_TxDmaDispatcher(UART_INSTANCE_0);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_0]);
+}
+
+__ISR__ DMA4_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  UART_RxDispatcher(UART_INSTANCE_0);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_0]);
+}
+
+__ISR__ DMA5_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  DMA0->CINT = DMA_CINT_CINT(UART_DMA_TX_CHANNEL(UART_INSTANCE_1));
+  UART_TxDmaDispatcher(UART_INSTANCE_1);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_1]);
+}
+
+__ISR__ DMA6_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  UART_RxDispatcher(UART_INSTANCE_1);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_1]);
+}
+
+__ISR__ DMA7_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  DMA0->CINT = DMA_CINT_CINT(UART_DMA_TX_CHANNEL(UART_INSTANCE_2));
+  UART_TxDmaDispatcher(UART_INSTANCE_2);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_2]);
+}
+
+__ISR__ DMA8_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  UART_RxDispatcher(UART_INSTANCE_2);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_2]);
+}
+
+__ISR__ DMA9_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  DMA0->CINT = DMA_CINT_CINT(UART_DMA_TX_CHANNEL(UART_INSTANCE_3));
+  UART_TxDmaDispatcher(UART_INSTANCE_3);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_3]);
+}
+
+__ISR__ DMA10_IRQHandler(void)
+{
+  ISR_PROFILE_BEGIN();
+  UART_RxDispatcher(UART_INSTANCE_3);
+  ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_3]);
 }
+#endif
 
 /******************************************************************************/
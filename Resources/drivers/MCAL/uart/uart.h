@@ -19,6 +19,14 @@
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
+// UART DMA feature!
+// You can create a define with UART_DMA_ENABLED to let the instances configured
+// with dmaEnable use the eDMA, on the channels 3 to 10 and their interrupts, two
+// for each of UART0 to UART3. Otherwise, dmaEnable is ignored and the channels
+// are left to other drivers.
+//
+// #define UART_DMA_ENABLED
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -74,12 +82,18 @@ typedef enum {
 } uart_length_t;
 
 // Declaring UART configuration
+// With dmaEnable and UART_DMA_ENABLED, the DMA moves the words between the queues
+// and the peripheral, the transmitter streams from its queue and the receiver fills
+// a circular buffer flushed into its queue by halves and on idle line. UART4 has a
+// single DMA request for both directions, so it always uses interrupts, as the 9
+// data bits.
 typedef struct {
 	uart_baudrate_t		baudRate;
 	uint8_t				parityEnable : 1;	// 0 for parity disabled
 	uint8_t				parityMode   : 1;	// 0 for even parity
 	uint8_t				stopMode	 : 1;	// 0 for 1 stop bit
 	uint8_t				length		 : 1;	// 0 for 8 data bits
+	uint8_t				dmaEnable	 : 1;	// 0 for interrupts mode
 } uart_cfg_t;
 
 // Declaring the size of the words
@@ -141,6 +155,14 @@ bool uartCanTx(uart_id_t id, size_t length);
 */
 uint8_t uartGetRxMsgLength(uart_id_t id);
 
+/**
+ * @brief Check how many times received words were lost, when the receiver DMA
+ *        overwrote its buffer before the words were queued
+ * @param id 		UART's number
+ * @return Quantity of overruns since initialised
+*/
+uint32_t uartGetRxOverruns(uart_id_t id);
+
 /**
  * @brief Read a received message. Non-Blocking
  * @param id		UART's number
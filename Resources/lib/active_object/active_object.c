@@ -0,0 +1,202 @@
+/***************************************************************************//**
+  @file     active_object.c
+  @brief    Active Object runtime, built on the Event Queue and FSM libraries
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "active_object.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#if AO_MAX_OBJECTS > 32
+#error "AO_MAX_OBJECTS must be at most 32"
+#endif
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static active_object_t*		objects[AO_MAX_OBJECTS];		// Registered objects, by priority
+static volatile uint32_t	ready = 0;						// Bit mask of objects with events
+static ao_idle_hook_t		idleHook = NULL;
+
+static ao_time_event_t*		timeEvents[AO_MAX_TIME_EVENTS];	// Armed time events
+static uint8_t				timeEventsCount = 0;
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool aoRegister(active_object_t* ao, uint8_t priority, state_t initial)
+{
+	bool succeed = false;
+
+	if (ao && priority < AO_MAX_OBJECTS && objects[priority] == NULL)
+	{
+		ao->state = initial;
+		ao->priority = priority;
+		objects[priority] = ao;
+		succeed = true;
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+void aoSetIdleHook(ao_idle_hook_t hook)
+{
+	idleHook = hook;
+}
+
+bool aoPost(active_object_t* ao, void* event)
+{
+	bool succeed = false;
+
+	uint32_t primask;
+	EVENT_QUEUE_ENTER_CRITICAL(primask);
+	if (postEvent(&ao->queue, event))
+	{
+		ready |= (1UL << ao->priority);
+		succeed = true;
+	}
+	EVENT_QUEUE_EXIT_CRITICAL(primask);
+
+	// Return the succeed status
+	return succeed;
+}
+
+bool aoRun(void)
+{
+	bool dispatched = false;
+
+	if (ready)
+	{
+		active_object_t* ao = objects[31 - __builtin_clz(ready)];
+		void* event = getNextEvent(&ao->queue);
+
+		// Only the runtime pops events, so the bit is cleared when
+		// the queue is empty, unless an ISR posts meanwhile
+		uint32_t primask;
+		EVENT_QUEUE_ENTER_CRITICAL(primask);
+		if (ao->queue.ready == 0)
+		{
+			ready &= ~(1UL << ao->priority);
+		}
+		EVENT_QUEUE_EXIT_CRITICAL(primask);
+
+		// Run to completion, the event is valid until the next one of the object
+		if (event != NO_EVENTS)
+		{
+			fsmCycle(&ao->state, event);
+			dispatched = true;
+		}
+	}
+	else if (idleHook)
+	{
+		idleHook();
+	}
+
+	// Return whether an event was dispatched
+	return dispatched;
+}
+
+bool aoTimeEventArm(ao_time_event_t* timeEvent, active_object_t* ao, void* event, uint32_t ticks, uint32_t period)
+{
+	bool succeed = false;
+
+	uint32_t primask;
+	EVENT_QUEUE_ENTER_CRITICAL(primask);
+	if (timeEvent->armed || timeEventsCount < AO_MAX_TIME_EVENTS)
+	{
+		timeEvent->ao = ao;
+		timeEvent->event = event;
+		timeEvent->counter = ticks ? ticks : 1;
+		timeEvent->period = period;
+		if (!timeEvent->armed)
+		{
+			timeEvent->armed = true;
+			timeEvents[timeEventsCount++] = timeEvent;
+		}
+		succeed = true;
+	}
+	EVENT_QUEUE_EXIT_CRITICAL(primask);
+
+	// Return the succeed status
+	return succeed;
+}
+
+void aoTimeEventDisarm(ao_time_event_t* timeEvent)
+{
+	uint32_t primask;
+	EVENT_QUEUE_ENTER_CRITICAL(primask);
+	if (timeEvent->armed)
+	{
+		for (uint8_t i = 0 ; i < timeEventsCount ; i++)
+		{
+			if (timeEvents[i] == timeEvent)
+			{
+				// The last armed time event takes its place
+				timeEvents[i] = timeEvents[--timeEventsCount];
+				break;
+			}
+		}
+		timeEvent->armed = false;
+	}
+	EVENT_QUEUE_EXIT_CRITICAL(primask);
+}
+
+void aoTick(void)
+{
+	uint8_t i = 0;
+	while (i < timeEventsCount)
+	{
+		ao_time_event_t* timeEvent = timeEvents[i];
+		if (--timeEvent->counter == 0)
+		{
+			aoPost(timeEvent->ao, timeEvent->event);
+			if (timeEvent->period)
+			{
+				timeEvent->counter = timeEvent->period;
+			}
+			else
+			{
+				// Disarming moves the last one to this position
+				aoTimeEventDisarm(timeEvent);
+				continue;
+			}
+		}
+		i++;
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+/******************************************************************************/
@@ -0,0 +1,140 @@
+/***************************************************************************//**
+  @file     active_object.h
+  @brief    Active Object runtime, built on the Event Queue and FSM libraries
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef ACTIVE_OBJECT_H_
+#define ACTIVE_OBJECT_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../event_queue/event_queue.h"
+#include "../fsm/fsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Maximum amount of active objects, each one with a different priority,
+// from 0 (lowest) to AO_MAX_OBJECTS - 1 (highest), up to 32
+#ifndef AO_MAX_OBJECTS
+#define AO_MAX_OBJECTS				8
+#endif
+
+// Maximum amount of time events armed at the same time
+#ifndef AO_MAX_TIME_EVENTS
+#define AO_MAX_TIME_EVENTS			16
+#endif
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Active Objects
+// Each active object owns a private Event Queue and a FSM. Events are posted
+// to the object, from ISRs, driver callbacks or other objects, and the runtime
+// dispatches them to its FSM, one at a time and run to completion, always to
+// the object with the highest priority with events. Objects without events
+// are not called at all, and when no object has events, the idle hook runs,
+// where the application can sleep until the next interrupt.
+//
+// static event_t buffer[10];
+// static active_object_t blinker;
+//
+// blinker.queue = createEventQueue(buffer, 10, sizeof(event_t));
+// aoRegister(&blinker, 1, STATE_OFF);
+// ...
+// while (1) aoRun();
+typedef struct active_object {
+	event_queue_t	queue;		// Private queue of events
+	state_t			state;		// Current state of the FSM
+	uint8_t			priority;	// Priority of the object, unique
+} active_object_t;
+
+// Time events are posted to an active object after the given amount of ticks
+// of aoTick(), once or periodically. The event is not copied until posted, so
+// it must live while the time event is armed.
+typedef struct {
+	active_object_t*	ao;			// Active object which receives the event
+	void*				event;		// Event to be posted
+	uint32_t			counter;	// Ticks until the next post
+	uint32_t			period;		// Ticks between posts, or 0 if only once
+	bool				armed;		// Whether the time event is armed
+} ao_time_event_t;
+
+// Hook called by aoRun() when no active object has events
+typedef void (*ao_idle_hook_t)(void);
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Registers an active object, its queue must be already created. Returns
+ * 		  false if the priority is out of range or already used.
+ * @param ao			Pointer to the active object
+ * @param priority		Priority of the object, from 0 to AO_MAX_OBJECTS - 1
+ * @param initial		Initial state of its FSM
+ */
+bool aoRegister(active_object_t* ao, uint8_t priority, state_t initial);
+
+/**
+ * @brief Sets the hook called when no active object has events, or NULL
+ * @param hook			Callback of the idle hook
+ */
+void aoSetIdleHook(ao_idle_hook_t hook);
+
+/**
+ * @brief Posts an event to the active object, it can be called from an ISR. The
+ * 		  event is copied. Returns false if the queue of the object was full.
+ * @param ao			Pointer to the active object
+ * @param event			Pointer to the event
+ */
+bool aoPost(active_object_t* ao, void* event);
+
+/**
+ * @brief Dispatches one event to the active object with the highest priority
+ * 		  with events. Returns true if an event was dispatched, or false after
+ * 		  calling the idle hook.
+ */
+bool aoRun(void);
+
+/**
+ * @brief Arms a time event, posted after the given amount of ticks, and then
+ * 		  every period ticks if the period is not zero. Returns false if there
+ * 		  are already AO_MAX_TIME_EVENTS armed.
+ * @param timeEvent		Pointer to the time event
+ * @param ao			Active object which receives the event
+ * @param event			Event to be posted
+ * @param ticks			Ticks until the first post, at least 1
+ * @param period		Ticks between posts, or 0 if only once
+ */
+bool aoTimeEventArm(ao_time_event_t* timeEvent, active_object_t* ao, void* event, uint32_t ticks, uint32_t period);
+
+/**
+ * @brief Disarms a time event
+ * @param timeEvent		Pointer to the time event
+ */
+void aoTimeEventDisarm(ao_time_event_t* timeEvent);
+
+/**
+ * @brief Counts a tick for the time events, call it periodically, for example
+ * 		  from a SysTick subscriber, or from a simulated tick on the host.
+ */
+void aoTick(void);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif /* ACTIVE_OBJECT_H_ */
@@ -44,9 +44,11 @@
 
 void arrayRemove(void* array, uint32_t index, size_t arraySize, size_t elementSize)
 {
-	for (uint32_t arrayIndex = index + 1; arrayIndex < arraySize; arrayIndex++)
+	// Moves every element after the index in a single block, memmove
+	// handles the overlapping between the source and the destination
+	if (index + 1 < arraySize)
 	{
-		memcpy((uint8_t*)array + (arrayIndex - 1) * elementSize, (uint8_t*)array + arrayIndex * elementSize, elementSize);
+		memmove((uint8_t*)array + index * elementSize, (uint8_t*)array + (index + 1) * elementSize, (arraySize - index - 1) * elementSize);
 	}
 }
 
@@ -12,6 +12,7 @@
  ******************************************************************************/
 
 #include <stdint.h>
+#include <stddef.h>
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -8,6 +8,8 @@
  * INCLUDE HEADER FILES
  ******************************************************************************/
 
+#include <string.h>
+
 #include "event_queue.h"
 
 /*******************************************************************************
@@ -29,6 +31,13 @@
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+/**
+ * @brief Returns the coalescing rule of the event ID, or NULL if it has none.
+ * @param queue			Pointer to the Event Queue instance
+ * @param id			Event ID
+ */
+static event_coalesce_rule_t* findCoalesceRule(event_queue_t* queue, uint32_t id);
+
 
 /*******************************************************************************
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
@@ -49,13 +58,65 @@
 event_queue_t createEventQueue(void* buffer, size_t queueSize, size_t elementSize)
 {
 	event_queue_t newQueue = {
-			.queue = createQueue(buffer, queueSize, elementSize),
-			.generatorsCount = 0
+			.levels = { [EVENT_PRIORITY_DEFAULT] = createQueue(buffer, queueSize, elementSize) },
+			.ready = 0,
+			.enabledGenerators = 0,
+			.generatorsCount = 0,
+			.coalesceRulesCount = 0
 	};
 	return newQueue;
 }
 
-generator_id_t registerEventGenerator(event_queue_t* queue, event_generator_t generator)
+bool attachEventPriority(event_queue_t* queue, event_priority_t priority, void* buffer, size_t queueSize)
+{
+	bool succeed = false;
+
+#ifdef EVENT_QUEUE_DEVELOPMENT_MODE
+	if (queue && buffer && priority < EVENT_QUEUE_PRIORITY_LEVELS)
+#endif
+	{
+		if (priority != EVENT_PRIORITY_DEFAULT && queue->levels[priority].buffer == NULL)
+		{
+			queue->levels[priority] = createQueue(buffer, queueSize, queue->levels[EVENT_PRIORITY_DEFAULT].elementSize);
+			succeed = true;
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+bool setEventCoalescing(event_queue_t* queue, uint32_t id, event_coalesce_t policy, event_merge_t merge)
+{
+	bool succeed = false;
+
+#ifdef EVENT_QUEUE_DEVELOPMENT_MODE
+	if (queue && (policy != EVENT_COALESCE_MERGE || merge))
+#endif
+	{
+		uint32_t primask;
+		EVENT_QUEUE_ENTER_CRITICAL(primask);
+		event_coalesce_rule_t* rule = findCoalesceRule(queue, id);
+		if (rule == NULL && queue->coalesceRulesCount < MAX_EVENT_COALESCE_RULES)
+		{
+			rule = &queue->coalesceRules[queue->coalesceRulesCount++];
+			rule->id = id;
+			memset(rule->waiting, 0, sizeof(rule->waiting));
+		}
+		if (rule)
+		{
+			rule->policy = policy;
+			rule->merge = merge;
+			succeed = true;
+		}
+		EVENT_QUEUE_EXIT_CRITICAL(primask);
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+generator_id_t registerEventGenerator(event_queue_t* queue, event_generator_t generator, event_priority_t priority)
 {
 	generator_id_t id = OUT_OF_GENERATORS;
 
@@ -69,7 +130,8 @@ generator_id_t registerEventGenerator(event_queue_t* queue, event_generator_t ge
 #endif
 		{
 			queue->eventGenerators[queue->generatorsCount] = generator;
-			queue->enabledGenerators[queue->generatorsCount] = true;
+			queue->generatorPriorities[queue->generatorsCount] = priority;
+			queue->enabledGenerators |= (1U << queue->generatorsCount);
 			id = queue->generatorsCount++;
 		}
 	}
@@ -86,7 +148,14 @@ bool setEnable(event_queue_t* queue, generator_id_t id, bool enable)
 	if (queue && id < queue->generatorsCount)
 #endif
 	{
-		queue->enabledGenerators[id] = enable;
+		if (enable)
+		{
+			queue->enabledGenerators |= (1U << id);
+		}
+		else
+		{
+			queue->enabledGenerators &= ~(1U << id);
+		}
 		succeed = true;
 	}
 
@@ -94,6 +163,66 @@ bool setEnable(event_queue_t* queue, generator_id_t id, bool enable)
 	return succeed;
 }
 
+bool postEvent(event_queue_t* queue, void* event)
+{
+	return postPriorityEvent(queue, event, EVENT_PRIORITY_DEFAULT);
+}
+
+bool postPriorityEvent(event_queue_t* queue, void* event, event_priority_t priority)
+{
+	bool succeed = false;
+
+#ifdef EVENT_QUEUE_DEVELOPMENT_MODE
+	if (queue && event)
+#endif
+	{
+		// Levels without buffer fall back to the default level
+		if (priority >= EVENT_QUEUE_PRIORITY_LEVELS || queue->levels[priority].buffer == NULL)
+		{
+			priority = EVENT_PRIORITY_DEFAULT;
+		}
+
+		uint32_t primask;
+		EVENT_QUEUE_ENTER_CRITICAL(primask);
+		event_coalesce_rule_t* rule = queue->coalesceRulesCount ? findCoalesceRule(queue, EVENT_QUEUE_ID(event)) : NULL;
+		if (rule && rule->policy != EVENT_COALESCE_NONE && rule->waiting[priority])
+		{
+			// Another event with the same ID is waiting in the level, apply the policy.
+			// One waiting in another level is left, so the priority of the post is kept.
+			switch (rule->policy)
+			{
+				case EVENT_COALESCE_KEEP_LATEST:
+					memcpy(rule->waiting[priority], event, queue->levels[EVENT_PRIORITY_DEFAULT].elementSize);
+					break;
+				case EVENT_COALESCE_MERGE:
+					rule->merge(rule->waiting[priority], event);
+					break;
+				default:
+					break;
+			}
+			succeed = true;
+		}
+		else
+		{
+			queue_t* level = &queue->levels[priority];
+			succeed = push(level, event);
+			if (succeed)
+			{
+				queue->ready |= (1UL << priority);
+				if (rule)
+				{
+					// Remember the slot used, the rear points to the last element pushed
+					rule->waiting[priority] = level->buffer + level->rear * level->elementSize;
+				}
+			}
+		}
+		EVENT_QUEUE_EXIT_CRITICAL(primask);
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
 void* getNextEvent(event_queue_t* queue)
 {
 	void* element = NO_EVENTS;
@@ -102,26 +231,44 @@ void* getNextEvent(event_queue_t* queue)
 	if (queue)
 #endif
 	{
-		// Look for all events from generators
-		uint8_t	i;
+		// Look for events only from the enabled generators
+		uint16_t pending = queue->enabledGenerators;
 		void* ev;
-		for ( i = 0 ; i < queue->generatorsCount ; i++ )
+		while (pending)
 		{
-			// If the generator is enabled
-			if (queue->enabledGenerators[i])
+			uint8_t i = __builtin_ctz(pending);
+			pending &= pending - 1;
+			ev = queue->eventGenerators[i]();
+			if (ev != NO_EVENTS)
 			{
-				ev = queue->eventGenerators[i]();
-				if (ev != NO_EVENTS)
-				{
-					push(&queue->queue, ev);
-				}
+				postPriorityEvent(queue, ev, queue->generatorPriorities[i]);
 			}
 		}
 
-		// Get a new event element, if has any
-		if (!isEmpty(&queue->queue))
+		// Get a new event element from the highest level, if has any. The slot
+		// popped cannot be overwritten by a post until the next pop of its level,
+		// because the queue_t always keeps one free element between the rear and the front.
+		if (queue->ready)
 		{
-			element = pop(&queue->queue);
+			uint32_t primask;
+			EVENT_QUEUE_ENTER_CRITICAL(primask);
+			uint8_t level = 31 - __builtin_clz(queue->ready);
+			element = pop(&queue->levels[level]);
+			if (isEmpty(&queue->levels[level]))
+			{
+				queue->ready &= ~(1UL << level);
+			}
+
+			// Once popped, the event cannot be coalesced anymore
+			for (uint8_t i = 0 ; i < queue->coalesceRulesCount ; i++)
+			{
+				if (queue->coalesceRules[i].waiting[level] == element)
+				{
+					queue->coalesceRules[i].waiting[level] = NULL;
+					break;
+				}
+			}
+			EVENT_QUEUE_EXIT_CRITICAL(primask);
 		}
 	}
 
@@ -135,5 +282,19 @@ void* getNextEvent(event_queue_t* queue)
  *******************************************************************************
  ******************************************************************************/
 
+static event_coalesce_rule_t* findCoalesceRule(event_queue_t* queue, uint32_t id)
+{
+	event_coalesce_rule_t* rule = NULL;
+	for (uint8_t i = 0 ; i < queue->coalesceRulesCount ; i++)
+	{
+		if (queue->coalesceRules[i].id == id)
+		{
+			rule = &queue->coalesceRules[i];
+			break;
+		}
+	}
+	return rule;
+}
+
 
 /******************************************************************************/
@@ -26,26 +26,92 @@
 #define	OUT_OF_GENERATORS				MAX_EVENT_GENERATORS
 #define EVENT_QUEUE_STANDARD_MAX_SIZE	QUEUE_STANDARD_MAX_SIZE
 
+// Priority levels of the Event Queue, up to 32. Higher levels are dispatched
+// first, the level 0 is the default one, created with the Event Queue.
+#ifndef EVENT_QUEUE_PRIORITY_LEVELS
+#define EVENT_QUEUE_PRIORITY_LEVELS		4
+#endif
+#define EVENT_PRIORITY_DEFAULT			0
+#define EVENT_PRIORITY_HIGHEST			(EVENT_QUEUE_PRIORITY_LEVELS - 1)
+
+// Maximum amount of event IDs with a coalescing policy
+#ifndef MAX_EVENT_COALESCE_RULES
+#define MAX_EVENT_COALESCE_RULES		8
+#endif
+
+// Get the ID of an event, the first element of the event MUST be an uint32_t,
+// as the event_id_t of the FSM library.
+#define EVENT_QUEUE_ID(ev)				(*(uint32_t*)(ev))
+
+// Critical section used to post events, so ISRs, driver callbacks and the
+// main loop can push to the same queue. On the Cortex-M the PRIMASK is saved
+// and restored, so it can be nested inside other critical sections. Define
+// your own macros before including this header to use another mechanism.
+#ifndef EVENT_QUEUE_ENTER_CRITICAL
+#if defined(__arm__)
+#define EVENT_QUEUE_ENTER_CRITICAL(primask)	__asm volatile ("mrs %0, primask\n\tcpsid i" : "=r" (primask) : : "memory")
+#define EVENT_QUEUE_EXIT_CRITICAL(primask)	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory")
+#else
+#define EVENT_QUEUE_ENTER_CRITICAL(primask)	((void)(primask = 0))
+#define EVENT_QUEUE_EXIT_CRITICAL(primask)	((void)(primask))
+#endif
+#endif
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
-// Events are injected in the Event Queue by Event Generators
-// registered in it, so every time the queue updates the events, calls
-// all its generators.
+// Events are posted to the Event Queue with postEvent(), from ISRs, driver
+// callbacks or the main loop. As a compatibility mode, events can also be
+// injected by Event Generators registered in it, so every time the queue
+// updates the events, calls all its enabled generators.
 // When registering a new event generator, the event queue will return its id.
 typedef	void* (*event_generator_t)(void);
 
 typedef	uint8_t	generator_id_t;
 
+typedef uint8_t event_priority_t;
+
+// Coalescing policies, applied when an event is posted while another event
+// with the same ID is still waiting in the same priority level, so bursty
+// producers only take one slot of each level for each ID.
+typedef enum {
+	EVENT_COALESCE_NONE,			// Every event takes its own slot
+	EVENT_COALESCE_KEEP_LATEST,		// The waiting event is overwritten by the new one
+	EVENT_COALESCE_DROP_DUPLICATE,	// The new event is dropped
+	EVENT_COALESCE_MERGE			// The new event is merged into the waiting one by a callback
+} event_coalesce_t;
+
+// Callback used to merge a new event into the waiting one, for example adding
+// the encoder ticks of the new event to the waiting one. It is called
+// within a critical section, so it should be short.
+typedef void (*event_merge_t)(void* waiting, void* event);
+
+// Coalescing rule of an event ID
+typedef struct {
+	uint32_t			id;			// Event ID
+	event_coalesce_t	policy;		// Coalescing policy of the ID
+	event_merge_t		merge;		// Callback used by EVENT_COALESCE_MERGE
+	void*				waiting[EVENT_QUEUE_PRIORITY_LEVELS];	// Slot of the event with the ID in each level, or NULL
+} event_coalesce_rule_t;
+
 // The implementation of the Event Queue uses one element to distinguish
 // between a full and an empty queue, so the queueSize should be always
 // one more than the actual maximum size desired.
+// Each priority level has its own queue, the default level uses the buffer
+// given when created, the others are attached with attachEventPriority().
+// Events posted to a level without buffer go to the default level.
+// The ready bit mask has a bit set for each level with pending events, so the
+// highest level is found with a count leading zeros instruction.
 typedef struct event_queue{
-	queue_t				queue;									 // Queue to save events
+	queue_t				levels[EVENT_QUEUE_PRIORITY_LEVELS];	 // Queues to save events, one per priority
+	volatile uint32_t	ready;									 // Bit mask of levels with events
 	event_generator_t	eventGenerators[MAX_EVENT_GENERATORS];	 // Registered event generators
-	bool				enabledGenerators[MAX_EVENT_GENERATORS]; // Generators can be ignored
+	event_priority_t	generatorPriorities[MAX_EVENT_GENERATORS];// Priority of the events of each generator
+	uint16_t			enabledGenerators;						 // Bit mask of generators enabled
 	uint8_t				generatorsCount;						 // Amount of registered event generators
+	event_coalesce_rule_t coalesceRules[MAX_EVENT_COALESCE_RULES];// Coalescing policies of event IDs
+	uint8_t				coalesceRulesCount;						 // Amount of coalescing rules
 } event_queue_t;
 
 
@@ -65,13 +131,35 @@ typedef struct event_queue{
  */
 event_queue_t createEventQueue(void* buffer, size_t queueSize, size_t elementSize);
 
+/**
+ * @brief Attaches a buffer to a priority level of the Event Queue, with the same
+ * 		  element size of the default level. Returns true if succeed.
+ * @param queue			Pointer to the Event Queue instance
+ * @param priority		Priority level, from 1 to EVENT_PRIORITY_HIGHEST
+ * @param buffer		Pointer to the array reserved in memory
+ * @param queueSize		Amount of elements in the array (fixed)
+ */
+bool attachEventPriority(event_queue_t* queue, event_priority_t priority, void* buffer, size_t queueSize);
+
+/**
+ * @brief Sets the coalescing policy of an event ID, the merge callback is only
+ * 		  used by EVENT_COALESCE_MERGE. Returns true if succeed, or false when
+ * 		  there is no space for more rules.
+ * @param queue			Pointer to the Event Queue instance
+ * @param id			Event ID
+ * @param policy		Coalescing policy
+ * @param merge			Callback to merge events, or NULL
+ */
+bool setEventCoalescing(event_queue_t* queue, uint32_t id, event_coalesce_t policy, event_merge_t merge);
+
 /**
  * @brief Registers an event generator. Returns the generator id if
  * 		  succeed or OUT_OF_GENERATORS on error.
  * @param queue			Pointer to the Event Queue instance
  * @param generator 	Callback to the generator
+ * @param priority		Priority of the events of the generator
  */
-generator_id_t registerEventGenerator(event_queue_t* queue, event_generator_t generator);
+generator_id_t registerEventGenerator(event_queue_t* queue, event_generator_t generator, event_priority_t priority);
 
 /**
  * @brief Enables/Disables generator. Returns true if the generator existed,
@@ -83,8 +171,30 @@ generator_id_t registerEventGenerator(event_queue_t* queue, event_generator_t ge
 bool setEnable(event_queue_t* queue, generator_id_t id, bool enable);
 
 /**
- * @brief Returns next event from the queue, returns NO_EVENTS if there are
- * 		  no events.
+ * @brief Posts a new event to the queue, it can be called from an ISR. The
+ * 		  event is copied, so it can be a local variable. Returns true if
+ * 		  succeed or false if the queue was full. When the ID of the event has
+ * 		  a coalescing policy and another event with the same ID is waiting
+ * 		  in the same level, the policy is applied and no slot is used.
+ * @param queue			Pointer to the Event Queue instance
+ * @param event			Pointer to the event to be posted
+ */
+bool postEvent(event_queue_t* queue, void* event);
+
+/**
+ * @brief Same as postEvent(), with the given priority level.
+ * @param queue			Pointer to the Event Queue instance
+ * @param event			Pointer to the event to be posted
+ * @param priority		Priority level of the event
+ */
+bool postPriorityEvent(event_queue_t* queue, void* event, event_priority_t priority);
+
+/**
+ * @brief Returns next event from the queue, from the highest priority level with
+ * 		  events, returns NO_EVENTS if there are no events. Only the enabled
+ * 		  generators are called, when there are none, it returns immediately
+ * 		  and the main loop can sleep until the next interrupt. The event
+ * 		  returned is valid until the next call.
  * @param queue			Pointer to the Event Queue instance
  */
 void* getNextEvent(event_queue_t* queue);
@@ -11,10 +11,21 @@
 
 #include "fsm.h"
 
+#ifdef FSM_TRACE_ENABLED
+#include "../general/general.h"
+#endif
+
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
+#if (FSM_TRACE_SIZE & (FSM_TRACE_SIZE - 1)) != 0
+#error "FSM_TRACE_SIZE must be a power of two"
+#endif
+
+#define TRACE_LINE_MAX_SIZE		64
+#define TRACE_HEADER			"timestamp,state,event,edge,flags\r\n"
+
 
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
@@ -28,6 +39,34 @@
  * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+/**
+ * @brief Returns the edge of the state for the event, or its default edge
+ * @param state		State of the machine
+ * @param id		Event ID
+ */
+static edge_t* findEdge(state_t state, event_id_t id);
+
+/**
+ * @brief Returns the index of the state in the array, or statesCount if not found
+ * @param states		Array of the states of the machine
+ * @param statesCount	Amount of states
+ * @param state			State to be found
+ */
+static uint16_t findStateIndex(const state_t* states, uint16_t statesCount, state_t state);
+
+#ifdef FSM_TRACE_ENABLED
+
+/**
+ * @brief Appends a record to the trace, overwriting the oldest one when full
+ * @param state		Address of the state, or its index in the dense mode
+ * @param event		Event ID
+ * @param edge		Index of the edge taken
+ * @param flags		FSM_TRACE_DEFAULT_EDGE and FSM_TRACE_DENSE
+ */
+static inline void traceRecord(uint32_t state, event_id_t event, uint8_t edge, uint8_t flags);
+
+#endif
+
 
 /*******************************************************************************
  * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
@@ -39,6 +78,11 @@
  * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
  ******************************************************************************/
 
+#ifdef FSM_TRACE_ENABLED
+static fsm_trace_record_t	trace[FSM_TRACE_SIZE];
+static uint32_t				traceCount = 0;		// Free running counter of records
+#endif
+
 
 /*******************************************************************************
  *******************************************************************************
@@ -58,6 +102,11 @@ void fsmCycle(state_t* state, void* event)
 		currentState++;
 	}
 
+#ifdef FSM_TRACE_ENABLED
+	traceRecord((uint32_t)(uintptr_t)(*state), newEvent, currentState - *state,
+				currentState->event == END_OF_STATE ? FSM_TRACE_DEFAULT_EDGE : 0);
+#endif
+
 	// When found the edge or the end of state
 	currentState->action(event);
 
@@ -65,6 +114,106 @@ void fsmCycle(state_t* state, void* event)
 	*state = currentState->nextState;
 }
 
+bool fsmDenseBuild(const state_t* states, uint16_t statesCount, uint16_t eventsCount, fsm_dense_entry_t* table)
+{
+	bool succeed = true;
+
+	for (uint16_t stateIndex = 0 ; stateIndex < statesCount ; stateIndex++)
+	{
+		for (uint16_t id = 0 ; id < eventsCount ; id++)
+		{
+			edge_t* edge = findEdge(states[stateIndex], id);
+			fsm_dense_entry_t* entry = &table[stateIndex * eventsCount + id];
+			entry->action = edge->action;
+			entry->edgeIndex = edge - states[stateIndex];
+			entry->isDefault = edge->event == END_OF_STATE;
+			entry->nextIndex = findStateIndex(states, statesCount, edge->nextState);
+			if (entry->nextIndex == statesCount)
+			{
+				// The next state is unknown, stay in the current state
+				entry->nextIndex = stateIndex;
+				succeed = false;
+			}
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+fsm_dense_t createDenseFsm(const state_t* states, uint16_t statesCount, uint16_t eventsCount, const fsm_dense_entry_t* table, uint16_t initial)
+{
+	fsm_dense_t fsm = {
+			.states = states,
+			.table = table,
+			.statesCount = statesCount,
+			.eventsCount = eventsCount,
+			.current = initial
+	};
+	return fsm;
+}
+
+void fsmDenseCycle(fsm_dense_t* fsm, void* event)
+{
+	event_id_t newEvent = EVENT_ID(event);
+
+	if (newEvent < fsm->eventsCount)
+	{
+		// One look-up in the table
+		const fsm_dense_entry_t* entry = &fsm->table[fsm->current * fsm->eventsCount + newEvent];
+#ifdef FSM_TRACE_ENABLED
+		traceRecord(fsm->current, newEvent, entry->edgeIndex,
+					FSM_TRACE_DENSE | (entry->isDefault ? FSM_TRACE_DEFAULT_EDGE : 0));
+#endif
+		entry->action(event);
+		fsm->current = entry->nextIndex;
+	}
+	else
+	{
+		// Out of the table, scan the edges as fsmCycle() does
+		edge_t* edge = findEdge(fsm->states[fsm->current], newEvent);
+#ifdef FSM_TRACE_ENABLED
+		traceRecord(fsm->current, newEvent, edge - fsm->states[fsm->current],
+					FSM_TRACE_DENSE | (edge->event == END_OF_STATE ? FSM_TRACE_DEFAULT_EDGE : 0));
+#endif
+		edge->action(event);
+		uint16_t nextIndex = findStateIndex(fsm->states, fsm->statesCount, edge->nextState);
+		if (nextIndex < fsm->statesCount)
+		{
+			fsm->current = nextIndex;
+		}
+	}
+}
+
+#ifdef FSM_TRACE_ENABLED
+
+void fsmTraceDump(text_writer_t writer)
+{
+	char line[TRACE_LINE_MAX_SIZE];
+	uint32_t first = traceCount > FSM_TRACE_SIZE ? traceCount - FSM_TRACE_SIZE : 0;
+
+	writer(TRACE_HEADER, sizeof(TRACE_HEADER) - 1);
+	for (uint32_t count = first ; count != traceCount ; count++)
+	{
+		const fsm_trace_record_t* record = &trace[count & (FSM_TRACE_SIZE - 1)];
+		size_t length = 0;
+		length += appendNumber(line + length, record->timestamp, ',');
+		length += appendNumber(line + length, record->state, ',');
+		length += appendNumber(line + length, record->event, ',');
+		length += appendNumber(line + length, record->edge, ',');
+		length += appendNumber(line + length, record->flags, '\r');
+		line[length++] = '\n';
+		writer(line, length);
+	}
+}
+
+void fsmTraceClear(void)
+{
+	traceCount = 0;
+}
+
+#endif
+
 void __do_nothing__(void* event)
 {
 
@@ -76,6 +225,36 @@ void __do_nothing__(void* event)
  *******************************************************************************
  ******************************************************************************/
 
+static edge_t* findEdge(state_t state, event_id_t id)
+{
+	while (state->event != id && state->event != END_OF_STATE)
+	{
+		state++;
+	}
+	return state;
+}
+
+static uint16_t findStateIndex(const state_t* states, uint16_t statesCount, state_t state)
+{
+	uint16_t index;
+	for (index = 0 ; index < statesCount && states[index] != state ; index++);
+	return index;
+}
+
+#ifdef FSM_TRACE_ENABLED
+
+static inline void traceRecord(uint32_t state, event_id_t event, uint8_t edge, uint8_t flags)
+{
+	fsm_trace_record_t* record = &trace[traceCount++ & (FSM_TRACE_SIZE - 1)];
+	record->timestamp = FSM_TRACE_TIMESTAMP();
+	record->state = state;
+	record->event = event;
+	record->edge = edge;
+	record->flags = flags;
+}
+
+#endif
+
 
 
 /******************************************************************************/
@@ -5,7 +5,7 @@
  ******************************************************************************/
 
 #ifndef FSM_FSM_H_
-#define FSM_FSM_H
+#define FSM_FSM_H_
 
 /*******************************************************************************
  * INCLUDE HEADER FILES
@@ -15,6 +15,8 @@
 #include <stdbool.h>
 #include <stdlib.h>
 
+#include "../general/general.h"
+
 /*******************************************************************************
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
@@ -49,12 +51,44 @@ struct edge {
     action_t       	action;
 };
 
+// Dense dispatch mode
+// The edges of every state are resolved into a table with one entry for each
+// state and event ID, from 0 to eventsCount - 1, so the FSM cycles in constant
+// time, without scanning the edges. Events without an edge in the state take
+// the entry of the default edge, so the semantics are the same as fsmCycle().
+// The table is built from the same edge_t arrays with fsmDenseBuild(), or can
+// be generated at compile time as a const array. It takes statesCount * eventsCount
+// entries, so use it for machines with dense and small event IDs.
+typedef struct {
+	action_t	action;			// Action of the edge
+	uint16_t	nextIndex;		// Index of the next state in the array of states
+	uint8_t		edgeIndex;		// Index of the edge in the state, used by the trace
+	bool		isDefault;		// Whether it is the default edge, used by the trace
+} fsm_dense_entry_t;
+
+typedef struct {
+	const state_t*				states;			// Array of the states of the machine
+	const fsm_dense_entry_t*	table;			// Entries, indexed by state * eventsCount + event ID
+	uint16_t					statesCount;	// Amount of states
+	uint16_t					eventsCount;	// Amount of event IDs in the table
+	uint16_t					current;		// Index of the current state
+} fsm_dense_t;
+
+// Record of the trace, one for each cycle of a machine
+typedef struct {
+	uint32_t	timestamp;		// FSM_TRACE_TIMESTAMP() when cycled
+	uint32_t	state;			// Address of the state, or its index in the dense mode
+	uint16_t	event;			// Event ID, truncated to 16 bits
+	uint8_t		edge;			// Index of the edge taken in the state
+	uint8_t		flags;			// FSM_TRACE_DEFAULT_EDGE and FSM_TRACE_DENSE
+} fsm_trace_record_t;
+
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
 
 // Definition of the end of the state, when no edge found for the current event
-#define END_OF_STATE						(uint32_t)0xFFFFFFFFF
+#define END_OF_STATE						(uint32_t)0xFFFFFFFF
 
 // Definition of an empty action routine, do nothing
 void 	__do_nothing__(void* event);
@@ -70,6 +104,32 @@ void 	__do_nothing__(void* event);
 // Verify current state of the machine state
 #define IS_CURRENT_STATE(fsm, state)			((fsm) == state)
 
+// Current state of a dense machine, as a state_t
+#define DENSE_FSM_STATE(fsm)					((fsm)->states[(fsm)->current])
+
+// Size of the table of a dense machine, in entries
+#define DENSE_FSM_TABLE_SIZE(states, events)	((states) * (events))
+
+// FSM trace feature!
+// You can create a define with FSM_TRACE_ENABLED to record every cycle of the
+// machines, fsmCycle() and fsmDenseCycle(), in a ring of the last FSM_TRACE_SIZE
+// records, which can be dumped with fsmTraceDump() and decoded with
+// Tools/fsm_trace/fsm_trace_decoder.py. Records are taken with a few stores.
+// The timestamp is taken with FSM_TRACE_TIMESTAMP(), define it with your clock,
+// for example (DWT->CYCCNT), or the records will have no time.
+// These defines must be visible when compiling fsm.c, as compiler flags.
+//
+// #define FSM_TRACE_ENABLED
+#ifndef FSM_TRACE_SIZE
+#define FSM_TRACE_SIZE							64
+#endif
+#ifndef FSM_TRACE_TIMESTAMP
+#define FSM_TRACE_TIMESTAMP()					0
+#endif
+
+#define FSM_TRACE_DEFAULT_EDGE					0x01
+#define FSM_TRACE_DENSE							0x02
+
 /*******************************************************************************
  * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -81,4 +141,49 @@ void 	__do_nothing__(void* event);
  */
 void fsmCycle(state_t* state, void* event);
 
+/**
+ * @brief Resolves the edges of the states into the table of the dense mode. Returns
+ * 		  false if an edge goes to a state that is not in the array of states.
+ * @param states		Array of the states of the machine
+ * @param statesCount	Amount of states
+ * @param eventsCount	Amount of event IDs resolved, from 0 to eventsCount - 1
+ * @param table			Table of DENSE_FSM_TABLE_SIZE(statesCount, eventsCount) entries
+ */
+bool fsmDenseBuild(const state_t* states, uint16_t statesCount, uint16_t eventsCount, fsm_dense_entry_t* table);
+
+/**
+ * @brief Creates a dense machine instance from its states and table
+ * @param states		Array of the states of the machine
+ * @param statesCount	Amount of states
+ * @param eventsCount	Amount of event IDs in the table
+ * @param table			Table built by fsmDenseBuild() or generated at compile time
+ * @param initial		Index of the initial state
+ */
+fsm_dense_t createDenseFsm(const state_t* states, uint16_t statesCount, uint16_t eventsCount, const fsm_dense_entry_t* table, uint16_t initial);
+
+/**
+ * @brief Cycles the current state of the dense machine, events with IDs out of
+ * 		  the table fall back to scanning the edges of the current state.
+ * @param fsm		Pointer to the dense machine
+ * @param event		Current event received
+ */
+void fsmDenseCycle(fsm_dense_t* fsm, void* event);
+
+#ifdef FSM_TRACE_ENABLED
+
+/**
+ * @brief Writes the records of the trace, from the oldest to the newest, as comma
+ * 		  separated values: timestamp,state,event,edge,flags. Only call it from
+ * 		  the same context that cycles the machines.
+ * @param writer	Callback used to write each line
+ */
+void fsmTraceDump(text_writer_t writer);
+
+/**
+ * @brief Discards every record of the trace
+ */
+void fsmTraceClear(void);
+
+#endif
+
 #endif /* FSM_FSM_H_ */
@@ -11,7 +11,6 @@
 #include "general.h"
 
 #include <stdio.h>
-#include <math.h>
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -61,12 +60,11 @@ uint8_t number2ASCII(uint8_t number)
 
 uint32_t array2Number(uint8_t *arrayNumber, size_t length)
 {
+    // Horner's method, avoids the floating point pow() of the weights
     uint32_t number = 0;
-    uint32_t weight = (uint32_t)pow(10, length - 1);
-    for (uint8_t arrayIndex = 0; arrayIndex < length; arrayIndex++)
+    for (size_t arrayIndex = 0; arrayIndex < length; arrayIndex++)
     {
-        number += arrayNumber[arrayIndex] * weight;
-        weight /= 10;
+        number = number * 10 + arrayNumber[arrayIndex];
     }
     return number;
 }
@@ -82,6 +80,14 @@ void number2Array(uint32_t number, uint8_t *arrayNumber, uint8_t length, uint8_t
 	}
 }
 
+size_t appendNumber(char* line, uint32_t number, char separator)
+{
+	uint8_t length = number ? getNumberLength(number) : 1;
+	number2Array(number, (uint8_t*)line, length, number2ASCII);
+	line[length] = separator;
+	return length + 1;
+}
+
 /*******************************************************************************
  *******************************************************************************
                         LOCAL FUNCTION DEFINITIONS
@@ -12,6 +12,7 @@
  ******************************************************************************/
 
 #include <stdint.h>
+#include <stddef.h>
 
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
@@ -21,6 +22,10 @@
  * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
  ******************************************************************************/
 
+// Callback used to write text, for example a wrapper of uartWriteMsg()
+// waiting until uartCanTx() for the given length
+typedef void (*text_writer_t)(const char* text, size_t length);
+
 /*******************************************************************************
  * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
  ******************************************************************************/
@@ -60,6 +65,16 @@ uint32_t array2Number(uint8_t *arrayNumber, size_t length);
  */
 void number2Array(uint32_t number, uint8_t *arrayNumber, uint8_t length, uint8_t (*transform)(uint8_t));
 
+/**
+ * @brief Appends the ASCII representation of a number and a separator to a line
+ * 		  number 1234, separator ',' -> "1234,"
+ * @param line			Line being built
+ * @param number		Number to be appended
+ * @param separator		Character appended after the number
+ * @return Amount of characters appended
+ */
+size_t appendNumber(char* line, uint32_t number, char separator);
+
 /*******************************************************************************
  ******************************************************************************/
 
@@ -0,0 +1,272 @@
+/***************************************************************************//**
+  @file     hsm.c
+  @brief    Hierarchical State Machine Library
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include "hsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Returns the index of the state in the array, or statesCount if not found
+ * @param hsm		Pointer to the machine instance
+ * @param state		State to be found
+ */
+static uint16_t findStateIndex(hsm_t* hsm, const hsm_state_t* state);
+
+/**
+ * @brief Returns the index of the state reached when entering the given one,
+ * 		  going down through the initial children, or statesCount on error
+ * @param hsm		Pointer to the machine instance
+ * @param index		Index of the state entered
+ */
+static uint16_t resolveInitial(hsm_t* hsm, uint16_t index);
+
+/**
+ * @brief Resolves the transition of the state for the event ID
+ * @param hsm		Pointer to the machine instance
+ * @param index		Index of the current state
+ * @param id		Event ID
+ * @param entry		Entry of the table to be resolved
+ * @return False if the target state is not in the array of states
+ */
+static bool resolveEntry(hsm_t* hsm, uint16_t index, event_id_t id, hsm_entry_t* entry);
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool hsmBuild(hsm_t* hsm, const hsm_state_t* const* states, uint16_t statesCount, uint16_t eventsCount, hsm_entry_t* table, hsm_path_t* paths)
+{
+	bool succeed = true;
+
+	hsm->states = states;
+	hsm->table = table;
+	hsm->paths = paths;
+	hsm->statesCount = statesCount;
+	hsm->eventsCount = eventsCount;
+	hsm->current = 0;
+
+	// Paths of ancestors, first collected from the state up, then reversed
+	for (uint16_t index = 0 ; index < statesCount && succeed ; index++)
+	{
+		hsm_path_t* path = &paths[index];
+		const hsm_state_t* state = states[index];
+		path->depth = 0;
+		while (state && succeed)
+		{
+			uint16_t stateIndex = findStateIndex(hsm, state);
+			if (path->depth < HSM_MAX_DEPTH && stateIndex < statesCount)
+			{
+				path->states[path->depth++] = stateIndex;
+				state = state->parent;
+			}
+			else
+			{
+				succeed = false;
+			}
+		}
+		for (uint8_t i = 0 ; i < path->depth / 2 ; i++)
+		{
+			uint16_t aux = path->states[i];
+			path->states[i] = path->states[path->depth - 1 - i];
+			path->states[path->depth - 1 - i] = aux;
+		}
+	}
+
+	// Transitions of each state and event ID
+	for (uint16_t index = 0 ; index < statesCount && succeed ; index++)
+	{
+		for (uint16_t id = 0 ; id < eventsCount && succeed ; id++)
+		{
+			succeed = resolveEntry(hsm, index, id, &table[index * eventsCount + id]);
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+void hsmStart(hsm_t* hsm, uint16_t initial)
+{
+	hsm->current = resolveInitial(hsm, initial);
+
+	hsm_path_t* path = &hsm->paths[hsm->current];
+	for (uint8_t i = 0 ; i < path->depth ; i++)
+	{
+		const hsm_state_t* state = hsm->states[path->states[i]];
+		if (state->entry)
+		{
+			state->entry(NULL);
+		}
+	}
+}
+
+void hsmDispatch(hsm_t* hsm, void* event)
+{
+	event_id_t id = EVENT_ID(event);
+
+	if (id < hsm->eventsCount)
+	{
+		const hsm_entry_t* entry = &hsm->table[hsm->current * hsm->eventsCount + id];
+		if (entry->target == HSM_INTERNAL_TARGET)
+		{
+			if (entry->action)
+			{
+				entry->action(event);
+			}
+		}
+		else if (entry->target != HSM_UNHANDLED)
+		{
+			// Exit from the current state up, to the common ancestor
+			const hsm_path_t* path = &hsm->paths[hsm->current];
+			for (uint8_t i = 0 ; i < entry->exitCount ; i++)
+			{
+				const hsm_state_t* state = hsm->states[path->states[path->depth - 1 - i]];
+				if (state->exit)
+				{
+					state->exit(event);
+				}
+			}
+
+			if (entry->action)
+			{
+				entry->action(event);
+			}
+
+			// Enter from the common ancestor down, to the target
+			path = &hsm->paths[entry->target];
+			for (uint8_t i = entry->entryFrom ; i < path->depth ; i++)
+			{
+				const hsm_state_t* state = hsm->states[path->states[i]];
+				if (state->entry)
+				{
+					state->entry(event);
+				}
+			}
+
+			hsm->current = entry->target;
+		}
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static uint16_t findStateIndex(hsm_t* hsm, const hsm_state_t* state)
+{
+	uint16_t index;
+	for (index = 0 ; index < hsm->statesCount && hsm->states[index] != state ; index++);
+	return index;
+}
+
+static uint16_t resolveInitial(hsm_t* hsm, uint16_t index)
+{
+	for (uint8_t level = 0 ; level < HSM_MAX_DEPTH && index < hsm->statesCount && hsm->states[index]->initial ; level++)
+	{
+		index = findStateIndex(hsm, hsm->states[index]->initial);
+	}
+	return index;
+}
+
+static bool resolveEntry(hsm_t* hsm, uint16_t index, event_id_t id, hsm_entry_t* entry)
+{
+	bool succeed = true;
+
+	// Looks for the edge in the state, then in its ancestors
+	const hsm_path_t* path = &hsm->paths[index];
+	const hsm_edge_t* edge = NULL;
+	uint8_t level = path->depth;
+	while (edge == NULL && level > 0)
+	{
+		const hsm_edge_t* candidate = hsm->states[path->states[--level]]->edges;
+		while (candidate && candidate->event != END_OF_STATE && candidate->event != id)
+		{
+			candidate++;
+		}
+		if (candidate && candidate->event == id)
+		{
+			edge = candidate;
+		}
+	}
+
+	entry->action = DO_NOTHING;
+	entry->target = HSM_UNHANDLED;
+	entry->exitCount = 0;
+	entry->entryFrom = 0;
+
+	if (edge && edge->target == HSM_INTERNAL)
+	{
+		entry->action = edge->action;
+		entry->target = HSM_INTERNAL_TARGET;
+	}
+	else if (edge)
+	{
+		uint16_t source = path->states[level];
+		uint16_t target = findStateIndex(hsm, edge->target);
+		uint16_t leaf = target < hsm->statesCount ? resolveInitial(hsm, target) : target;
+		if (leaf < hsm->statesCount)
+		{
+			// Levels shared by the source and the target of the edge, when one
+			// contains the other, that one is also exited and entered again
+			const hsm_path_t* sourcePath = &hsm->paths[source];
+			const hsm_path_t* targetPath = &hsm->paths[target];
+			uint8_t minDepth = sourcePath->depth < targetPath->depth ? sourcePath->depth : targetPath->depth;
+			uint8_t common = 0;
+			while (common < minDepth && sourcePath->states[common] == targetPath->states[common])
+			{
+				common++;
+			}
+			if (common == minDepth)
+			{
+				common--;
+			}
+
+			entry->action = edge->action;
+			entry->target = leaf;
+			entry->exitCount = path->depth - common;
+			entry->entryFrom = common;
+		}
+		else
+		{
+			succeed = false;
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+/******************************************************************************/
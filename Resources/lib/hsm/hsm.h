@@ -0,0 +1,148 @@
+/***************************************************************************//**
+  @file     hsm.h
+  @brief    Hierarchical State Machine Library
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef HSM_HSM_H_
+#define HSM_HSM_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "../fsm/fsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Maximum amount of nested levels of states, including the top level
+#ifndef HSM_MAX_DEPTH
+#define HSM_MAX_DEPTH					8
+#endif
+
+// Target of an internal transition, only the action is run, without
+// exiting nor entering any state
+#define HSM_INTERNAL					NULL
+
+// Definition of the end of the edges of a state
+#define HSM_END_OF_EDGES				{END_OF_STATE, NULL, NULL}
+
+// Size of the table of a machine, in entries
+#define HSM_TABLE_SIZE(states, events)	((states) * (events))
+
+// Verify whether the machine is in the state or in one of its children,
+// using the index of the state in the array of states
+#define HSM_IS_IN_STATE(hsm, index)		((hsm)->paths[(hsm)->current].depth > (hsm)->paths[(index)].depth - 1 && \
+										 (hsm)->paths[(hsm)->current].states[(hsm)->paths[(index)].depth - 1] == (index))
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Hierarchical states
+// Each state has a parent (or NULL at the top level), entry and exit actions,
+// which can be NULL, and its edges. Events not handled by a state are handled
+// by its parent, and so on. When the target of an edge has children, the machine
+// goes down through the initial children until a state without them.
+//
+// static const hsm_edge_t onEdges[] = {
+// 	 {	EVENT_OFF,		&off,			turnOff		},
+// 	 {	EVENT_BLINK,	HSM_INTERNAL,	toggle		},
+// 	 HSM_END_OF_EDGES
+// };
+// static const hsm_state_t on = { .parent = &top, .entry = ledOn, .edges = onEdges };
+//
+// The transitions are resolved by hsmBuild(), into a table with one entry for
+// each state and event ID, with the action, the target and how many states are
+// exited and entered, so the dispatch has no search at runtime.
+typedef struct hsm_state hsm_state_t;
+
+typedef struct {
+	event_id_t			event;		// Event ID of the edge
+	const hsm_state_t*	target;		// Next state, or HSM_INTERNAL
+	action_t			action;		// Action of the transition, or NULL
+} hsm_edge_t;
+
+struct hsm_state {
+	const hsm_state_t*	parent;		// Parent state, or NULL
+	const hsm_state_t*	initial;	// Initial child state, or NULL
+	action_t			entry;		// Action when entering the state, or NULL
+	action_t			exit;		// Action when exiting the state, or NULL
+	const hsm_edge_t*	edges;		// Edges, terminated by HSM_END_OF_EDGES
+};
+
+// Resolved transition of a state and event ID
+typedef struct {
+	action_t	action;			// Action of the edge, or NULL
+	uint16_t	target;			// Index of the next state, HSM_UNHANDLED or HSM_INTERNAL_TARGET
+	uint8_t		exitCount;		// Amount of states exited, from the current one
+	uint8_t		entryFrom;		// Level from which the states are entered, down to the target
+} hsm_entry_t;
+
+// Path of ancestors of a state, from the top level to the state itself
+typedef struct {
+	uint16_t	states[HSM_MAX_DEPTH];	// Indexes of the states in the path
+	uint8_t		depth;					// Amount of states in the path
+} hsm_path_t;
+
+// Instance of the machine, the table and the paths are reserved by the user
+typedef struct {
+	const hsm_state_t* const*	states;			// Array of the states of the machine
+	hsm_entry_t*				table;			// Entries, indexed by state * eventsCount + event ID
+	hsm_path_t*					paths;			// Path of ancestors of each state
+	uint16_t					statesCount;	// Amount of states
+	uint16_t					eventsCount;	// Amount of event IDs
+	uint16_t					current;		// Index of the current state
+} hsm_t;
+
+enum {
+	HSM_UNHANDLED = 0xFFFF,			// No state in the path handles the event
+	HSM_INTERNAL_TARGET = 0xFFFE	// Internal transition
+};
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Resolves the paths of the states and the transitions of each state and
+ * 		  event ID. Returns false if a state is nested deeper than HSM_MAX_DEPTH,
+ * 		  or a parent, initial or target state is not in the array of states.
+ * @param hsm			Pointer to the machine instance
+ * @param states		Array of the states of the machine
+ * @param statesCount	Amount of states
+ * @param eventsCount	Amount of event IDs, from 0 to eventsCount - 1
+ * @param table			Table of HSM_TABLE_SIZE(statesCount, eventsCount) entries
+ * @param paths			Array of statesCount paths
+ */
+bool hsmBuild(hsm_t* hsm, const hsm_state_t* const* states, uint16_t statesCount, uint16_t eventsCount, hsm_entry_t* table, hsm_path_t* paths);
+
+/**
+ * @brief Enters the initial state, running the entry actions from the top level
+ * @param hsm			Pointer to the machine instance
+ * @param initial		Index of the initial state
+ */
+void hsmStart(hsm_t* hsm, uint16_t initial);
+
+/**
+ * @brief Dispatches the event to the current state, events with IDs out of
+ * 		  the table are ignored.
+ * @param hsm			Pointer to the machine instance
+ * @param event			Current event received
+ */
+void hsmDispatch(hsm_t* hsm, void* event);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif /* HSM_HSM_H_ */
@@ -0,0 +1,188 @@
+/*******************************************************************************
+  @file     isr_profiler.c
+  @brief    Cycle count profiler of the interrupt service routines
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "../general/general.h"
+#include "isr_profiler.h"
+
+#ifdef ISR_PROFILER_ENABLED
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define DUMP_LINE_MAX_SIZE		80
+#define DUMP_HEADER				"name,count,min,mean,max\r\n"
+
+// Debug registers to enable the DWT cycle counter
+#define DEMCR					(*(volatile uint32_t*)0xE000EDFCUL)
+#define DEMCR_TRCENA_MASK		(1UL << 24)
+#define DWT_CTRL				(*(volatile uint32_t*)0xE0001000UL)
+#define DWT_CTRL_CYCCNTENA_MASK	(1UL << 0)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Entry of the registry of profiles
+typedef struct {
+	const char*		name;		// Name used in the report
+	isr_profile_t*	profile;	// Profile of the routine
+} isr_profiler_entry_t;
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static isr_profiler_entry_t	registry[ISR_PROFILER_MAX_REGISTERED];
+static size_t				registered = 0;
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+void isrProfilerInit(void)
+{
+#ifdef __arm__
+	DEMCR |= DEMCR_TRCENA_MASK;
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA_MASK;
+#endif
+}
+
+bool isrProfilerRegister(const char* name, isr_profile_t* profile)
+{
+	bool succeed = false;
+
+	// Registering again the same profile only updates its entry
+	size_t index;
+	for (index = 0 ; index < registered && registry[index].profile != profile ; index++);
+
+	if (index < ISR_PROFILER_MAX_REGISTERED)
+	{
+		registry[index].name = name;
+		registry[index].profile = profile;
+		if (index == registered)
+		{
+			registered++;
+		}
+		succeed = true;
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+size_t isrProfilerCount(void)
+{
+	return registered;
+}
+
+bool isrProfilerSnapshot(size_t index, isr_profile_snapshot_t* snapshot, bool reset)
+{
+	bool succeed = false;
+
+	if (index < registered)
+	{
+		volatile isr_profile_t* profile = registry[index].profile;
+		uint32_t sequence;
+		uint64_t total;
+
+		// The routine can interrupt the copy, then it is copied again
+		do
+		{
+			sequence = profile->sequence;
+			snapshot->count = profile->count;
+			snapshot->min = profile->min;
+			snapshot->max = profile->max;
+			total = profile->total;
+			if (profile->resetRequested)
+			{
+				snapshot->count = 0;
+			}
+		} while (sequence != profile->sequence);
+
+		if (reset)
+		{
+			profile->resetRequested = true;
+		}
+
+		if (snapshot->count == 0)
+		{
+			snapshot->min = 0;
+			snapshot->max = 0;
+			total = 0;
+		}
+		snapshot->name = registry[index].name;
+		snapshot->mean = snapshot->count ? (uint32_t)(total / snapshot->count) : 0;
+		succeed = true;
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+void isrProfilerReset(void)
+{
+	for (size_t index = 0 ; index < registered ; index++)
+	{
+		registry[index].profile->resetRequested = true;
+	}
+}
+
+void isrProfilerDump(text_writer_t writer, bool reset)
+{
+	char line[DUMP_LINE_MAX_SIZE];
+	isr_profile_snapshot_t snapshot;
+
+	writer(DUMP_HEADER, sizeof(DUMP_HEADER) - 1);
+	for (size_t index = 0 ; isrProfilerSnapshot(index, &snapshot, reset) ; index++)
+	{
+		size_t length = strlen(snapshot.name);
+		if (length > DUMP_LINE_MAX_SIZE - 4 * 11 - 2)
+		{
+			length = DUMP_LINE_MAX_SIZE - 4 * 11 - 2;
+		}
+
+		memcpy(line, snapshot.name, length);
+		line[length++] = ',';
+		length += appendNumber(line + length, snapshot.count, ',');
+		length += appendNumber(line + length, snapshot.min, ',');
+		length += appendNumber(line + length, snapshot.mean, ',');
+		length += appendNumber(line + length, snapshot.max, '\r');
+		line[length++] = '\n';
+		writer(line, length);
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+#endif
+
+/******************************************************************************/
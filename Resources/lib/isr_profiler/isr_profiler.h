@@ -0,0 +1,168 @@
+/*******************************************************************************
+  @file     isr_profiler.h
+  @brief    Cycle count profiler of the interrupt service routines
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef ISR_PROFILER_H_
+#define ISR_PROFILER_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../general/general.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// ISR profiler feature!
+// You can create a define with ISR_PROFILER_ENABLED to measure the cycles of
+// the interrupt service routines of the drivers and the SysTick subscribers,
+// with the DWT cycle counter, and the registry to dump them. Otherwise, the
+// profiles, the registry and their macros are compiled out.
+//
+// #define ISR_PROFILER_ENABLED
+
+#define ISR_PROFILER_MAX_REGISTERED		32
+
+// Cycle counter read by the profiler, the DWT CYCCNT on the target, it can
+// be defined before including this file, for example to test on the host
+#ifndef ISR_PROFILER_CYCLES
+#ifdef __arm__
+#define ISR_PROFILER_CYCLES()			(*(volatile uint32_t*)0xE0001004UL)
+#else
+#define ISR_PROFILER_CYCLES()			0UL
+#endif
+#endif
+
+#ifdef ISR_PROFILER_ENABLED
+
+// Measures the cycles of the code between both macros, for example:
+//
+// 		ISR_PROFILE_BEGIN();
+// 		UART_IRQDispatcher(UART_INSTANCE_0);
+// 		ISR_PROFILE_END(&uartProfiles[UART_INSTANCE_0]);
+#define ISR_PROFILE_BEGIN()						uint32_t isrProfileStart = ISR_PROFILER_CYCLES()
+#define ISR_PROFILE_END(profile)				isrProfilerRecord((profile), ISR_PROFILER_CYCLES() - isrProfileStart)
+
+// Registers a profile with a name to be dumped
+#define ISR_PROFILE_REGISTER(name, profile)		isrProfilerRegister((name), (profile))
+
+#else
+
+#define ISR_PROFILE_BEGIN()						((void)0)
+#define ISR_PROFILE_END(profile)				((void)0)
+#define ISR_PROFILE_REGISTER(name, profile)		((void)0)
+
+#endif
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Profile of a routine, only written by the routine itself
+typedef struct {
+	uint32_t		sequence;			// Incremented on every record, to detect changes while reading
+	uint32_t		count;				// Amount of calls
+	uint32_t		min;				// Minimum cycles of a call
+	uint32_t		max;				// Maximum cycles of a call
+	uint64_t		total;				// Cycles of every call
+	volatile bool	resetRequested;		// Cleared by the routine on the next call
+} isr_profile_t;
+
+// Figures of a registered profile
+typedef struct {
+	const char*		name;		// Name of the routine
+	uint32_t		count;		// Amount of calls
+	uint32_t		min;		// Minimum cycles of a call
+	uint32_t		mean;		// Mean cycles of a call
+	uint32_t		max;		// Maximum cycles of a call
+} isr_profile_snapshot_t;
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+#ifdef ISR_PROFILER_ENABLED
+
+/**
+ * @brief Adds a call to the profile, from the routine profiled
+ * @param profile	Pointer to the profile
+ * @param cycles	Cycles of the call
+ */
+static inline void isrProfilerRecord(isr_profile_t* profile, uint32_t cycles)
+{
+	if (profile->resetRequested)
+	{
+		profile->count = 0;
+		profile->total = 0;
+		profile->resetRequested = false;
+	}
+	if (profile->count == 0 || cycles < profile->min)
+	{
+		profile->min = cycles;
+	}
+	if (profile->count == 0 || cycles > profile->max)
+	{
+		profile->max = cycles;
+	}
+	profile->total += cycles;
+	profile->count++;
+	profile->sequence++;
+}
+
+/**
+ * @brief Starts the DWT cycle counter
+ */
+void isrProfilerInit(void);
+
+/**
+ * @brief Registers a profile, returns false if the registry is full
+ * @param name		Name used in the report
+ * @param profile	Pointer to the profile
+ */
+bool isrProfilerRegister(const char* name, isr_profile_t* profile);
+
+/**
+ * @brief Returns the amount of registered profiles
+ */
+size_t isrProfilerCount(void);
+
+/**
+ * @brief Copies the figures of a registered profile, and optionally resets it
+ * 		  at the same time, returns false if not registered
+ * @param index		Index of the profile in the registry
+ * @param snapshot	Where the figures are copied
+ * @param reset		Whether the profile is reset after copying
+ */
+bool isrProfilerSnapshot(size_t index, isr_profile_snapshot_t* snapshot, bool reset);
+
+/**
+ * @brief Resets every registered profile
+ */
+void isrProfilerReset(void);
+
+/**
+ * @brief Writes a table with a line for every registered profile, as comma
+ * 		  separated values: name,count,min,mean,max
+ * @param writer	Callback used to write each line
+ * @param reset		Whether the profiles are reset after copying
+ */
+void isrProfilerDump(text_writer_t writer, bool reset);
+
+#endif
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif
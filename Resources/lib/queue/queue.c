@@ -126,8 +126,45 @@ bool push(queue_t* queue, void* element)
 			// https://stackoverflow.com/questions/54498406/gcc-efficient-byte-copy-arm-cortex-m4
 			queue->rear = (queue->rear + 1) % queue->queueSize;
 			memcpy(queue->buffer + queue->rear * queue->elementSize, element, queue->elementSize);
+			QUEUE_STATS_ON_PUSH(queue, 1, size(queue));
 			succeed = true;
 		}
+		else
+		{
+			QUEUE_STATS_ON_REJECT(queue, 1);
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+bool pushMany(queue_t* queue, const void* elements, size_t length)
+{
+	bool succeed = false;
+
+#ifdef QUEUE_DEVELOPMENT_MODE
+	if (queue && elements)
+#endif
+	{
+		if (length <= emptySize(queue))
+		{
+			size_t start = (queue->rear + 1) % queue->queueSize;
+			size_t len1 = ((start + length) <= queue->queueSize) ? length : queue->queueSize - start;
+			size_t len2 = length - len1;
+			memcpy(queue->buffer + start * queue->elementSize, elements, len1 * queue->elementSize);
+			if (len2 > 0)
+			{
+				memcpy(queue->buffer, (const uint8_t*)elements + len1 * queue->elementSize, len2 * queue->elementSize);
+			}
+			queue->rear = (queue->rear + length) % queue->queueSize;
+			QUEUE_STATS_ON_PUSH(queue, length, size(queue));
+			succeed = true;
+		}
+		else
+		{
+			QUEUE_STATS_ON_REJECT(queue, length);
+		}
 	}
 
 	// Return the succeed status
@@ -144,6 +181,7 @@ bool pushTrash(queue_t* queue, size_t len)
 		if ((queue->rear + len + 1) % queue->queueSize != queue->front)
 		{
 			queue->rear = (queue->rear + len) % queue->queueSize;
+			QUEUE_STATS_ON_PUSH(queue, len, size(queue));
 			succeed = true;
 		}
 	}
@@ -164,6 +202,7 @@ void* pop(queue_t* queue)
 		{
 			element = queue->buffer + queue->front * queue->elementSize;
 			queue->front = (queue->front + 1) % queue->queueSize;
+			QUEUE_STATS_ON_POP(queue, 1);
 		}
 	}
 
@@ -185,6 +224,91 @@ void popMany(queue_t* queue, void* destination, size_t length)
 			memcpy( (uint8_t *) destination + len1 * queue->elementSize, queue->buffer, len2 * queue->elementSize);
 		}
 		queue->front = (queue->front + length) % queue->queueSize;
+		QUEUE_STATS_ON_POP(queue, length);
+	}
+}
+
+bool peekMany(queue_t* queue, void* destination, size_t length)
+{
+	bool succeed = false;
+
+#ifdef QUEUE_DEVELOPMENT_MODE
+	if (queue && destination)
+#endif
+	{
+		if (length <= size(queue))
+		{
+			size_t len1 = ((queue->front + length) < queue->queueSize) ? length : queue->queueSize - queue->front;
+			size_t len2 = length - len1;
+			memcpy(destination, queue->buffer + queue->elementSize * queue->front, len1 * queue->elementSize);
+			if (len2 > 0)
+			{
+				memcpy((uint8_t *) destination + len1 * queue->elementSize, queue->buffer, len2 * queue->elementSize);
+			}
+			succeed = true;
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+size_t queueReserve(queue_t* queue, void** ptr, size_t maxLen)
+{
+	size_t length = 0;
+
+#ifdef QUEUE_DEVELOPMENT_MODE
+	if (queue && ptr)
+#endif
+	{
+		size_t start = (queue->rear + 1) % queue->queueSize;
+		size_t free = emptySize(queue);
+		length = (queue->queueSize - start) < free ? queue->queueSize - start : free;
+		length = maxLen < length ? maxLen : length;
+		*ptr = queue->buffer + start * queue->elementSize;
+	}
+
+	// Return the length of the span
+	return length;
+}
+
+void queueCommit(queue_t* queue, size_t length)
+{
+#ifdef QUEUE_DEVELOPMENT_MODE
+	if (queue)
+#endif
+	{
+		queue->rear = (queue->rear + length) % queue->queueSize;
+		QUEUE_STATS_ON_PUSH(queue, length, size(queue));
+	}
+}
+
+size_t queuePeekSpan(queue_t* queue, void** ptr, size_t maxLen)
+{
+	size_t length = 0;
+
+#ifdef QUEUE_DEVELOPMENT_MODE
+	if (queue && ptr)
+#endif
+	{
+		size_t used = size(queue);
+		length = (queue->queueSize - queue->front) < used ? queue->queueSize - queue->front : used;
+		length = maxLen < length ? maxLen : length;
+		*ptr = queue->buffer + queue->front * queue->elementSize;
+	}
+
+	// Return the length of the span
+	return length;
+}
+
+void queueRelease(queue_t* queue, size_t length)
+{
+#ifdef QUEUE_DEVELOPMENT_MODE
+	if (queue)
+#endif
+	{
+		queue->front = (queue->front + length) % queue->queueSize;
+		QUEUE_STATS_ON_POP(queue, length);
 	}
 }
 
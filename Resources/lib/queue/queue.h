@@ -12,8 +12,11 @@
  ******************************************************************************/
 
 #include <stdio.h>
+#include <stdint.h>
 #include <stdbool.h>
 
+#include "../queue_stats/queue_stats.h"
+
 /*******************************************************************************
  * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
  ******************************************************************************/
@@ -40,6 +43,7 @@ typedef struct queue {
 	uint8_t*	buffer;			// Pointer to the array reserved in memory
 	size_t 		queueSize;		// Amount of elements in the array (fixed)
 	size_t		elementSize;	// Size in bytes of the element
+	QUEUE_STATS_MEMBER			// Counters, only with QUEUE_STATS_ENABLED
 } queue_t;
 
 /*******************************************************************************
@@ -96,6 +100,16 @@ void clear(queue_t* queue);
  */
 bool push(queue_t* queue, void* element);
 
+/**
+ * @brief Push many elements to the queue, copying them in at most two contiguous
+ * 		  segments of the buffer. Returns true if succeed or false, pushing none,
+ * 		  if there was not enough space for all of them.
+ * @param queue		Pointer to the Queue instance
+ * @param elements	Pointer to the array of elements to be pushed
+ * @param length	Number of elements to be pushed
+ */
+bool pushMany(queue_t* queue, const void* elements, size_t length);
+
 /**
  * @brief Push trash elements to the Queue, it only resizes the Queue, using
  * 	      whatever trash the array buffer already contained.
@@ -120,6 +134,54 @@ void* pop(queue_t* queue);
  */
 void popMany(queue_t* queue, void* destination, size_t length);
 
+/**
+ * @brief Copies the given amount of elements from the queue to the destination
+ * buffer without popping them. Returns false, copying none, if the queue has
+ * less elements than the requested.
+ * @param queue			Pointer to the Queue instance
+ * @param destination	Pointer to the destination buffer
+ * @param length		Number of elements to be copied
+ */
+bool peekMany(queue_t* queue, void* destination, size_t length);
+
+/**
+ * @brief Reserves a contiguous span of free elements inside the queue buffer, so
+ * 		  the producer can write them in place. Returns the length of the span,
+ * 		  which may be shorter than requested when the buffer wraps around, and
+ * 		  nothing is pushed until queueCommit() is called.
+ * @param queue		Pointer to the Queue instance
+ * @param ptr		Pointer where the start of the span is returned
+ * @param maxLen	Maximum number of elements desired
+ */
+size_t queueReserve(queue_t* queue, void** ptr, size_t maxLen);
+
+/**
+ * @brief Pushes the given amount of elements previously written in the span
+ * 		  returned by queueReserve()
+ * @param queue		Pointer to the Queue instance
+ * @param length	Number of elements written, at most the reserved span
+ */
+void queueCommit(queue_t* queue, size_t length);
+
+/**
+ * @brief Returns the contiguous span of elements from the front of the queue,
+ * 		  so the consumer can read them in place. Returns the length of the span,
+ * 		  which may be shorter than the size of the queue when the buffer wraps
+ * 		  around, and nothing is popped until queueRelease() is called.
+ * @param queue		Pointer to the Queue instance
+ * @param ptr		Pointer where the start of the span is returned
+ * @param maxLen	Maximum number of elements desired
+ */
+size_t queuePeekSpan(queue_t* queue, void** ptr, size_t maxLen);
+
+/**
+ * @brief Pops the given amount of elements previously read from the span
+ * 		  returned by queuePeekSpan()
+ * @param queue		Pointer to the Queue instance
+ * @param length	Number of elements read, at most the peeked span
+ */
+void queueRelease(queue_t* queue, size_t length);
+
 /*******************************************************************************
  ******************************************************************************/
 
@@ -0,0 +1,148 @@
+/*******************************************************************************
+  @file     queue_stats.c
+  @brief    Queue occupancy and overflow instrumentation
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <string.h>
+
+#include "../general/general.h"
+#include "queue_stats.h"
+
+#ifdef QUEUE_STATS_ENABLED
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define DUMP_LINE_MAX_SIZE		96
+#define DUMP_HEADER				"name,capacity,hwm,pushes,pops,rejected,discarded\r\n"
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static queue_stats_entry_t	registry[QUEUE_STATS_MAX_REGISTERED];
+static size_t				registered = 0;
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+bool queueStatsRegister(const char* name, queue_stats_t* stats, size_t capacity)
+{
+	bool succeed = false;
+
+	// Registering again the same queue only updates its entry
+	size_t index;
+	for (index = 0 ; index < registered && registry[index].stats != stats ; index++);
+
+	if (index < QUEUE_STATS_MAX_REGISTERED)
+	{
+		registry[index].name = name;
+		registry[index].stats = stats;
+		registry[index].capacity = capacity;
+		if (index == registered)
+		{
+			registered++;
+		}
+		succeed = true;
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+size_t queueStatsCount(void)
+{
+	return registered;
+}
+
+const queue_stats_entry_t* queueStatsGet(size_t index)
+{
+	return index < registered ? &registry[index] : NULL;
+}
+
+void queueStatsReset(void)
+{
+	// The counters are written from the ISR and the main loop, so only
+	// the side that writes each counter clears it
+	for (size_t index = 0 ; index < registered ; index++)
+	{
+		registry[index].stats->producerReset = true;
+		registry[index].stats->consumerReset = true;
+	}
+}
+
+void queueStatsDump(text_writer_t writer)
+{
+	char line[DUMP_LINE_MAX_SIZE];
+
+	writer(DUMP_HEADER, sizeof(DUMP_HEADER) - 1);
+	for (size_t index = 0 ; index < registered ; index++)
+	{
+		// Copy the counters first, they can change while the line is built,
+		// and the ones waiting to be cleared are dumped as zero
+		queue_stats_t stats = *registry[index].stats;
+		if (stats.producerReset)
+		{
+			stats.highWaterMark = 0;
+			stats.pushes = 0;
+			stats.rejected = 0;
+			stats.discarded = 0;
+		}
+		if (stats.consumerReset)
+		{
+			stats.pops = 0;
+		}
+		size_t length = strlen(registry[index].name);
+		if (length > DUMP_LINE_MAX_SIZE - 6 * 11 - 2)
+		{
+			length = DUMP_LINE_MAX_SIZE - 6 * 11 - 2;
+		}
+
+		memcpy(line, registry[index].name, length);
+		line[length++] = ',';
+		length += appendNumber(line + length, registry[index].capacity, ',');
+		length += appendNumber(line + length, stats.highWaterMark, ',');
+		length += appendNumber(line + length, stats.pushes, ',');
+		length += appendNumber(line + length, stats.pops, ',');
+		length += appendNumber(line + length, stats.rejected, ',');
+		length += appendNumber(line + length, stats.discarded, '\r');
+		line[length++] = '\n';
+		writer(line, length);
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+#endif
+
+/******************************************************************************/
@@ -0,0 +1,182 @@
+/*******************************************************************************
+  @file     queue_stats.h
+  @brief    Queue occupancy and overflow instrumentation
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef QUEUE_STATS_H_
+#define QUEUE_STATS_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../general/general.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Queue statistics feature!
+// You can create a define with QUEUE_STATS_ENABLED to add counters to every
+// queue_t, spsc_queue_t and typed queue, and the registry to dump them.
+// Otherwise, the counters, the registry and their macros are compiled out
+// and the queues cost exactly the same as without instrumentation.
+//
+// #define QUEUE_STATS_ENABLED
+
+#define QUEUE_STATS_MAX_REGISTERED		24
+
+#ifdef QUEUE_STATS_ENABLED
+
+// Member added to the queue structures
+#define QUEUE_STATS_MEMBER							queue_stats_t stats;
+
+// Hooks used by the queues to update the counters, the producer updates
+// pushes, rejected, discarded and the high water mark, the consumer updates
+// pops, so no counter is written from both sides, not even to reset them.
+#define QUEUE_STATS_ON_PUSH(queue, count, size)		queueStatsOnPush(&(queue)->stats, (count), (size))
+#define QUEUE_STATS_ON_POP(queue, count)			queueStatsOnPop(&(queue)->stats, (count))
+#define QUEUE_STATS_ON_REJECT(queue, count)			(queueStatsProducerReset(&(queue)->stats)->rejected += (count))
+#define QUEUE_STATS_ON_DISCARD(queue, count)		(queueStatsProducerReset(&(queue)->stats)->discarded += (count))
+#define QUEUE_STATS_RESET(queue)					memset(&(queue)->stats, 0, sizeof(queue_stats_t))
+
+// Registers the statistics of a live queue with a name to be dumped,
+// for example: QUEUE_STATS_REGISTER("events", &eventQueue.levels[0], 30);
+#define QUEUE_STATS_REGISTER(name, queue, capacity)	queueStatsRegister((name), &(queue)->stats, (capacity))
+
+#else
+
+#define QUEUE_STATS_MEMBER
+#define QUEUE_STATS_ON_PUSH(queue, count, size)		((void)0)
+#define QUEUE_STATS_ON_POP(queue, count)			((void)0)
+#define QUEUE_STATS_ON_REJECT(queue, count)			((void)0)
+#define QUEUE_STATS_ON_DISCARD(queue, count)		((void)0)
+#define QUEUE_STATS_RESET(queue)					((void)0)
+#define QUEUE_STATS_REGISTER(name, queue, capacity)	((void)0)
+
+#endif
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Counters of a queue
+typedef struct {
+	uint32_t	highWaterMark;		// Maximum amount of elements the queue had
+	uint32_t	pushes;				// Total elements pushed
+	uint32_t	pops;				// Total elements popped
+	uint32_t	rejected;			// Elements that could not be pushed because it was full
+	uint32_t	discarded;			// Elements dropped by the driver before reaching the queue
+	volatile bool	producerReset;	// Cleared by the producer on its next update
+	volatile bool	consumerReset;	// Cleared by the consumer on its next update
+} queue_stats_t;
+
+// Entry of the registry of live queues
+typedef struct {
+	const char*		name;		// Name used in the dump
+	queue_stats_t*	stats;		// Counters of the queue
+	size_t			capacity;	// Maximum amount of elements of the queue
+} queue_stats_entry_t;
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+#ifdef QUEUE_STATS_ENABLED
+
+/**
+ * @brief Clears the counters of the producer if requested, from the producer
+ * @param stats		Pointer to the counters
+ * @return The same counters
+ */
+static inline queue_stats_t* queueStatsProducerReset(queue_stats_t* stats)
+{
+	if (stats->producerReset)
+	{
+		stats->highWaterMark = 0;
+		stats->pushes = 0;
+		stats->rejected = 0;
+		stats->discarded = 0;
+		stats->producerReset = false;
+	}
+	return stats;
+}
+
+/**
+ * @brief Updates the counters of a queue after pushing elements
+ * @param stats		Pointer to the counters
+ * @param count		Amount of elements pushed
+ * @param size		Amount of elements in the queue after pushing
+ */
+static inline void queueStatsOnPush(queue_stats_t* stats, uint32_t count, uint32_t size)
+{
+	queueStatsProducerReset(stats)->pushes += count;
+	if (size > stats->highWaterMark)
+	{
+		stats->highWaterMark = size;
+	}
+}
+
+/**
+ * @brief Updates the counters of a queue after popping elements
+ * @param stats		Pointer to the counters
+ * @param count		Amount of elements popped
+ */
+static inline void queueStatsOnPop(queue_stats_t* stats, uint32_t count)
+{
+	if (stats->consumerReset)
+	{
+		stats->pops = 0;
+		stats->consumerReset = false;
+	}
+	stats->pops += count;
+}
+
+/**
+ * @brief Registers the counters of a live queue, returns false if the registry is full
+ * @param name		Name used in the dump
+ * @param stats		Pointer to the counters
+ * @param capacity	Maximum amount of elements of the queue
+ */
+bool queueStatsRegister(const char* name, queue_stats_t* stats, size_t capacity);
+
+/**
+ * @brief Returns the amount of registered queues
+ */
+size_t queueStatsCount(void);
+
+/**
+ * @brief Returns the registered queue of the given index, or NULL if not registered
+ * @param index		Index of the queue in the registry
+ */
+const queue_stats_entry_t* queueStatsGet(size_t index);
+
+/**
+ * @brief Clears the counters of every registered queue, each side of the queue
+ * 		  clears its own counters on its next update, meanwhile they are dumped as zero
+ */
+void queueStatsReset(void);
+
+/**
+ * @brief Writes a line for every registered queue with its counters, as
+ * 		  comma separated values: name,capacity,hwm,pushes,pops,rejected,discarded
+ * @param writer	Callback used to write each line
+ */
+void queueStatsDump(text_writer_t writer);
+
+#endif
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif
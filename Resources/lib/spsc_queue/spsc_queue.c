@@ -0,0 +1,335 @@
+/*******************************************************************************
+  @file     spsc_queue.c
+  @brief    Lock-free single producer single consumer queue
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "spsc_queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES FOR PRIVATE FUNCTIONS WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Copies elements into the buffer from the given counter, wrapping around
+ * 		  the end of the buffer in a second contiguous segment if needed.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param counter	Free running counter of the first element
+ * @param source	Pointer to the elements
+ * @param count		Number of elements
+ */
+static void copyIn(spsc_queue_t* queue, uint32_t counter, const void* source, size_t count);
+
+/**
+ * @brief Copies elements out of the buffer from the given counter, wrapping around
+ * 		  the end of the buffer in a second contiguous segment if needed.
+ * @param queue			Pointer to the SPSC Queue instance
+ * @param counter		Free running counter of the first element
+ * @param destination	Pointer to the destination buffer
+ * @param count			Number of elements
+ */
+static void copyOut(spsc_queue_t* queue, uint32_t counter, void* destination, size_t count);
+
+/*******************************************************************************
+ * ROM CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ *******************************************************************************
+                        GLOBAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+spsc_queue_t createSpscQueue(void* buffer, size_t capacity, size_t elementSize)
+{
+	spsc_queue_t queue = {
+		.front = 0,
+		.rear = 0,
+		.buffer = buffer,
+		.mask = capacity - 1,
+		.elementSize = elementSize
+	};
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (!SPSC_QUEUE_IS_POWER_OF_TWO(capacity))
+	{
+		// An invalid capacity leaves the queue empty and without buffer,
+		// then every operation fails
+		queue.buffer = NULL;
+		queue.mask = 0;
+	}
+#endif
+
+	return queue;
+}
+
+bool spscIsEmpty(spsc_queue_t* queue)
+{
+	return spscSize(queue) == 0;
+}
+
+bool spscIsFull(spsc_queue_t* queue)
+{
+	return spscEmptySize(queue) == 0;
+}
+
+size_t spscSize(spsc_queue_t* queue)
+{
+	size_t currentSize = 0;
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue)
+#endif
+	{
+		// Unsigned arithmetic keeps the difference valid when the counters overflow
+		currentSize = SPSC_LOAD_ACQUIRE(queue->rear) - SPSC_LOAD_ACQUIRE(queue->front);
+	}
+	return currentSize;
+}
+
+size_t spscEmptySize(spsc_queue_t* queue)
+{
+	size_t currentSize = 0;
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer)
+#endif
+	{
+		currentSize = (queue->mask + 1) - spscSize(queue);
+	}
+	return currentSize;
+}
+
+void spscClear(spsc_queue_t* queue)
+{
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue)
+#endif
+	{
+		SPSC_STORE_RELEASE(queue->front, SPSC_LOAD_ACQUIRE(queue->rear));
+	}
+}
+
+bool spscPush(spsc_queue_t* queue, const void* element)
+{
+	bool succeed = false;
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer && element)
+#endif
+	{
+		uint32_t rear = queue->rear;
+		if (rear - SPSC_LOAD_ACQUIRE(queue->front) <= queue->mask)
+		{
+			// First write the element, then publish it to the consumer
+			memcpy(queue->buffer + (rear & queue->mask) * queue->elementSize, element, queue->elementSize);
+			SPSC_STORE_RELEASE(queue->rear, rear + 1);
+			QUEUE_STATS_ON_PUSH(queue, 1, rear + 1 - SPSC_LOAD_ACQUIRE(queue->front));
+			succeed = true;
+		}
+		else
+		{
+			QUEUE_STATS_ON_REJECT(queue, 1);
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+bool spscPop(spsc_queue_t* queue, void* destination)
+{
+	bool succeed = false;
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer && destination)
+#endif
+	{
+		uint32_t front = queue->front;
+		if (SPSC_LOAD_ACQUIRE(queue->rear) != front)
+		{
+			// First read the element, then release the slot to the producer
+			memcpy(destination, queue->buffer + (front & queue->mask) * queue->elementSize, queue->elementSize);
+			SPSC_STORE_RELEASE(queue->front, front + 1);
+			QUEUE_STATS_ON_POP(queue, 1);
+			succeed = true;
+		}
+	}
+
+	// Return the succeed status
+	return succeed;
+}
+
+size_t spscPushMany(spsc_queue_t* queue, const void* elements, size_t length)
+{
+	size_t count = 0;
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer && elements)
+#endif
+	{
+		uint32_t rear = queue->rear;
+		size_t available = (queue->mask + 1) - (rear - SPSC_LOAD_ACQUIRE(queue->front));
+		count = length < available ? length : available;
+		if (count)
+		{
+			copyIn(queue, rear, elements, count);
+			SPSC_STORE_RELEASE(queue->rear, rear + count);
+			QUEUE_STATS_ON_PUSH(queue, count, rear + count - SPSC_LOAD_ACQUIRE(queue->front));
+		}
+		QUEUE_STATS_ON_REJECT(queue, length - count);
+	}
+
+	// Return the amount of elements pushed
+	return count;
+}
+
+size_t spscPopMany(spsc_queue_t* queue, void* destination, size_t length)
+{
+	size_t count = spscPeekMany(queue, destination, length);
+	if (count)
+	{
+		SPSC_STORE_RELEASE(queue->front, queue->front + count);
+		QUEUE_STATS_ON_POP(queue, count);
+	}
+
+	// Return the amount of elements copied
+	return count;
+}
+
+size_t spscPeekMany(spsc_queue_t* queue, void* destination, size_t length)
+{
+	size_t count = 0;
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer && destination)
+#endif
+	{
+		uint32_t front = queue->front;
+		size_t available = SPSC_LOAD_ACQUIRE(queue->rear) - front;
+		count = length < available ? length : available;
+		if (count)
+		{
+			copyOut(queue, front, destination, count);
+		}
+	}
+
+	// Return the amount of elements copied
+	return count;
+}
+
+size_t spscReserve(spsc_queue_t* queue, void** ptr, size_t maxLen)
+{
+	size_t length = 0;
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer && ptr)
+#endif
+	{
+		uint32_t rear = queue->rear;
+		size_t index = rear & queue->mask;
+		size_t free = (queue->mask + 1) - (rear - SPSC_LOAD_ACQUIRE(queue->front));
+		length = (queue->mask + 1 - index) < free ? queue->mask + 1 - index : free;
+		length = maxLen < length ? maxLen : length;
+		*ptr = queue->buffer + index * queue->elementSize;
+	}
+
+	// Return the length of the span
+	return length;
+}
+
+void spscCommit(spsc_queue_t* queue, size_t length)
+{
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer)
+#endif
+	{
+		SPSC_STORE_RELEASE(queue->rear, queue->rear + length);
+		QUEUE_STATS_ON_PUSH(queue, length, queue->rear - SPSC_LOAD_ACQUIRE(queue->front));
+	}
+}
+
+size_t spscPeekSpan(spsc_queue_t* queue, void** ptr, size_t maxLen)
+{
+	size_t length = 0;
+
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer && ptr)
+#endif
+	{
+		uint32_t front = queue->front;
+		size_t index = front & queue->mask;
+		size_t used = SPSC_LOAD_ACQUIRE(queue->rear) - front;
+		length = (queue->mask + 1 - index) < used ? queue->mask + 1 - index : used;
+		length = maxLen < length ? maxLen : length;
+		*ptr = queue->buffer + index * queue->elementSize;
+	}
+
+	// Return the length of the span
+	return length;
+}
+
+void spscRelease(spsc_queue_t* queue, size_t length)
+{
+#ifdef SPSC_QUEUE_DEVELOPMENT_MODE
+	if (queue && queue->buffer)
+#endif
+	{
+		SPSC_STORE_RELEASE(queue->front, queue->front + length);
+		QUEUE_STATS_ON_POP(queue, length);
+	}
+}
+
+/*******************************************************************************
+ *******************************************************************************
+                        LOCAL FUNCTION DEFINITIONS
+ *******************************************************************************
+ ******************************************************************************/
+
+static void copyIn(spsc_queue_t* queue, uint32_t counter, const void* source, size_t count)
+{
+	size_t index = counter & queue->mask;
+	size_t len1 = (index + count) <= (queue->mask + 1) ? count : (queue->mask + 1) - index;
+	size_t len2 = count - len1;
+	memcpy(queue->buffer + index * queue->elementSize, source, len1 * queue->elementSize);
+	if (len2 > 0)
+	{
+		memcpy(queue->buffer, (const uint8_t*)source + len1 * queue->elementSize, len2 * queue->elementSize);
+	}
+}
+
+static void copyOut(spsc_queue_t* queue, uint32_t counter, void* destination, size_t count)
+{
+	size_t index = counter & queue->mask;
+	size_t len1 = (index + count) <= (queue->mask + 1) ? count : (queue->mask + 1) - index;
+	size_t len2 = count - len1;
+	memcpy(destination, queue->buffer + index * queue->elementSize, len1 * queue->elementSize);
+	if (len2 > 0)
+	{
+		memcpy((uint8_t*)destination + len1 * queue->elementSize, queue->buffer, len2 * queue->elementSize);
+	}
+}
+
+/******************************************************************************/
@@ -0,0 +1,194 @@
+/*******************************************************************************
+  @file     spsc_queue.h
+  @brief    Lock-free single producer single consumer queue
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef SPSC_QUEUE_H_
+#define SPSC_QUEUE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../queue_stats/queue_stats.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// SPSC Queue micro-framework feature!
+// Same as the QUEUE_DEVELOPMENT_MODE, you can create a define with
+// SPSC_QUEUE_DEVELOPMENT_MODE to enable validation of the arguments.
+//
+// #define SPSC_QUEUE_DEVELOPMENT_MODE
+
+// Use it to verify the capacity of the buffers at compile time,
+// for example: #if !SPSC_QUEUE_IS_POWER_OF_TWO(RX_BUFFER_SIZE) #error ...
+#define SPSC_QUEUE_IS_POWER_OF_TWO(n)	(((n) > 0) && (((n) & ((n) - 1)) == 0))
+
+// Memory ordering used between the producer and the consumer, the
+// acquire load pairs with the release store of the other side.
+#define SPSC_LOAD_ACQUIRE(index)			__atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_RELEASE(index, value)	__atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// The SPSC Queue is a ring buffer shared by ONE producer and ONE consumer,
+// for example an ISR and the main loop, without masking interrupts.
+// Indexes are free running counters, only the producer writes the rear and
+// only the consumer writes the front, the position in the buffer is obtained
+// with the mask, so the capacity MUST be a power of two. Unlike the queue_t,
+// every element of the buffer can be used.
+typedef struct spsc_queue {
+	uint32_t	front;			// Counter of elements that left the queue (consumer)
+	uint32_t	rear;			// Counter of elements that entered the queue (producer)
+	uint8_t*	buffer;			// Pointer to the array reserved in memory
+	uint32_t	mask;			// Capacity of the array minus one
+	size_t		elementSize;	// Size in bytes of the element
+	QUEUE_STATS_MEMBER			// Counters, only with QUEUE_STATS_ENABLED
+} spsc_queue_t;
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/**
+ * @brief Creates a SPSC Queue instance from the buffer and size specified by user
+ * @param buffer		Pointer to the array reserved in memory
+ * @param capacity		Amount of elements in the array, must be a power of two
+ * @param elementSize	Size in bytes of the element
+ */
+spsc_queue_t createSpscQueue(void* buffer, size_t capacity, size_t elementSize);
+
+/**
+ * @brief Returns whether the queue is empty or not
+ * @param queue		Pointer to the SPSC Queue instance
+ */
+bool spscIsEmpty(spsc_queue_t* queue);
+
+/**
+ * @brief Returns whether the queue is full or not
+ * @param queue		Pointer to the SPSC Queue instance
+ */
+bool spscIsFull(spsc_queue_t* queue);
+
+/**
+ * @brief Returns the current size of the queue
+ * @param queue		Pointer to the SPSC Queue instance
+ */
+size_t spscSize(spsc_queue_t* queue);
+
+/**
+ * @brief Returns the empty space for new elements in the queue
+ * @param queue		Pointer to the SPSC Queue instance
+ */
+size_t spscEmptySize(spsc_queue_t* queue);
+
+/**
+ * @brief Discards every element in the queue. Only the consumer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ */
+void spscClear(spsc_queue_t* queue);
+
+/**
+ * @brief Push a new element to the queue, and returns true if succeed
+ * 		  or false if the queue was full. Only the producer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param element	Pointer to the new element to be pushed
+ */
+bool spscPush(spsc_queue_t* queue, const void* element);
+
+/**
+ * @brief Pushes up to the given amount of elements to the queue, copying them in
+ * 		  at most two contiguous segments of the buffer. Returns the amount of
+ * 		  elements pushed. Only the producer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param elements	Pointer to the array of elements to be pushed
+ * @param length	Maximum number of elements to be pushed
+ */
+size_t spscPushMany(spsc_queue_t* queue, const void* elements, size_t length);
+
+/**
+ * @brief Copies the next element of the queue to the destination and pops it,
+ * 		  returns false if the queue was empty. Only the consumer can call it.
+ * 		  The element is copied because once popped, the producer may overwrite it.
+ * @param queue			Pointer to the SPSC Queue instance
+ * @param destination	Pointer to the destination element
+ */
+bool spscPop(spsc_queue_t* queue, void* destination);
+
+/**
+ * @brief Copies up to the given amount of elements from the queue to the
+ * 		  destination buffer and pops them. Returns the amount of elements copied.
+ * 		  Only the consumer can call it.
+ * @param queue			Pointer to the SPSC Queue instance
+ * @param destination	Pointer to the destination buffer
+ * @param length		Maximum number of elements to be copied
+ */
+size_t spscPopMany(spsc_queue_t* queue, void* destination, size_t length);
+
+/**
+ * @brief Copies up to the given amount of elements from the queue to the
+ * 		  destination buffer without popping them. Returns the amount of
+ * 		  elements copied. Only the consumer can call it.
+ * @param queue			Pointer to the SPSC Queue instance
+ * @param destination	Pointer to the destination buffer
+ * @param length		Maximum number of elements to be copied
+ */
+size_t spscPeekMany(spsc_queue_t* queue, void* destination, size_t length);
+
+/**
+ * @brief Reserves a contiguous span of free elements inside the queue buffer, so
+ * 		  the producer (an ISR or a DMA) can write them in place. Returns the length
+ * 		  of the span, which may be shorter than requested when the buffer wraps
+ * 		  around. Nothing is published until spscCommit() is called.
+ * 		  Only the producer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param ptr		Pointer where the start of the span is returned
+ * @param maxLen	Maximum number of elements desired
+ */
+size_t spscReserve(spsc_queue_t* queue, void** ptr, size_t maxLen);
+
+/**
+ * @brief Publishes to the consumer the given amount of elements previously
+ * 		  written in the span returned by spscReserve(). Only the producer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param length	Number of elements written, at most the reserved span
+ */
+void spscCommit(spsc_queue_t* queue, size_t length);
+
+/**
+ * @brief Returns the contiguous span of elements from the front of the queue, so
+ * 		  the consumer can read them in place. Returns the length of the span,
+ * 		  which may be shorter than the size of the queue when the buffer wraps
+ * 		  around. The elements are not popped until spscRelease() is called.
+ * 		  Only the consumer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param ptr		Pointer where the start of the span is returned
+ * @param maxLen	Maximum number of elements desired
+ */
+size_t spscPeekSpan(spsc_queue_t* queue, void** ptr, size_t maxLen);
+
+/**
+ * @brief Gives back to the producer the given amount of elements previously read
+ * 		  from the span returned by spscPeekSpan(). Only the consumer can call it.
+ * @param queue		Pointer to the SPSC Queue instance
+ * @param length	Number of elements read, at most the peeked span
+ */
+void spscRelease(spsc_queue_t* queue, size_t length);
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif
@@ -0,0 +1,195 @@
+/*******************************************************************************
+  @file     typed_queue.h
+  @brief    Compile-time typed single producer single consumer queue generator
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef TYPED_QUEUE_H_
+#define TYPED_QUEUE_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "../spsc_queue/spsc_queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Typed Queue generator!
+// DECLARE_QUEUE(name, type, capacity) declares the structure name##_t, with
+// the buffer inside, and the static inline functions to handle it, for example
+// DECLARE_QUEUE(wordQueue, uint8_t, 64) declares wordQueue_t, wordQueuePush(),
+// wordQueuePop(), and so on. Instances are declared as usual, with static
+// storage they start empty,
+//
+// 		static wordQueue_t rxQueue;
+//
+// As the element type and the capacity are known by the compiler, elements
+// are moved with plain assignments and positions with constant masks, instead
+// of the runtime elementSize and memcpy used by queue_t and spsc_queue_t.
+// The queue has the same rules than the spsc_queue_t, ONE producer and ONE
+// consumer, and the capacity MUST be a power of two.
+// With QUEUE_STATS_ENABLED, the typed queues also have the counters of queue_stats.h
+#define DECLARE_QUEUE(name, type, capacity)														\
+																								\
+typedef struct {																				\
+	uint32_t	front;				/* Counter of elements that left the queue (consumer)	*/	\
+	uint32_t	rear;				/* Counter of elements that entered the queue (producer)	*/	\
+	type		buffer[capacity];	/* Elements of the queue									*/	\
+	QUEUE_STATS_MEMBER				/* Counters, only with QUEUE_STATS_ENABLED				*/	\
+} name##_t;																						\
+																								\
+/* Fails to compile when the capacity is not a power of two */									\
+typedef char name##CapacityCheck_t[SPSC_QUEUE_IS_POWER_OF_TWO(capacity) ? 1 : -1];				\
+																								\
+static inline void name##Init(name##_t* queue)													\
+{																								\
+	queue->front = 0;																			\
+	queue->rear = 0;																			\
+	QUEUE_STATS_RESET(queue);																	\
+}																								\
+																								\
+static inline size_t name##Size(name##_t* queue)												\
+{																								\
+	return SPSC_LOAD_ACQUIRE(queue->rear) - SPSC_LOAD_ACQUIRE(queue->front);					\
+}																								\
+																								\
+static inline size_t name##EmptySize(name##_t* queue)											\
+{																								\
+	return (capacity) - name##Size(queue);														\
+}																								\
+																								\
+static inline bool name##IsEmpty(name##_t* queue)												\
+{																								\
+	return name##Size(queue) == 0;																\
+}																								\
+																								\
+static inline bool name##IsFull(name##_t* queue)												\
+{																								\
+	return name##Size(queue) == (capacity);														\
+}																								\
+																								\
+/* Only the consumer can clear the queue */														\
+static inline void name##Clear(name##_t* queue)													\
+{																								\
+	SPSC_STORE_RELEASE(queue->front, SPSC_LOAD_ACQUIRE(queue->rear));							\
+}																								\
+																								\
+static inline bool name##Push(name##_t* queue, type element)									\
+{																								\
+	uint32_t rear = queue->rear;																\
+	if (rear - SPSC_LOAD_ACQUIRE(queue->front) < (capacity))									\
+	{																							\
+		queue->buffer[rear & ((capacity) - 1)] = element;										\
+		SPSC_STORE_RELEASE(queue->rear, rear + 1);												\
+		QUEUE_STATS_ON_PUSH(queue, 1, rear + 1 - SPSC_LOAD_ACQUIRE(queue->front));				\
+		return true;																			\
+	}																							\
+	QUEUE_STATS_ON_REJECT(queue, 1);															\
+	return false;																				\
+}																								\
+																								\
+static inline bool name##Pop(name##_t* queue, type* element)									\
+{																								\
+	uint32_t front = queue->front;																\
+	if (SPSC_LOAD_ACQUIRE(queue->rear) != front)												\
+	{																							\
+		*element = queue->buffer[front & ((capacity) - 1)];										\
+		SPSC_STORE_RELEASE(queue->front, front + 1);											\
+		QUEUE_STATS_ON_POP(queue, 1);															\
+		return true;																			\
+	}																							\
+	return false;																				\
+}																								\
+																								\
+static inline size_t name##PushMany(name##_t* queue, const type* elements, size_t length)		\
+{																								\
+	uint32_t rear = queue->rear;																\
+	size_t free = (capacity) - (rear - SPSC_LOAD_ACQUIRE(queue->front));						\
+	size_t count = length < free ? length : free;												\
+	for (size_t i = 0 ; i < count ; i++)														\
+	{																							\
+		queue->buffer[(rear + i) & ((capacity) - 1)] = elements[i];								\
+	}																							\
+	SPSC_STORE_RELEASE(queue->rear, rear + count);												\
+	QUEUE_STATS_ON_PUSH(queue, count, rear + count - SPSC_LOAD_ACQUIRE(queue->front));			\
+	QUEUE_STATS_ON_REJECT(queue, length - count);												\
+	return count;																				\
+}																								\
+																								\
+static inline size_t name##PeekMany(name##_t* queue, type* elements, size_t length)				\
+{																								\
+	uint32_t front = queue->front;																\
+	size_t used = SPSC_LOAD_ACQUIRE(queue->rear) - front;										\
+	size_t count = length < used ? length : used;												\
+	for (size_t i = 0 ; i < count ; i++)														\
+	{																							\
+		elements[i] = queue->buffer[(front + i) & ((capacity) - 1)];							\
+	}																							\
+	return count;																				\
+}																								\
+																								\
+static inline size_t name##PopMany(name##_t* queue, type* elements, size_t length)				\
+{																								\
+	size_t count = name##PeekMany(queue, elements, length);										\
+	SPSC_STORE_RELEASE(queue->front, queue->front + count);										\
+	QUEUE_STATS_ON_POP(queue, count);															\
+	return count;																				\
+}																								\
+																								\
+/* Contiguous span of free elements for the producer, see spscReserve() */						\
+static inline size_t name##Reserve(name##_t* queue, type** ptr, size_t maxLen)					\
+{																								\
+	uint32_t rear = queue->rear;																\
+	size_t index = rear & ((capacity) - 1);														\
+	size_t free = (capacity) - (rear - SPSC_LOAD_ACQUIRE(queue->front));						\
+	size_t length = ((capacity) - index) < free ? (capacity) - index : free;					\
+	*ptr = &queue->buffer[index];																\
+	return maxLen < length ? maxLen : length;													\
+}																								\
+																								\
+static inline void name##Commit(name##_t* queue, size_t length)									\
+{																								\
+	SPSC_STORE_RELEASE(queue->rear, queue->rear + length);										\
+	QUEUE_STATS_ON_PUSH(queue, length, queue->rear - SPSC_LOAD_ACQUIRE(queue->front));			\
+}																								\
+																								\
+/* Contiguous span of elements for the consumer, see spscPeekSpan() */							\
+static inline size_t name##PeekSpan(name##_t* queue, type** ptr, size_t maxLen)					\
+{																								\
+	uint32_t front = queue->front;																\
+	size_t index = front & ((capacity) - 1);													\
+	size_t used = SPSC_LOAD_ACQUIRE(queue->rear) - front;										\
+	size_t length = ((capacity) - index) < used ? (capacity) - index : used;					\
+	*ptr = &queue->buffer[index];																\
+	return maxLen < length ? maxLen : length;													\
+}																								\
+																								\
+static inline void name##Release(name##_t* queue, size_t length)								\
+{																								\
+	SPSC_STORE_RELEASE(queue->front, queue->front + length);									\
+	QUEUE_STATS_ON_POP(queue, length);															\
+}
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+/*******************************************************************************
+ * VARIABLE PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ * FUNCTION PROTOTYPES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif
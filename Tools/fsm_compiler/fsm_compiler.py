@@ -0,0 +1,345 @@
+#!/usr/bin/env python3
+"""
+  @file     fsm_compiler.py
+  @brief    Compiles a compact FSM description into the C tables of lib/fsm
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+
+Reads a description like the following one, validates it and writes a
+header and a source file with the edge_t arrays used by fsmCycle(), and
+the const table of the dense mode used by fsmDenseCycle().
+
+    # Comments start with a hash
+    fsm         led
+    include     "app/io.h"
+    events      extern IO_EVENT_NONE IO_EVENT_LEFT_KEY_PRESSED IO_EVENT_RIGHT_KEY_PRESSED
+    initial     STATE_RED
+
+    state STATE_RED
+        IO_EVENT_LEFT_KEY_PRESSED   -> STATE_GREEN  : turnGreen
+        default                     -> STATE_RED    : nothing
+
+    state STATE_GREEN
+        IO_EVENT_RIGHT_KEY_PRESSED  -> STATE_RED    : turnRed
+        default                     -> STATE_GREEN
+
+Events take their IDs in the order they are listed. With "events extern"
+the enumeration is not generated, and the IDs are verified at compile time
+against the definitions included. An edge without action uses DO_NOTHING,
+a state without default edge gets a DEFAULT_NO_ACTION_EDGE to itself, so
+every state is always terminated by END_OF_STATE.
+
+Errors (unknown states or events, repeated edges) stop the generation.
+Unreachable states and events without edges are reported as warnings.
+
+Usage:
+    python3 fsm_compiler.py led.fsm -o source/app [--dense auto|always|never]
+"""
+
+import argparse
+import os
+import re
+import sys
+from collections import OrderedDict
+
+# Amount of edges of a state from which scanning them costs more than
+# one look-up in the dense table, used by --dense auto
+DENSE_AUTO_MIN_EDGES = 4
+
+DEFAULT_EVENT = "default"
+
+
+class FsmError(Exception):
+    pass
+
+
+class Edge:
+    def __init__(self, event, next_state, action, line):
+        self.event = event
+        self.next_state = next_state
+        self.action = action
+        self.line = line
+
+
+class Fsm:
+    def __init__(self):
+        self.name = None
+        self.includes = []
+        self.events = []
+        self.extern_events = False
+        self.initial = None
+        self.states = OrderedDict()
+
+
+def parse(path):
+    fsm = Fsm()
+    current = None
+    edge_re = re.compile(r"^(\w+)\s*->\s*(\w+)\s*(?::\s*(\w+))?$")
+
+    with open(path, encoding="utf-8") as file:
+        for number, raw in enumerate(file, start=1):
+            line = raw.split("#", 1)[0].strip()
+            if not line:
+                continue
+            where = "{}:{}".format(path, number)
+            words = line.split()
+            keyword = words[0]
+
+            if keyword == "fsm" and len(words) == 2:
+                fsm.name = words[1]
+            elif keyword == "include" and len(words) == 2:
+                fsm.includes.append(words[1])
+            elif keyword == "events" and len(words) > 1:
+                names = words[1:]
+                if names[0] == "extern":
+                    fsm.extern_events = True
+                    names = names[1:]
+                fsm.events.extend(names)
+            elif keyword == "initial" and len(words) == 2:
+                fsm.initial = words[1]
+            elif keyword == "state" and len(words) == 2:
+                if words[1] in fsm.states:
+                    raise FsmError("{}: state {} defined twice".format(where, words[1]))
+                current = []
+                fsm.states[words[1]] = current
+            else:
+                match = edge_re.match(line)
+                if match is None:
+                    raise FsmError("{}: cannot parse '{}'".format(where, line))
+                if current is None:
+                    raise FsmError("{}: edge outside of a state".format(where))
+                current.append(Edge(match.group(1), match.group(2), match.group(3), where))
+
+    return fsm
+
+
+def validate(fsm):
+    warnings = []
+
+    if fsm.name is None:
+        raise FsmError("missing 'fsm <name>'")
+    if not fsm.states:
+        raise FsmError("no states defined")
+    if len(set(fsm.events)) != len(fsm.events):
+        raise FsmError("events listed twice")
+    if fsm.initial is None:
+        fsm.initial = next(iter(fsm.states))
+    if fsm.initial not in fsm.states:
+        raise FsmError("unknown initial state {}".format(fsm.initial))
+
+    for state, edges in fsm.states.items():
+        seen = set()
+        for edge in edges:
+            if edge.event != DEFAULT_EVENT and edge.event not in fsm.events:
+                raise FsmError("{}: unknown event {}".format(edge.line, edge.event))
+            if edge.next_state not in fsm.states:
+                raise FsmError("{}: unknown state {}".format(edge.line, edge.next_state))
+            if edge.event in seen:
+                raise FsmError("{}: state {} has two edges for {}".format(edge.line, state, edge.event))
+            seen.add(edge.event)
+
+        # The default edge must be the last one, as it terminates the state
+        defaults = [edge for edge in edges if edge.event == DEFAULT_EVENT]
+        if defaults:
+            edges.remove(defaults[0])
+            edges.append(defaults[0])
+        else:
+            edges.append(Edge(DEFAULT_EVENT, state, None, "generated"))
+            warnings.append("state {} has no default edge, staying in it without action".format(state))
+
+    # Unreachable states, from the initial one
+    reached = {fsm.initial}
+    pending = [fsm.initial]
+    while pending:
+        for edge in fsm.states[pending.pop()]:
+            if edge.next_state not in reached:
+                reached.add(edge.next_state)
+                pending.append(edge.next_state)
+    for state in fsm.states:
+        if state not in reached:
+            warnings.append("state {} is unreachable from {}".format(state, fsm.initial))
+
+    # Events without edges, always taking the default edge
+    handled = {edge.event for edges in fsm.states.values() for edge in edges}
+    for event in fsm.events:
+        if event not in handled:
+            warnings.append("event {} is not handled by any state".format(event))
+
+    return warnings
+
+
+def use_dense(fsm, mode):
+    if mode == "always":
+        return True
+    if mode == "never":
+        return False
+    return max(len(edges) for edges in fsm.states.values()) >= DENSE_AUTO_MIN_EDGES
+
+
+def banner(title):
+    return (
+        "/*******************************************************************************\n"
+        " * {}\n"
+        " ******************************************************************************/\n".format(title)
+    )
+
+
+def file_header(name, brief):
+    return (
+        "/***************************************************************************//**\n"
+        "  @file     {}\n"
+        "  @brief    {}\n"
+        "  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo\n"
+        " ******************************************************************************/\n"
+        "\n"
+        "// Generated by Tools/fsm_compiler/fsm_compiler.py, do not edit.\n".format(name, brief)
+    )
+
+
+def actions_of(fsm):
+    actions = []
+    for edges in fsm.states.values():
+        for edge in edges:
+            if edge.action and edge.action not in actions:
+                actions.append(edge.action)
+    return actions
+
+
+def emit_header(fsm, dense, fsm_include, header_name):
+    upper = fsm.name.upper()
+    guard = "{}_FSM_H_".format(upper)
+    out = [file_header(header_name, "Tables of the {} state machine".format(fsm.name)), ""]
+    out.append("#ifndef {}\n#define {}\n".format(guard, guard))
+    out.append(banner("INCLUDE HEADER FILES"))
+    out.append('#include "{}"'.format(fsm_include))
+    for include in fsm.includes:
+        out.append("#include {}".format(include))
+    out.append("")
+    out.append(banner("CONSTANT AND MACRO DEFINITIONS USING #DEFINE"))
+    out.append("#define {}_STATES_COUNT\t{}".format(upper, len(fsm.states)))
+    out.append("#define {}_EVENTS_COUNT\t{}".format(upper, len(fsm.events)))
+    out.append("#define {}_INITIAL_STATE\t{}".format(upper, fsm.initial))
+    out.append("")
+    out.append(banner("ENUMERATIONS AND STRUCTURES AND TYPEDEFS"))
+    if not fsm.extern_events:
+        out.append("typedef enum {")
+        for event in fsm.events:
+            out.append("\t{},".format(event))
+        out.append("}} {}_event_id_t;\n".format(fsm.name))
+    out.append("// Index of each state in {}States[]".format(fsm.name))
+    out.append("typedef enum {")
+    for state in fsm.states:
+        out.append("\t{}_INDEX,".format(state))
+    out.append("}} {}_state_index_t;\n".format(fsm.name))
+    out.append(banner("VARIABLE PROTOTYPES WITH GLOBAL SCOPE"))
+    for state in fsm.states:
+        out.append("extern edge_t {}[];".format(state))
+    out.append("extern const state_t {}States[{}_STATES_COUNT];".format(fsm.name, upper))
+    if dense:
+        out.append("extern const fsm_dense_entry_t {}Table[DENSE_FSM_TABLE_SIZE({}_STATES_COUNT, {}_EVENTS_COUNT)];".format(fsm.name, upper, upper))
+    out.append("")
+    out.append(banner("FUNCTION PROTOTYPES WITH GLOBAL SCOPE"))
+    out.append("// Actions of the edges, defined by the application")
+    for action in actions_of(fsm):
+        out.append("void {}(void* event);".format(action))
+    out.append("")
+    out.append("/*******************************************************************************\n"
+               " ******************************************************************************/\n")
+    out.append("#endif /* {} */".format(guard))
+    return "\n".join(out) + "\n"
+
+
+def emit_source(fsm, dense, header_name, source_name):
+    upper = fsm.name.upper()
+    state_index = {state: index for index, state in enumerate(fsm.states)}
+    out = [file_header(source_name, "Tables of the {} state machine".format(fsm.name)), ""]
+    out.append(banner("INCLUDE HEADER FILES"))
+    out.append('#include "{}"\n'.format(header_name))
+    out.append(banner("CONSTANT AND MACRO DEFINITIONS USING #DEFINE"))
+    if fsm.extern_events:
+        out.append("// The IDs of the events must match the order of the description")
+        for index, event in enumerate(fsm.events):
+            out.append('_Static_assert({} == {}, "{} must be {}");'.format(event, index, event, index))
+        out.append("")
+    out.append(banner("VARIABLES WITH GLOBAL SCOPE"))
+    for state, edges in fsm.states.items():
+        out.append("edge_t {}[] = {{".format(state))
+        out.append("\t//\tEVENT\t\t\t\t\t\tNEXT STATE\t\tACTION")
+        for edge in edges:
+            action = edge.action or "DO_NOTHING"
+            if edge.event == DEFAULT_EVENT:
+                if edge.action:
+                    out.append("\tDEFAULT_EDGE({}, {})".format(edge.next_state, action))
+                else:
+                    out.append("\tDEFAULT_NO_ACTION_EDGE({})".format(edge.next_state))
+            else:
+                out.append("\t{{\t{},\t{},\t{} }},".format(edge.event, edge.next_state, action))
+        out.append("};\n")
+
+    out.append("const state_t {}States[{}_STATES_COUNT] = {{".format(fsm.name, upper))
+    for state in fsm.states:
+        out.append("\t{},".format(state))
+    out.append("};\n")
+
+    if dense:
+        out.append("// Dense table, indexed by state index * {}_EVENTS_COUNT + event ID".format(upper))
+        out.append("const fsm_dense_entry_t {}Table[DENSE_FSM_TABLE_SIZE({}_STATES_COUNT, {}_EVENTS_COUNT)] = {{".format(fsm.name, upper, upper))
+        for state, edges in fsm.states.items():
+            out.append("\t// {}".format(state))
+            by_event = {edge.event: (index, edge) for index, edge in enumerate(edges)}
+            for event in fsm.events:
+                index, edge = by_event.get(event, by_event[DEFAULT_EVENT])
+                out.append("\t{{ {}, {}_INDEX, {}, {} }},\t// {}".format(
+                    edge.action or "DO_NOTHING", edge.next_state, index,
+                    "true" if edge.event == DEFAULT_EVENT else "false", event))
+        out.append("};\n")
+
+    out.append("/******************************************************************************/")
+    return "\n".join(out) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compiles a FSM description into lib/fsm tables")
+    parser.add_argument("description", help="FSM description file")
+    parser.add_argument("-o", "--output", default=".", help="output directory")
+    parser.add_argument("--dense", choices=("auto", "always", "never"), default="auto",
+                        help="generate the table of the dense mode (auto: when a state has {} or more edges)".format(DENSE_AUTO_MIN_EDGES))
+    parser.add_argument("--fsm-include", default="lib/fsm/fsm.h", help="include path of fsm.h")
+    parser.add_argument("--werror", action="store_true", help="treat the warnings as errors")
+    args = parser.parse_args()
+    if os.path.exists(args.output) and not os.path.isdir(args.output):
+        parser.error("the output {} is not a directory".format(args.output))
+
+    try:
+        fsm = parse(args.description)
+        warnings = validate(fsm)
+    except (FsmError, OSError) as error:
+        print("error: {}".format(error), file=sys.stderr)
+        return 1
+
+    for warning in warnings:
+        print("warning: {}".format(warning), file=sys.stderr)
+    if warnings and args.werror:
+        return 1
+
+    dense = use_dense(fsm, args.dense)
+    header_name = "{}_fsm.h".format(fsm.name)
+    source_name = "{}_fsm.c".format(fsm.name)
+    try:
+        os.makedirs(args.output, exist_ok=True)
+        with open(os.path.join(args.output, header_name), "w", encoding="utf-8") as file:
+            file.write(emit_header(fsm, dense, args.fsm_include, header_name))
+        with open(os.path.join(args.output, source_name), "w", encoding="utf-8") as file:
+            file.write(emit_source(fsm, dense, header_name, source_name))
+    except OSError as error:
+        print("error: {}".format(error), file=sys.stderr)
+        return 1
+
+    print("{}: {} states, {} events, {} edges{}".format(
+        fsm.name, len(fsm.states), len(fsm.events),
+        sum(len(edges) for edges in fsm.states.values()),
+        ", dense table of {} entries".format(len(fsm.states) * len(fsm.events)) if dense else ""))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""
+  @file     fsm_trace_decoder.py
+  @brief    Decodes the dump of the FSM trace into a timeline and histograms
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+
+Reads the output of fsmTraceDump(), for example captured from the UART, and
+prints the timeline of the cycles and histograms of the states, events and
+default edges taken. Lines which are not records are ignored, so the capture
+can contain other messages. When there are many dumps, only the last one is used,
+unless --all is given.
+
+States are recorded with their address in fsmCycle() and with their index in
+fsmDenseCycle(). Addresses are named with the output of nm of the firmware,
+indexes with the list given to --states. Events are named with --events.
+
+Usage:
+    arm-none-eabi-nm firmware.axf > symbols.txt
+    python3 fsm_trace_decoder.py capture.txt --symbols symbols.txt --events NONE,LEFT,RIGHT --clock 120e6
+"""
+
+import argparse
+import re
+import sys
+from collections import Counter, defaultdict
+
+HEADER = "timestamp,state,event,edge,flags"
+RECORD_RE = re.compile(r"^(\d+),(\d+),(\d+),(\d+),(\d+)$")
+
+FLAG_DEFAULT_EDGE = 0x01
+FLAG_DENSE = 0x02
+
+TIMESTAMP_MODULO = 1 << 32
+
+
+def read_records(path, use_all):
+    dumps = []
+    with open(path, encoding="utf-8", errors="replace") as file:
+        for raw in file:
+            line = raw.strip()
+            if line == HEADER:
+                dumps.append([])
+                continue
+            match = RECORD_RE.match(line)
+            if match and dumps:
+                timestamp, state, event, edge, flags = (int(value) for value in match.groups())
+                dumps[-1].append({
+                    "timestamp": timestamp,
+                    "state": state,
+                    "event": event,
+                    "edge": edge,
+                    "default": bool(flags & FLAG_DEFAULT_EDGE),
+                    "dense": bool(flags & FLAG_DENSE),
+                })
+    if not dumps:
+        return []
+    return [record for dump in dumps for record in dump] if use_all else dumps[-1]
+
+
+def read_symbols(path):
+    symbols = {}
+    if path:
+        with open(path, encoding="utf-8", errors="replace") as file:
+            for line in file:
+                fields = line.split()
+                if len(fields) == 3:
+                    try:
+                        # The trace keeps the 32 bits of the address
+                        symbols[int(fields[0], 16) & 0xFFFFFFFF] = fields[2]
+                    except ValueError:
+                        pass
+    return symbols
+
+
+def split_names(text):
+    return [name.strip() for name in text.split(",")] if text else []
+
+
+class Namer:
+    def __init__(self, symbols, states, events):
+        self.symbols = symbols
+        self.states = states
+        self.events = events
+
+    def state(self, record):
+        value = record["state"]
+        if record["dense"]:
+            return self.states[value] if value < len(self.states) else "state[{}]".format(value)
+        return self.symbols.get(value, "0x{:08X}".format(value))
+
+    def event(self, record):
+        value = record["event"]
+        return self.events[value] if value < len(self.events) else str(value)
+
+
+def elapsed(previous, current):
+    # Timestamps are 32 bits free running counters
+    return (current - previous) % TIMESTAMP_MODULO
+
+
+def print_timeline(records, namer, clock):
+    print("Timeline")
+    print("{:>12} {:>12}  {:<24} {:<24} {:>4}  {}".format(
+        "time", "delta", "state", "event", "edge", "default"))
+    previous = records[0]["timestamp"]
+    total = 0
+    for record in records:
+        delta = elapsed(previous, record["timestamp"])
+        total += delta
+        previous = record["timestamp"]
+        print("{:>12} {:>12}  {:<24} {:<24} {:>4}  {}".format(
+            format_time(total, clock), format_time(delta, clock),
+            namer.state(record), namer.event(record), record["edge"],
+            "*" if record["default"] else ""))
+    print()
+
+
+def format_time(ticks, clock):
+    return "{:.6f}".format(ticks / clock) if clock else str(ticks)
+
+
+def print_histogram(title, counter, total=None):
+    print(title)
+    if not counter:
+        print("  (none)\n")
+        return
+    width = max(len(str(key)) for key in counter)
+    peak = max(counter.values())
+    for key, count in counter.most_common():
+        bar = "#" * max(1, round(40 * count / peak))
+        share = " {:5.1f}%".format(100 * count / total) if total else ""
+        print("  {:<{}} {:>8}{} {}".format(str(key), width, count, share, bar))
+    print()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decodes the dump of the FSM trace")
+    parser.add_argument("capture", help="file with the output of fsmTraceDump()")
+    parser.add_argument("--symbols", help="output of nm of the firmware, to name the states")
+    parser.add_argument("--states", help="comma separated names of the states of the dense mode, by index")
+    parser.add_argument("--events", help="comma separated names of the events, by ID")
+    parser.add_argument("--clock", type=float, help="frequency of the timestamps in Hz, to print seconds")
+    parser.add_argument("--all", action="store_true", help="use every dump of the capture, not only the last one")
+    parser.add_argument("--no-timeline", action="store_true", help="only print the histograms")
+    args = parser.parse_args()
+
+    records = read_records(args.capture, args.all)
+    if not records:
+        print("error: no trace found in {}".format(args.capture), file=sys.stderr)
+        return 1
+
+    namer = Namer(read_symbols(args.symbols), split_names(args.states), split_names(args.events))
+
+    if not args.no_timeline:
+        print_timeline(records, namer, args.clock)
+
+    states = Counter(namer.state(record) for record in records)
+    events = Counter(namer.event(record) for record in records)
+    defaults = Counter("{} / {}".format(namer.state(record), namer.event(record))
+                       for record in records if record["default"])
+    print_histogram("Cycles per state", states, len(records))
+    print_histogram("Cycles per event", events, len(records))
+    print_histogram("Default edges taken (state / event)", defaults, len(records))
+
+    # Time from each cycle to the next one, attributed to the state cycled
+    dwell = defaultdict(int)
+    for record, following in zip(records, records[1:]):
+        dwell[namer.state(record)] += elapsed(record["timestamp"], following["timestamp"])
+    if any(dwell.values()):
+        total = sum(dwell.values())
+        print("Time per state")
+        for state, ticks in sorted(dwell.items(), key=lambda item: -item[1]):
+            print("  {:<24} {:>14} {:5.1f}%".format(state, format_time(ticks, args.clock), 100 * ticks / total))
+        print()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
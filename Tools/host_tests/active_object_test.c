@@ -0,0 +1,241 @@
+/*******************************************************************************
+  @file     active_object_test.c
+  @brief    Host unit test and benchmark of the active object runtime, driven
+            by a simulated tick
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "lib/active_object/active_object.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define QUEUE_SIZE			9			// One element is used to tell full from empty
+#define LOG_SIZE			64
+#define SIMULATED_TICKS		1000
+#define BENCH_CALLS			2000000UL
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+enum {
+	EV_TOGGLE,
+	EV_TIMEOUT,
+	EV_WORK
+};
+
+typedef struct {
+	event_id_t	id;
+	uint32_t	value;
+} test_event_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+// Every action appends the priority of its object and the value of the event
+static uint32_t			actionLog[LOG_SIZE];
+static size_t			logCount;
+static uint32_t			toggles;
+static uint32_t			timeouts;
+static uint32_t			timeoutTick;
+static uint32_t			idleCalls;
+static uint32_t			now;
+
+static test_event_t		lowBuffer[QUEUE_SIZE];
+static test_event_t		highBuffer[QUEUE_SIZE];
+static test_event_t		blinkerBuffer[QUEUE_SIZE];
+static active_object_t	low;
+static active_object_t	high;
+static active_object_t	blinker;
+
+static void logLow(void* event)		{ if (logCount < LOG_SIZE) actionLog[logCount++] = 0x100 | ((test_event_t*)event)->value; }
+static void logHigh(void* event)	{ if (logCount < LOG_SIZE) actionLog[logCount++] = 0x300 | ((test_event_t*)event)->value; }
+static void toggle(void* event)		{ toggles++; }
+static void timeout(void* event)	{ timeouts++; timeoutTick = now; }
+static void idle(void)				{ idleCalls++; }
+
+extern edge_t lowState[], highState[], blinkerOff[], blinkerOn[];
+
+edge_t lowState[] = {
+	{ EV_WORK, lowState, logLow },
+	DEFAULT_NO_ACTION_EDGE(lowState)
+};
+
+edge_t highState[] = {
+	{ EV_WORK, highState, logHigh },
+	DEFAULT_NO_ACTION_EDGE(highState)
+};
+
+edge_t blinkerOff[] = {
+	{ EV_TOGGLE, blinkerOn, toggle },
+	{ EV_TIMEOUT, blinkerOff, timeout },
+	DEFAULT_NO_ACTION_EDGE(blinkerOff)
+};
+
+edge_t blinkerOn[] = {
+	{ EV_TOGGLE, blinkerOff, toggle },
+	{ EV_TIMEOUT, blinkerOn, timeout },
+	DEFAULT_NO_ACTION_EDGE(blinkerOn)
+};
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Runs the objects until none has events, as the main loop between two ticks
+static void runToIdle(void)
+{
+	while (aoRun());
+}
+
+// Events are dispatched by priority, and in order within each object
+static void testPriorities(void)
+{
+	for (uint32_t i = 0 ; i < 3 ; i++)
+	{
+		test_event_t event = { EV_WORK, i };
+		CHECK(aoPost(&low, &event));
+		CHECK(aoPost(&high, &event));
+	}
+
+	// Posted from an "ISR" between two dispatches, it preempts the pending low ones
+	CHECK(aoRun());
+	test_event_t late = { EV_WORK, 9 };
+	CHECK(aoPost(&high, &late));
+	runToIdle();
+
+	static const uint32_t expected[] = { 0x300, 0x301, 0x302, 0x309, 0x100, 0x101, 0x102 };
+	CHECK(logCount == sizeof(expected) / sizeof(expected[0]));
+	for (size_t i = 0 ; i < logCount ; i++)
+	{
+		CHECK(actionLog[i] == expected[i]);
+	}
+}
+
+// Objects without events are not dispatched, the idle hook runs instead
+static void testIdle(void)
+{
+	uint32_t before = idleCalls;
+	size_t logged = logCount;
+
+	CHECK(!aoRun());
+	CHECK(!aoRun());
+	CHECK(idleCalls == before + 2);
+	CHECK(logCount == logged);
+
+	// A full queue rejects the post, and the object keeps its events
+	test_event_t event = { EV_WORK, 0 };
+	for (uint32_t i = 0 ; i < QUEUE_SIZE - 1 ; i++)
+	{
+		CHECK(aoPost(&low, &event));
+	}
+	CHECK(!aoPost(&low, &event));
+	runToIdle();
+	CHECK(logCount == logged + QUEUE_SIZE - 1);
+}
+
+// Time events, posted by the simulated tick
+static void testTimeEvents(void)
+{
+	static test_event_t toggleEvent = { EV_TOGGLE, 0 };
+	static test_event_t timeoutEvent = { EV_TIMEOUT, 0 };
+	static ao_time_event_t blink;
+	static ao_time_event_t once;
+
+	CHECK(aoTimeEventArm(&blink, &blinker, &toggleEvent, 5, 5));
+	CHECK(aoTimeEventArm(&once, &blinker, &timeoutEvent, 12, 0));
+
+	for (now = 1 ; now <= SIMULATED_TICKS ; now++)
+	{
+		aoTick();
+		runToIdle();
+	}
+
+	CHECK(toggles == SIMULATED_TICKS / 5);
+	CHECK(timeouts == 1 && timeoutTick == 12);
+	CHECK(!once.armed);
+	CHECK(blinker.state == blinkerOff);
+
+	aoTimeEventDisarm(&blink);
+	uint32_t before = toggles;
+	for (uint32_t i = 0 ; i < 100 ; i++)
+	{
+		aoTick();
+		runToIdle();
+	}
+	CHECK(toggles == before);
+}
+
+// Cost of a post and its dispatch, of an idle run, and of a tick with armed time events
+static void benchmark(void)
+{
+	static test_event_t toggleEvent = { EV_TOGGLE, 0 };
+	static ao_time_event_t timeEvents[AO_MAX_TIME_EVENTS];
+	bench_report_t report = benchOpen(NULL);
+	test_event_t event = { EV_TOGGLE, 0 };
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < BENCH_CALLS ; n++)
+	{
+		aoPost(&blinker, &event);
+		aoRun();
+	}
+	benchRecord(&report, "active_object", "post_dispatch", 1, (benchNow() - start) / BENCH_CALLS, "ns/event");
+
+	aoSetIdleHook(NULL);
+	start = benchNow();
+	for (size_t n = 0 ; n < BENCH_CALLS ; n++)
+	{
+		BENCH_KEEP(aoRun());
+	}
+	benchRecord(&report, "active_object", "idle_run", 0, (benchNow() - start) / BENCH_CALLS, "ns/call");
+
+	// Time events far from expiring, the cost of each tick that posts nothing
+	for (size_t i = 0 ; i < AO_MAX_TIME_EVENTS ; i++)
+	{
+		aoTimeEventArm(&timeEvents[i], &blinker, &toggleEvent, BENCH_CALLS * 2, 0);
+	}
+	start = benchNow();
+	for (size_t n = 0 ; n < BENCH_CALLS ; n++)
+	{
+		aoTick();
+	}
+	benchRecord(&report, "active_object", "tick", AO_MAX_TIME_EVENTS, (benchNow() - start) / BENCH_CALLS, "ns/tick");
+	benchClose(&report);
+}
+
+int main(void)
+{
+	low.queue = createEventQueue(lowBuffer, QUEUE_SIZE, sizeof(test_event_t));
+	high.queue = createEventQueue(highBuffer, QUEUE_SIZE, sizeof(test_event_t));
+	blinker.queue = createEventQueue(blinkerBuffer, QUEUE_SIZE, sizeof(test_event_t));
+	CHECK(aoRegister(&low, 0, lowState));
+	CHECK(aoRegister(&high, 3, highState));
+	CHECK(aoRegister(&blinker, 1, blinkerOff));
+	CHECK(!aoRegister(&blinker, 3, blinkerOff));
+	CHECK(!aoRegister(&blinker, AO_MAX_OBJECTS, blinkerOff));
+	aoSetIdleHook(idle);
+
+	testPriorities();
+	testIdle();
+	testTimeEvents();
+	printf("priorities, idle and time events over %u simulated ticks passed\n", SIMULATED_TICKS);
+
+	benchmark();
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
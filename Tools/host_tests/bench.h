@@ -0,0 +1,111 @@
+/*******************************************************************************
+  @file     bench.h
+  @brief    Timing and CSV/JSON results of the host benchmarks
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+// Keeps the compiler from optimizing away a value only computed for the benchmark
+#define BENCH_KEEP(value)		__asm__ volatile("" : : "g"(value) : "memory")
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Results of a benchmark, each one is a row of <prefix>.csv and an object of
+// <prefix>.json, both with the same fields, so they can be compared between
+// releases with any tool:
+//
+// suite,case,param,value,unit
+// queue,pushMany,16,412.5,bytes/us
+typedef struct {
+	FILE*	csv;
+	FILE*	json;
+	int		count;
+} bench_report_t;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+/**
+ * @brief Returns a monotonic time in nanoseconds
+ */
+static inline double benchNow(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+/**
+ * @brief Opens <prefix>.csv and <prefix>.json, or only prints the results without prefix
+ */
+static inline bench_report_t benchOpen(const char* prefix)
+{
+	bench_report_t report = { NULL, NULL, 0 };
+	if (prefix)
+	{
+		char path[256];
+		snprintf(path, sizeof(path), "%s.csv", prefix);
+		report.csv = fopen(path, "w");
+		snprintf(path, sizeof(path), "%s.json", prefix);
+		report.json = fopen(path, "w");
+		if (!report.csv || !report.json)
+		{
+			perror(prefix);
+			exit(EXIT_FAILURE);
+		}
+		fprintf(report.csv, "suite,case,param,value,unit\n");
+		fprintf(report.json, "[\n");
+	}
+	return report;
+}
+
+/**
+ * @brief Adds a result to the report, and prints it
+ */
+static inline void benchRecord(bench_report_t* report, const char* suite, const char* name, long param, double value, const char* unit)
+{
+	printf("%-14s %-24s %6ld %12.3f %s\n", suite, name, param, value, unit);
+	if (report->csv)
+	{
+		fprintf(report->csv, "%s,%s,%ld,%.3f,%s\n", suite, name, param, value, unit);
+		fprintf(report->json, "%s  {\"suite\": \"%s\", \"case\": \"%s\", \"param\": %ld, \"value\": %.3f, \"unit\": \"%s\"}",
+				report->count ? ",\n" : "", suite, name, param, value, unit);
+	}
+	report->count++;
+}
+
+/**
+ * @brief Closes the files of the report
+ */
+static inline void benchClose(bench_report_t* report)
+{
+	if (report->csv)
+	{
+		fprintf(report->json, "\n]\n");
+		fclose(report->csv);
+		fclose(report->json);
+	}
+}
+
+/*******************************************************************************
+ ******************************************************************************/
+
+#endif // BENCH_H_
@@ -0,0 +1,182 @@
+/*******************************************************************************
+  @file     event_priority_test.c
+  @brief    Host test of the dispatch latency of the high priority events of the
+            Event Queue, under a flood of low priority events, and of the
+            coalescing of the events posted to different levels
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "lib/event_queue/event_queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define LOW_QUEUE_SIZE		65			// One element is used to tell full from empty
+#define HIGH_QUEUE_SIZE		5
+#define TRIALS				20000
+#define FLOOD_PER_DISPATCH	2			// Low priority events posted on each dispatch, faster than served
+
+#define EVENT_LOW			1
+#define EVENT_HIGH			2
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {
+	uint32_t	id;
+	uint32_t	sequence;
+} test_event_t;
+
+typedef struct {
+	uint32_t	dispatches;		// Worst case of events dispatched until the high priority one, including it
+	double		nanoseconds;	// Worst case of time from the post until the high priority one is dispatched
+	double		mean;			// Mean of the time from the post until the high priority one is dispatched
+} latency_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static test_event_t	lowBuffer[LOW_QUEUE_SIZE];
+static test_event_t	highBuffer[HIGH_QUEUE_SIZE];
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Floods the queue with low priority events, as a fast ISR would, and posts a
+// high priority event at a pseudo random dispatch of each trial. With the
+// priority levels disabled, every event goes through the default level.
+static latency_t measure(bool priorities)
+{
+	event_queue_t queue = createEventQueue(lowBuffer, LOW_QUEUE_SIZE, sizeof(test_event_t));
+	latency_t worst = { 0, 0, 0 };
+	uint32_t seed = 12345;
+
+	if (priorities)
+	{
+		attachEventPriority(&queue, EVENT_PRIORITY_HIGHEST, highBuffer, HIGH_QUEUE_SIZE);
+	}
+
+	for (uint32_t trial = 0 ; trial < TRIALS ; trial++)
+	{
+		test_event_t low = { EVENT_LOW, 0 };
+		test_event_t high = { EVENT_HIGH, trial };
+		seed = seed * 1103515245 + 12345;
+		uint32_t postAt = (seed >> 16) % (2 * LOW_QUEUE_SIZE);
+		uint32_t dispatches = 0;
+		bool posted = false;
+		bool dispatched = false;
+		double postedTime = 0;
+
+		for (uint32_t step = 0 ; !dispatched ; step++)
+		{
+			if (step == postAt)
+			{
+				// Posted right after a dispatch, when even the flooded level has a free slot
+				postedTime = benchNow();
+				posted = postPriorityEvent(&queue, &high, EVENT_PRIORITY_HIGHEST);
+				if (!posted)
+				{
+					printf("FAIL: trial %u could not post the high priority event\n", trial);
+					exit(EXIT_FAILURE);
+				}
+			}
+			for (uint32_t i = 0 ; i < FLOOD_PER_DISPATCH ; i++)
+			{
+				low.sequence++;
+				postEvent(&queue, &low);
+			}
+
+			test_event_t* event = getNextEvent(&queue);
+			if (posted)
+			{
+				dispatches++;
+				if (event && event->id == EVENT_HIGH)
+				{
+					double elapsed = benchNow() - postedTime;
+					if (event->sequence != trial)
+					{
+						printf("FAIL: trial %u dispatched the high priority event %u\n", trial, event->sequence);
+						exit(EXIT_FAILURE);
+					}
+					dispatched = true;
+					worst.dispatches = dispatches > worst.dispatches ? dispatches : worst.dispatches;
+					worst.nanoseconds = elapsed > worst.nanoseconds ? elapsed : worst.nanoseconds;
+					worst.mean += elapsed / TRIALS;
+				}
+			}
+		}
+	}
+
+	return worst;
+}
+
+// Events of the same ID are coalesced only with the one waiting in the same
+// level, so a post of higher priority is not absorbed by a waiting low one
+static void checkCoalescing(void)
+{
+	event_queue_t queue = createEventQueue(lowBuffer, LOW_QUEUE_SIZE, sizeof(test_event_t));
+	test_event_t* event;
+
+	attachEventPriority(&queue, EVENT_PRIORITY_HIGHEST, highBuffer, HIGH_QUEUE_SIZE);
+	setEventCoalescing(&queue, EVENT_LOW, EVENT_COALESCE_KEEP_LATEST, NULL);
+
+	postPriorityEvent(&queue, &(test_event_t){ EVENT_LOW, 1 }, EVENT_PRIORITY_DEFAULT);
+	postPriorityEvent(&queue, &(test_event_t){ EVENT_LOW, 2 }, EVENT_PRIORITY_HIGHEST);
+	postPriorityEvent(&queue, &(test_event_t){ EVENT_LOW, 3 }, EVENT_PRIORITY_HIGHEST);
+	postPriorityEvent(&queue, &(test_event_t){ EVENT_LOW, 4 }, EVENT_PRIORITY_DEFAULT);
+
+	static const uint32_t expected[] = { 3, 4 };
+	for (size_t i = 0 ; i < sizeof(expected) / sizeof(expected[0]) ; i++)
+	{
+		event = getNextEvent(&queue);
+		if (event == NO_EVENTS || event->sequence != expected[i])
+		{
+			printf("FAIL: coalescing dispatched %d instead of the event %u\n", event ? (int)event->sequence : -1, expected[i]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	// Once dispatched, the next post of the level takes a slot again
+	postPriorityEvent(&queue, &(test_event_t){ EVENT_LOW, 5 }, EVENT_PRIORITY_HIGHEST);
+	event = getNextEvent(&queue);
+	if (getNextEvent(&queue) != NO_EVENTS || event == NO_EVENTS || event->sequence != 5)
+	{
+		printf("FAIL: coalescing kept an event already dispatched\n");
+		exit(EXIT_FAILURE);
+	}
+	printf("coalescing      same ID coalesced per level, priority of the posts kept\n");
+}
+
+int main(void)
+{
+	checkCoalescing();
+
+	latency_t fifo = measure(false);
+	latency_t priority = measure(true);
+
+	// The times include the host scheduler noise, the dispatches are exact
+	printf("single FIFO     worst case %3u dispatches, %8.0f ns, mean %6.0f ns\n", fifo.dispatches, fifo.nanoseconds, fifo.mean);
+	printf("priority levels worst case %3u dispatches, %8.0f ns, mean %6.0f ns\n", priority.dispatches, priority.nanoseconds, priority.mean);
+
+	// The high priority event must be the next one dispatched, whatever the flood
+	if (priority.dispatches != 1)
+	{
+		printf("FAIL: the high priority event waited behind %u events\n", priority.dispatches - 1);
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
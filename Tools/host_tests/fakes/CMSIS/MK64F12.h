@@ -0,0 +1,8 @@
+/*******************************************************************************
+  @file     MK64F12.h
+  @brief    Host stand-in of the K64F peripheral header, for the drivers that
+            include it from the CMSIS folder
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#include "../MK64F12.h"
@@ -0,0 +1,189 @@
+/*******************************************************************************
+  @file     MK64F12.h
+  @brief    Host stand-in of the K64F peripheral header, the registers are
+            plain memory, only what the drivers built on the host use
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef FAKES_MK64F12_H_
+#define FAKES_MK64F12_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef int IRQn_Type;
+
+#define DMA0_IRQn				0
+#define SysTick_IRQn			-1
+
+#include "core_cm4.h"
+
+/*******************************************************************************
+ * GPIO, PORT AND SIM
+ ******************************************************************************/
+
+typedef struct {
+	volatile uint32_t PDOR, PSOR, PCOR, PTOR, PDIR, PDDR;
+} GPIO_Type;
+
+typedef struct {
+	volatile uint32_t PCR[32];
+	volatile uint32_t ISFR;
+} PORT_Type;
+
+typedef struct {
+	volatile uint32_t SCGC1, SCGC4, SCGC5, SCGC6, SCGC7;
+} SIM_Type;
+
+/*******************************************************************************
+ * UART, THE TEST WRITES THE FLAGS AND THE WORDS RECEIVED
+ ******************************************************************************/
+
+typedef struct {
+	volatile uint8_t BDH, BDL, C1, C2, S1, S2, C3, D, MA1, MA2, C4, C5, ED, MODEM, IR;
+	volatile uint8_t PFIFO, CFIFO, SFIFO, TWFIFO, TCFIFO, RWFIFO, RCFIFO;
+} UART_Type;
+
+/*******************************************************************************
+ * DMA AND DMAMUX, THE CHANNELS ARE RUN BY THE TEST
+ ******************************************************************************/
+
+typedef struct {
+	volatile uint32_t ERQ, INT;
+	volatile uint8_t CEEI, SEEI, CERQ, SERQ, CDNE, SSRT, CERR, CINT;
+	struct {
+		volatile uint32_t SADDR;
+		volatile uint16_t SOFF, ATTR;
+		volatile uint32_t NBYTES_MLNO, SLAST, DADDR;
+		volatile uint16_t DOFF;
+		union { volatile uint16_t CITER_ELINKNO, CITER_ELINKYES; };
+		volatile uint32_t DLAST_SGA;
+		volatile uint16_t CSR;
+		union { volatile uint16_t BITER_ELINKNO, BITER_ELINKYES; };
+	} TCD[16];
+} DMA_Type;
+
+typedef struct {
+	volatile uint8_t CHCFG[16];
+} DMAMUX_Type;
+
+// Defined by the test, so it can inspect and inject the registers
+extern GPIO_Type	fakeGpio[5];
+extern PORT_Type	fakePort[5];
+extern SIM_Type		fakeSim;
+extern DMA_Type		fakeDma;
+extern DMAMUX_Type	fakeDmamux;
+extern UART_Type	fakeUart[5];
+
+#define GPIO_BASE_PTRS			{ &fakeGpio[0], &fakeGpio[1], &fakeGpio[2], &fakeGpio[3], &fakeGpio[4] }
+#define PORT_BASE_PTRS			{ &fakePort[0], &fakePort[1], &fakePort[2], &fakePort[3], &fakePort[4] }
+#define GPIOA_BASE				((uintptr_t)&fakeGpio[0])
+#define GPIOB_BASE				((uintptr_t)&fakeGpio[1])
+#define PORT_IRQS				{ 59, 60, 61, 62, 63 }
+#define SIM						(&fakeSim)
+#define DMA0					(&fakeDma)
+#define DMAMUX					(&fakeDmamux)
+#define UART_BASE_PTRS			{ &fakeUart[0], &fakeUart[1], &fakeUart[2], &fakeUart[3], &fakeUart[4] }
+#define UART_RX_TX_IRQS			{ 31, 33, 35, 37, 66 }
+
+#define SIM_SCGC1_UART4_MASK	0x0400
+#define SIM_SCGC4_UART0_MASK	0x0400
+#define SIM_SCGC4_UART1_MASK	0x0800
+#define SIM_SCGC4_UART2_MASK	0x1000
+#define SIM_SCGC4_UART3_MASK	0x2000
+#define SIM_SCGC5_PORTA_MASK	0x0200
+#define SIM_SCGC5_PORTB_MASK	0x0400
+#define SIM_SCGC5_PORTC_MASK	0x0800
+#define SIM_SCGC5_PORTD_MASK	0x1000
+#define SIM_SCGC5_PORTE_MASK	0x2000
+#define SIM_SCGC6_DMAMUX_MASK	0x0002
+#define SIM_SCGC7_DMA_MASK		0x0002
+
+#define PORT_PCR_PS_MASK		0x00000001
+#define PORT_PCR_PE_MASK		0x00000002
+#define PORT_PCR_SRE_MASK		0x00000004
+#define PORT_PCR_PFE_MASK		0x00000010
+#define PORT_PCR_ODE_MASK		0x00000020
+#define PORT_PCR_DSE_MASK		0x00000040
+#define PORT_PCR_MUX_SHIFT		8
+#define PORT_PCR_MUX_MASK		0x00000700
+#define PORT_PCR_MUX(x)			(((uint32_t)(x) << PORT_PCR_MUX_SHIFT) & PORT_PCR_MUX_MASK)
+#define PORT_PCR_LK_MASK		0x00008000
+#define PORT_PCR_IRQC_MASK		0x000F0000
+#define PORT_PCR_IRQC(x)		(((uint32_t)(x) << 16) & PORT_PCR_IRQC_MASK)
+#define PORT_PCR_ISF_MASK		0x01000000
+
+#define UART_BDH_SBR_MASK		0x1F
+#define UART_BDH_SBR(x)			((uint8_t)(x) & UART_BDH_SBR_MASK)
+#define UART_BDH_SBNS(x)		(((uint8_t)(x) << 5) & 0x20)
+#define UART_BDL_SBR(x)			((uint8_t)(x))
+#define UART_C1_PT(x)			((uint8_t)(x) & 0x01)
+#define UART_C1_PE(x)			(((uint8_t)(x) << 1) & 0x02)
+#define UART_C1_ILT(x)			(((uint8_t)(x) << 2) & 0x04)
+#define UART_C1_M(x)			(((uint8_t)(x) << 4) & 0x10)
+#define UART_C2_RE_MASK			0x04
+#define UART_C2_RE(x)			(((uint8_t)(x) << 2) & UART_C2_RE_MASK)
+#define UART_C2_TE_MASK			0x08
+#define UART_C2_TE(x)			(((uint8_t)(x) << 3) & UART_C2_TE_MASK)
+#define UART_C2_ILIE(x)			(((uint8_t)(x) << 4) & 0x10)
+#define UART_C2_RIE(x)			(((uint8_t)(x) << 5) & 0x20)
+#define UART_C2_TCIE_MASK		0x40
+#define UART_C2_TCIE(x)			(((uint8_t)(x) << 6) & UART_C2_TCIE_MASK)
+#define UART_C2_TIE_MASK		0x80
+#define UART_C2_TIE(x)			(((uint8_t)(x) << 7) & UART_C2_TIE_MASK)
+#define UART_S1_IDLE_MASK		0x10
+#define UART_S1_RDRF_MASK		0x20
+#define UART_S1_TC_MASK			0x40
+#define UART_S1_TDRE_MASK		0x80
+#define UART_C3_T8_MASK			0x40
+#define UART_C3_T8(x)			(((uint8_t)(x) << 6) & UART_C3_T8_MASK)
+#define UART_C4_BRFA_MASK		0x1F
+#define UART_C4_BRFA(x)			((uint8_t)(x) & UART_C4_BRFA_MASK)
+#define UART_C5_RDMAS_MASK		0x20
+#define UART_C5_RDMAS(x)		(((uint8_t)(x) << 5) & UART_C5_RDMAS_MASK)
+#define UART_C5_TDMAS_MASK		0x80
+#define UART_C5_TDMAS(x)		(((uint8_t)(x) << 7) & UART_C5_TDMAS_MASK)
+#define UART_PFIFO_RXFIFOSIZE_MASK	0x07
+#define UART_PFIFO_RXFIFOSIZE_SHIFT	0
+#define UART_PFIFO_RXFE(x)		(((uint8_t)(x) << 3) & 0x08)
+#define UART_PFIFO_TXFIFOSIZE_MASK	0x70
+#define UART_PFIFO_TXFIFOSIZE_SHIFT	4
+#define UART_PFIFO_TXFE(x)		(((uint8_t)(x) << 7) & 0x80)
+#define UART_SFIFO_RXUF_MASK	0x01
+
+#define DMA_CERQ_CERQ(x)		((uint8_t)(x) & 0x0F)
+#define DMA_SERQ_SERQ(x)		((uint8_t)(x) & 0x0F)
+#define DMA_CDNE_CDNE(x)		((uint8_t)(x) & 0x0F)
+#define DMA_CINT_CINT(x)		((uint8_t)(x) & 0x0F)
+#define DMA_ATTR_DSIZE(x)		((uint16_t)(x) & 0x0007)
+#define DMA_ATTR_SSIZE(x)		(((uint16_t)(x) << 8) & 0x0700)
+
+#define DMA_CITER_ELINKNO_CITER_MASK	0x7FFF
+#define DMA_CITER_ELINKYES_CITER_MASK	0x01FF
+#define DMA_CITER_ELINKYES_CITER(x)		((uint16_t)(x) & DMA_CITER_ELINKYES_CITER_MASK)
+#define DMA_CITER_ELINKYES_LINKCH_MASK	0x1E00
+#define DMA_CITER_ELINKYES_LINKCH(x)	(((uint16_t)(x) << 9) & DMA_CITER_ELINKYES_LINKCH_MASK)
+#define DMA_CITER_ELINKYES_ELINK_MASK	0x8000
+#define DMA_CITER_ELINKYES_ELINK(x)		(((uint16_t)(x) << 15) & DMA_CITER_ELINKYES_ELINK_MASK)
+
+#define DMA_CSR_START_MASK		0x0001
+#define DMA_CSR_INTMAJOR_MASK	0x0002
+#define DMA_CSR_INTMAJOR(x)		(((uint16_t)(x) << 1) & DMA_CSR_INTMAJOR_MASK)
+#define DMA_CSR_INTHALF_MASK	0x0004
+#define DMA_CSR_INTHALF(x)		(((uint16_t)(x) << 2) & DMA_CSR_INTHALF_MASK)
+#define DMA_CSR_DREQ_MASK		0x0008
+#define DMA_CSR_DREQ(x)			(((uint16_t)(x) << 3) & DMA_CSR_DREQ_MASK)
+#define DMA_CSR_ESG_MASK		0x0010
+#define DMA_CSR_ESG(x)			(((uint16_t)(x) << 4) & DMA_CSR_ESG_MASK)
+#define DMA_CSR_MAJORELINK_MASK	0x0020
+#define DMA_CSR_MAJORELINK(x)	(((uint16_t)(x) << 5) & DMA_CSR_MAJORELINK_MASK)
+#define DMA_CSR_ACTIVE_MASK		0x0040
+#define DMA_CSR_DONE_MASK		0x0080
+#define DMA_CSR_MAJORLINKCH_MASK	0x0F00
+#define DMA_CSR_MAJORLINKCH(x)	(((uint16_t)(x) << 8) & DMA_CSR_MAJORLINKCH_MASK)
+
+#define DMAMUX_CHCFG_SOURCE(x)	((uint8_t)(x) & 0x3F)
+#define DMAMUX_CHCFG_TRIG(x)	(((uint8_t)(x) << 6) & 0x40)
+#define DMAMUX_CHCFG_ENBL(x)	(((uint8_t)(x) << 7) & 0x80)
+
+#endif /* FAKES_MK64F12_H_ */
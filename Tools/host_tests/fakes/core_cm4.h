@@ -0,0 +1,42 @@
+/*******************************************************************************
+  @file     core_cm4.h
+  @brief    Host stand-in of the CMSIS core header, only what the drivers built
+            on the host use
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef FAKES_CORE_CM4_H_
+#define FAKES_CORE_CM4_H_
+
+#include <stdint.h>
+
+static inline void NVIC_EnableIRQ(int irq)		{ (void)irq; }
+static inline void NVIC_DisableIRQ(int irq)		{ (void)irq; }
+static inline void NVIC_ClearPendingIRQ(int irq)	{ (void)irq; }
+
+// SysTick registers, defined by the test
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t LOAD;
+	volatile uint32_t VAL;
+	volatile uint32_t CALIB;
+} SysTick_Type;
+
+#define SysTick_CTRL_ENABLE_Msk		(1UL << 0)
+#define SysTick_CTRL_TICKINT_Msk	(1UL << 1)
+#define SysTick_CTRL_CLKSOURCE_Msk	(1UL << 2)
+#define SysTick_CTRL_COUNTFLAG_Msk	(1UL << 16)
+
+extern SysTick_Type	fakeSysTick;
+
+#define SysTick		(&fakeSysTick)
+
+static inline uint32_t SysTick_Config(uint32_t ticks)
+{
+	fakeSysTick.LOAD = ticks - 1;
+	fakeSysTick.VAL = 0;
+	fakeSysTick.CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+	return 0;
+}
+
+#endif /* FAKES_CORE_CM4_H_ */
@@ -0,0 +1,13 @@
+/*******************************************************************************
+  @file     fsl_device_registers.h
+  @brief    Host stand-in of the device header, only what the drivers built on
+            the host use
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef FAKES_FSL_DEVICE_REGISTERS_H_
+#define FAKES_FSL_DEVICE_REGISTERS_H_
+
+#include "MK64F12.h"
+
+#endif /* FAKES_FSL_DEVICE_REGISTERS_H_ */
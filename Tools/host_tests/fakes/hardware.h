@@ -0,0 +1,25 @@
+/*******************************************************************************
+  @file     hardware.h
+  @brief    Host stand-in of startup/hardware.h, the handlers are plain
+            functions the test calls
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+#ifndef FAKES_HARDWARE_H_
+#define FAKES_HARDWARE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "fsl_device_registers.h"
+#include "core_cm4.h"
+
+#define __CORE_CLOCK__  100000000U
+#define __FOREVER__     for(;;)
+#define __ISR__         void
+
+void hardwareInit (void);
+void hardwareEnableInterrupts (void);
+void hardwareDisableInterrupts (void);
+
+#endif /* FAKES_HARDWARE_H_ */
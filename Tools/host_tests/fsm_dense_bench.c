@@ -0,0 +1,151 @@
+/*******************************************************************************
+  @file     fsm_dense_bench.c
+  @brief    Host benchmark of the sparse and dense dispatch modes of the FSM
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "lib/fsm/fsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define STATES			4
+#define MAX_EDGES		64
+#define EVENTS_COUNT	(MAX_EDGES + 1)		// The last event ID has no edge, so it takes the default one
+#define CYCLES			4000000UL
+#define CHECK_CYCLES	100000UL
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static edge_t				edges[STATES][MAX_EDGES + 1];
+static state_t				states[STATES];
+static fsm_dense_entry_t	table[DENSE_FSM_TABLE_SIZE(STATES, EVENTS_COUNT)];
+static uint32_t				lastAction;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+static void edgeAction(void* event)
+{
+	lastAction = EVENT_ID(event);
+}
+
+static void defaultAction(void* event)
+{
+	lastAction = END_OF_STATE;
+}
+
+// Builds STATES states of the given amount of edges, each edge goes to a pseudo
+// random state, and the events of the edges are in reverse order, so the scan
+// of the sparse mode is not helped by the order of the IDs
+static void buildMachine(size_t count)
+{
+	uint32_t seed = 42;
+
+	for (size_t s = 0 ; s < STATES ; s++)
+	{
+		states[s] = edges[s];
+		for (size_t e = 0 ; e < count ; e++)
+		{
+			seed = seed * 1103515245 + 12345;
+			edges[s][e] = (edge_t){ count - 1 - e, edges[(seed >> 16) % STATES], edgeAction };
+		}
+		edges[s][count] = (edge_t)DEFAULT_EDGE(edges[(s + 1) % STATES], defaultAction);
+	}
+
+	if (!fsmDenseBuild(states, STATES, EVENTS_COUNT, table))
+	{
+		printf("FAIL: the dense table of %zu edges could not be built\n", count);
+		exit(EXIT_FAILURE);
+	}
+}
+
+// Cycles both modes with the same pseudo random events, which must take the same
+// states and actions, including the default edges and IDs out of the table
+static void checkEquivalence(size_t count)
+{
+	state_t sparse = states[0];
+	fsm_dense_t dense = createDenseFsm(states, STATES, EVENTS_COUNT, table, 0);
+	uint32_t seed = 7;
+
+	for (size_t n = 0 ; n < CHECK_CYCLES ; n++)
+	{
+		seed = seed * 1103515245 + 12345;
+		event_id_t event = (seed >> 16) % (EVENTS_COUNT + 4);
+
+		fsmCycle(&sparse, &event);
+		uint32_t sparseAction = lastAction;
+		fsmDenseCycle(&dense, &event);
+
+		if (sparse != DENSE_FSM_STATE(&dense) || sparseAction != lastAction)
+		{
+			printf("FAIL: %zu edges, cycle %zu, event %u, the modes diverged\n", count, n, event);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+// Returns the nanoseconds of each cycle, for the given event, in each mode
+static double runSparse(event_id_t event)
+{
+	state_t state = states[0];
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < CYCLES ; n++)
+	{
+		fsmCycle(&state, &event);
+		BENCH_KEEP(state);
+	}
+	return (benchNow() - start) / CYCLES;
+}
+
+static double runDense(event_id_t event)
+{
+	fsm_dense_t fsm = createDenseFsm(states, STATES, EVENTS_COUNT, table, 0);
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < CYCLES ; n++)
+	{
+		fsmDenseCycle(&fsm, &event);
+		BENCH_KEEP(fsm.current);
+	}
+	return (benchNow() - start) / CYCLES;
+}
+
+int main(int argc, char* argv[])
+{
+	bench_report_t report = benchOpen(argc > 1 ? argv[1] : NULL);
+	static const size_t edgeCounts[] = { 2, 16, 64 };
+
+	for (size_t c = 0 ; c < sizeof(edgeCounts) / sizeof(edgeCounts[0]) ; c++)
+	{
+		size_t count = edgeCounts[c];
+		buildMachine(count);
+		checkEquivalence(count);
+
+		// The first edge of the list has the last ID, the last edge has the ID 0
+		benchRecord(&report, "fsm_sparse", "first_edge", count, runSparse(count - 1), "ns/cycle");
+		benchRecord(&report, "fsm_dense", "first_edge", count, runDense(count - 1), "ns/cycle");
+		benchRecord(&report, "fsm_sparse", "last_edge", count, runSparse(0), "ns/cycle");
+		benchRecord(&report, "fsm_dense", "last_edge", count, runDense(0), "ns/cycle");
+		benchRecord(&report, "fsm_sparse", "default_edge", count, runSparse(MAX_EDGES), "ns/cycle");
+		benchRecord(&report, "fsm_dense", "default_edge", count, runDense(MAX_EDGES), "ns/cycle");
+	}
+
+	benchClose(&report);
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
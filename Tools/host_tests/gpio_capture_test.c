@@ -0,0 +1,264 @@
+/*******************************************************************************
+  @file     gpio_capture_test.c
+  @brief    Host test of the GPIO capture, with the channels of the eDMA run by
+            the test on fake registers, also with merged interrupts
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MK64F12.h"
+#include "drivers/MCAL/gpio/gpio_capture.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define PORT_CHANNEL		GPIO_CAPTURE_DMA_CHANNEL
+#define TRIGGER_PIN			4
+#define LENGTH				8
+#define MAX_CALLBACKS		64
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {
+	size_t		offset;			// Position of the half in the buffer
+	size_t		count;
+	uint32_t	first;			// First sample of the half when called back
+	bool		timestamped;
+} callback_t;
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+GPIO_Type	fakeGpio[5];
+PORT_Type	fakePort[5];
+SIM_Type	fakeSim;
+DMA_Type	fakeDma;
+DMAMUX_Type	fakeDmamux;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+// The driver keeps 32 bits addresses, the test is linked without PIE so the
+// static buffers have them
+static uint32_t			samples[LENGTH];
+static uint32_t			timestamps[LENGTH];
+static volatile uint32_t	timer;
+
+static callback_t		callbacks[MAX_CALLBACKS];
+static size_t			callbacksCount;
+static uint32_t			edgesInCallback;	// Edges while the next callback runs
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Interrupt handler of the port channel
+void DMA1_IRQHandler(void);
+
+static void edge(uint32_t port, uint32_t now);
+
+static void onHalf(uint32_t* halfSamples, uint32_t* halfTimestamps, size_t count)
+{
+	CHECK(callbacksCount < MAX_CALLBACKS);
+	callbacks[callbacksCount++] = (callback_t){ halfSamples - samples, count, halfSamples[0], halfTimestamps != NULL };
+	if (halfTimestamps)
+	{
+		CHECK(halfTimestamps - timestamps == halfSamples - samples);
+	}
+	for ( ; edgesInCallback ; edgesInCallback--)
+	{
+		edge(0xF00 + edgesInCallback, 0);
+	}
+}
+
+// One minor loop of a channel, as the eDMA runs it with the flags of the
+// interrupts, the request disabled at the end and the links of the channels
+static void dmaMinorLoop(uint8_t channel)
+{
+	typeof(fakeDma.TCD[0])* tcd = &fakeDma.TCD[channel];
+	bool elink = tcd->CITER_ELINKNO & DMA_CITER_ELINKYES_ELINK_MASK;
+	uint16_t mask = elink ? DMA_CITER_ELINKYES_CITER_MASK : DMA_CITER_ELINKNO_CITER_MASK;
+	uint16_t citer = (tcd->CITER_ELINKNO & mask) - 1;
+	int link = -1;
+
+	*(uint32_t*)(uintptr_t)tcd->DADDR = *(uint32_t*)(uintptr_t)tcd->SADDR;
+	tcd->SADDR += (int16_t)tcd->SOFF;
+	tcd->DADDR += (int16_t)tcd->DOFF;
+
+	if (citer == (tcd->BITER_ELINKNO & mask) / 2 && (tcd->CSR & DMA_CSR_INTHALF_MASK))
+	{
+		fakeDma.INT |= 1UL << channel;
+	}
+	if (citer == 0)
+	{
+		tcd->SADDR += tcd->SLAST;
+		tcd->DADDR += tcd->DLAST_SGA;
+		tcd->CITER_ELINKNO = tcd->BITER_ELINKNO;
+		fakeDma.INT |= (tcd->CSR & DMA_CSR_INTMAJOR_MASK) ? 1UL << channel : 0;
+		fakeDma.ERQ &= (tcd->CSR & DMA_CSR_DREQ_MASK) ? ~(1UL << channel) : ~0UL;
+		link = (tcd->CSR & DMA_CSR_MAJORELINK_MASK) ? (tcd->CSR & DMA_CSR_MAJORLINKCH_MASK) >> 8 : -1;
+	}
+	else
+	{
+		tcd->CITER_ELINKNO = (tcd->CITER_ELINKNO & ~mask) | citer;
+		link = elink ? (tcd->CITER_ELINKNO & DMA_CITER_ELINKYES_LINKCH_MASK) >> 9 : -1;
+	}
+
+	if (link >= 0)
+	{
+		dmaMinorLoop(link);
+	}
+}
+
+// Edge of the trigger with the port and the timer at the given values, the
+// interrupt of the channel is left pending
+static void edge(uint32_t port, uint32_t now)
+{
+	fakeGpio[PC].PDIR = port;
+	timer = now;
+	if (fakeDma.ERQ & (1UL << PORT_CHANNEL))
+	{
+		dmaMinorLoop(PORT_CHANNEL);
+	}
+}
+
+// The NVIC runs the handler when the flag is set, once for any amount of
+// flags raised since the last time. The handler clears the flag before the
+// callbacks, which can raise it again.
+static void serve(void)
+{
+	if (fakeDma.INT & (1UL << PORT_CHANNEL))
+	{
+		fakeDma.INT &= ~(1UL << PORT_CHANNEL);
+		fakeDma.CINT = 0xFF;
+		DMA1_IRQHandler();
+		CHECK(fakeDma.CINT == PORT_CHANNEL);
+	}
+}
+
+static void start(gpio_capture_cfg_t config)
+{
+	memset(&fakeDma, 0, sizeof(fakeDma));
+	memset(samples, 0, sizeof(samples));
+	callbacksCount = 0;
+	CHECK(gpioCaptureStart(config));
+	fakeDma.ERQ |= 1UL << fakeDma.SERQ;
+}
+
+int main(void)
+{
+	gpio_capture_cfg_t looped = { PORTNUM2PIN(PC, TRIGGER_PIN), GPIO_IRQ_MODE_DMA_FALLING_EDGE, samples, timestamps, LENGTH, &timer, true, onHalf };
+	gpio_capture_cfg_t once = { PORTNUM2PIN(PC, TRIGGER_PIN), GPIO_IRQ_MODE_DMA_BOTH_EDGES, samples, NULL, LENGTH, NULL, false, onHalf };
+
+	// Each half called back right after it is filled, with its timestamps
+	start(looped);
+	CHECK((fakePort[PC].PCR[TRIGGER_PIN] & PORT_PCR_IRQC_MASK) == PORT_PCR_IRQC(GPIO_IRQ_MODE_DMA_FALLING_EDGE));
+	CHECK(fakePort[PC].PCR[TRIGGER_PIN] & PORT_PCR_ISF_MASK);
+	CHECK(fakeDmamux.CHCFG[PORT_CHANNEL] == (DMAMUX_CHCFG_ENBL(1) | DMAMUX_CHCFG_SOURCE(49 + PC)));
+	for (uint32_t k = 0 ; k < 5 * LENGTH ; k++)
+	{
+		edge(0x100 + k, 1000 + k);
+		serve();
+		CHECK(gpioCaptureCount() == (k + 1) % LENGTH);
+		CHECK(callbacksCount == (k + 1) / (LENGTH / 2));
+		if ((k + 1) % (LENGTH / 2) == 0)
+		{
+			callback_t* last = &callbacks[callbacksCount - 1];
+			CHECK(last->offset == (k + 1 - LENGTH / 2) % LENGTH && last->count == LENGTH / 2);
+			CHECK(last->first == 0x100 + k + 1 - LENGTH / 2 && last->timestamped);
+		}
+	}
+	for (size_t i = 0 ; i < LENGTH ; i++)
+	{
+		CHECK(timestamps[i] - samples[i] == 1000 - 0x100);
+	}
+	CHECK(gpioCaptureStop() == 0 && !gpioCaptureRunning());
+
+	// The handler runs late, after the half and the end of the major loop, and
+	// gets both halves in order from a single flag. Then it runs late again,
+	// after the end and the next half.
+	start(looped);
+	for (uint32_t k = 0 ; k < LENGTH ; k++)
+	{
+		edge(0x200 + k, 0);
+	}
+	serve();
+	CHECK(callbacksCount == 2);
+	CHECK(callbacks[0].offset == 0 && callbacks[0].first == 0x200);
+	CHECK(callbacks[1].offset == LENGTH / 2 && callbacks[1].first == 0x200 + LENGTH / 2);
+	for (uint32_t k = 0 ; k < LENGTH / 2 ; k++)
+	{
+		edge(0x300 + k, 0);
+	}
+	serve();
+	CHECK(callbacksCount == 3 && callbacks[2].offset == 0 && callbacks[2].first == 0x300);
+	for (uint32_t k = LENGTH / 2 ; k < LENGTH + LENGTH / 2 + 1 ; k++)
+	{
+		edge(0x300 + k, 0);
+	}
+	serve();
+	CHECK(callbacksCount == 5);
+	CHECK(callbacks[3].offset == LENGTH / 2 && callbacks[4].offset == 0);
+	CHECK(callbacks[4].first == 0x300 + LENGTH);
+
+	// A half filled while the handler runs is left for the next interrupt
+	for (uint32_t k = LENGTH + LENGTH / 2 + 1 ; k < 2 * LENGTH ; k++)
+	{
+		edge(0x300 + k, 0);
+	}
+	edgesInCallback = LENGTH / 2;
+	serve();
+	CHECK(callbacksCount == 6 && callbacks[5].offset == LENGTH / 2);
+	CHECK(edgesInCallback == 0 && (fakeDma.INT & (1UL << PORT_CHANNEL)));
+	serve();
+	CHECK(callbacksCount == 7 && callbacks[6].offset == 0 && callbacks[6].first == 0xF00 + LENGTH / 2);
+	serve();
+	CHECK(callbacksCount == 7);
+	gpioCaptureStop();
+
+	// One shot without timestamps, both halves from a single late interrupt,
+	// then the capture stops with the buffer full
+	start(once);
+	for (uint32_t k = 0 ; k < LENGTH + 3 ; k++)
+	{
+		edge(0x400 + k, 0);
+	}
+	serve();
+	CHECK(callbacksCount == 2 && callbacks[0].offset == 0 && callbacks[1].offset == LENGTH / 2);
+	CHECK(!callbacks[0].timestamped && !callbacks[1].timestamped);
+	CHECK(!gpioCaptureRunning() && gpioCaptureCount() == LENGTH);
+	CHECK(samples[LENGTH - 1] == 0x400 + LENGTH - 1);
+	CHECK((fakePort[PC].PCR[TRIGGER_PIN] & PORT_PCR_IRQC_MASK) == 0);
+	CHECK(gpioCaptureStop() == LENGTH);
+
+	// One shot served on time
+	start(once);
+	for (uint32_t k = 0 ; k < LENGTH ; k++)
+	{
+		edge(0x500 + k, 0);
+		serve();
+		CHECK(gpioCaptureRunning() == (k + 1 < LENGTH));
+	}
+	CHECK(callbacksCount == 2 && callbacks[1].first == 0x500 + LENGTH / 2);
+	CHECK(gpioCaptureStop() == LENGTH);
+
+	printf("Halves of the capture called back in order, also from merged interrupts\n");
+
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,95 @@
+/*******************************************************************************
+  @file     gpio_group_bench.c
+  @brief    Host benchmark of the GPIO groups, on fake registers
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "MK64F12.h"
+#include "drivers/MCAL/gpio/gpio.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CALLS		20000000UL
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+GPIO_Type	fakeGpio[5];
+PORT_Type	fakePort[5];
+SIM_Type	fakeSim;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Applies the set, clear and toggle registers to the outputs, as the hardware
+// does, and loops the outputs back to the inputs
+static void applyWrites(void)
+{
+	for (uint8_t port = 0 ; port < GPIO_PORT_COUNT ; port++)
+	{
+		GPIO_Type* gpio = &fakeGpio[port];
+		gpio->PDOR = ((gpio->PDOR | gpio->PSOR) & ~gpio->PCOR) ^ gpio->PTOR;
+		gpio->PSOR = gpio->PCOR = gpio->PTOR = 0;
+		gpio->PDIR = gpio->PDOR;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	bench_report_t report = benchOpen(argc > 1 ? argv[1] : NULL);
+
+	// The 8 segments of the display board, on two ports
+	static const pin_t pins[] = {
+		PORTNUM2PIN(PC, 5), PORTNUM2PIN(PC, 7), PORTNUM2PIN(PC, 0), PORTNUM2PIN(PC, 9),
+		PORTNUM2PIN(PC, 8), PORTNUM2PIN(PC, 1), PORTNUM2PIN(PB, 19), PORTNUM2PIN(PB, 18)
+	};
+	gpio_group_t group;
+	gpioGroupInit(&group, pins, sizeof(pins) / sizeof(pins[0]));
+	gpioGroupMode(&group, OUTPUT);
+
+	// Every value is written and read back, the other pins of the ports are kept
+	fakeGpio[PC].PDOR = 0x80000000;
+	for (uint32_t value = 0 ; value < 256 ; value++)
+	{
+		gpioGroupWrite(&group, value);
+		applyWrites();
+		if (gpioGroupRead(&group) != value || !(fakeGpio[PC].PDOR & 0x80000000))
+		{
+			printf("FAIL: the group value 0x%02x was not written and read back\n", value);
+			return EXIT_FAILURE;
+		}
+	}
+
+	double start = benchNow();
+	for (uint32_t n = 0 ; n < CALLS ; n++)
+	{
+		gpioGroupWrite(&group, n);
+	}
+	benchRecord(&report, "gpio", "gpioGroupWrite", group.count, (benchNow() - start) / CALLS, "ns/call");
+
+	uint32_t value = 0;
+	start = benchNow();
+	for (uint32_t n = 0 ; n < CALLS ; n++)
+	{
+		value += gpioGroupRead(&group);
+	}
+	BENCH_KEEP(value);
+	benchRecord(&report, "gpio", "gpioGroupRead", group.count, (benchNow() - start) / CALLS, "ns/call");
+
+	benchClose(&report);
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
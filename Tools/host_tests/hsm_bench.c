@@ -0,0 +1,215 @@
+/*******************************************************************************
+  @file     hsm_bench.c
+  @brief    Host benchmark of the dispatch of the Hierarchical State Machine,
+            against the same machine flattened into the FSM
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "lib/fsm/fsm.h"
+#include "lib/hsm/hsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define STATES			5
+#define EVENTS_COUNT	6
+#define CYCLES			4000000UL
+#define CHECK_CYCLES	100000UL
+
+// Records the time of both machines for the events of the array
+#define BENCH_CASE(report, events)	do {																					\
+										size_t count = sizeof(events) / sizeof(events[0]);								\
+										benchRecord(report, "hsm", #events, count, runHsm(events, count), "ns/event");		\
+										benchRecord(report, "fsm_flat", #events, count, runFsm(events, count), "ns/event");	\
+									} while (0)
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+enum {
+	EVENT_NEXT,				// Between the children of a
+	EVENT_TO_B,				// Handled by a, for its children
+	EVENT_TO_A,				// From b to a, entering its initial child
+	EVENT_SELF,				// Self-transition of a, from its children
+	EVENT_INTERNAL,			// Internal transition of top
+	EVENT_UNHANDLED			// Not handled by any state
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+// Every entry, exit and transition action adds one, the actions of the flat
+// machine add the ones of the same transition in the hierarchical machine
+static uint32_t		work;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+static void work1(void* event) { work += 1; }
+static void work3(void* event) { work += 3; }
+static void work4(void* event) { work += 4; }
+static void work5(void* event) { work += 5; }
+
+// top
+// ├── a (initial)
+// │   ├── a1 (initial)
+// │   └── a2
+// └── b
+static const hsm_state_t top, a, a1, a2, b;
+
+static const hsm_edge_t topEdges[] = {
+	{	EVENT_INTERNAL,	HSM_INTERNAL,	work1	},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t aEdges[] = {
+	{	EVENT_TO_B,		&b,				work1	},
+	{	EVENT_SELF,		&a,				work1	},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t a1Edges[] = {
+	{	EVENT_NEXT,		&a2,			work1	},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t a2Edges[] = {
+	{	EVENT_NEXT,		&a1,			work1	},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t bEdges[] = {
+	{	EVENT_TO_A,		&a,				work1	},
+	HSM_END_OF_EDGES
+};
+
+static const hsm_state_t top = { NULL, &a, work1, work1, topEdges };
+static const hsm_state_t a = { &top, &a1, work1, work1, aEdges };
+static const hsm_state_t a1 = { &a, NULL, work1, work1, a1Edges };
+static const hsm_state_t a2 = { &a, NULL, work1, work1, a2Edges };
+static const hsm_state_t b = { &top, NULL, work1, work1, bEdges };
+
+static const hsm_state_t* const hsmStates[STATES] = { &top, &a, &a1, &a2, &b };
+static hsm_entry_t	table[HSM_TABLE_SIZE(STATES, EVENTS_COUNT)];
+static hsm_path_t	paths[STATES];
+static hsm_t		hsm;
+
+// The same machine flattened into its leaves, the inherited edges copied into
+// each child, with the entry and exit actions folded into the transition
+static edge_t flatA1[5], flatA2[5], flatB[3];
+
+static edge_t flatA1[] = {
+	{	EVENT_NEXT,		flatA2,		work3	},
+	{	EVENT_TO_B,		flatB,		work4	},
+	{	EVENT_SELF,		flatA1,		work5	},
+	{	EVENT_INTERNAL,	flatA1,		work1	},
+	DEFAULT_NO_ACTION_EDGE(flatA1)
+};
+static edge_t flatA2[] = {
+	{	EVENT_NEXT,		flatA1,		work3	},
+	{	EVENT_TO_B,		flatB,		work4	},
+	{	EVENT_SELF,		flatA1,		work5	},
+	{	EVENT_INTERNAL,	flatA2,		work1	},
+	DEFAULT_NO_ACTION_EDGE(flatA2)
+};
+static edge_t flatB[] = {
+	{	EVENT_TO_A,		flatA1,		work4	},
+	{	EVENT_INTERNAL,	flatB,		work1	},
+	DEFAULT_NO_ACTION_EDGE(flatB)
+};
+
+// Leaf of the flat machine of each state of the hierarchical one
+static const state_t flatOf[STATES] = { NULL, NULL, flatA1, flatA2, flatB };
+
+// Dispatches the same pseudo random events to both machines, which must be in
+// the same leaf and have done the same work after each one
+static void checkEquivalence(void)
+{
+	state_t flat = flatA1;
+	uint32_t seed = 7;
+
+	hsmStart(&hsm, 0);
+	for (size_t n = 0 ; n < CHECK_CYCLES ; n++)
+	{
+		seed = seed * 1103515245 + 12345;
+		event_id_t event = (seed >> 16) % EVENTS_COUNT;
+
+		work = 0;
+		hsmDispatch(&hsm, &event);
+		uint32_t hsmWork = work;
+		work = 0;
+		fsmCycle(&flat, &event);
+
+		if (flatOf[hsm.current] != flat || work != hsmWork)
+		{
+			printf("FAIL: cycle %zu, event %u, the machines diverged\n", n, event);
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+// Returns the nanoseconds of each dispatch of the events, in turns
+static double runHsm(const event_id_t* events, size_t count)
+{
+	hsmStart(&hsm, 0);
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < CYCLES ; n++)
+	{
+		hsmDispatch(&hsm, (void*)&events[n % count]);
+		BENCH_KEEP(hsm.current);
+	}
+	return (benchNow() - start) / CYCLES;
+}
+
+static double runFsm(const event_id_t* events, size_t count)
+{
+	state_t state = flatA1;
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < CYCLES ; n++)
+	{
+		fsmCycle(&state, (void*)&events[n % count]);
+		BENCH_KEEP(state);
+	}
+	return (benchNow() - start) / CYCLES;
+}
+
+int main(int argc, char* argv[])
+{
+	bench_report_t report = benchOpen(argc > 1 ? argv[1] : NULL);
+
+	static const event_id_t siblings[] = { EVENT_NEXT };
+	static const event_id_t fallback[] = { EVENT_TO_B, EVENT_TO_A };
+	static const event_id_t self[] = { EVENT_SELF };
+	static const event_id_t internal[] = { EVENT_INTERNAL };
+	static const event_id_t unhandled[] = { EVENT_UNHANDLED };
+
+	if (!hsmBuild(&hsm, hsmStates, STATES, EVENTS_COUNT, table, paths))
+	{
+		printf("FAIL: the table of the hierarchical machine could not be built\n");
+		exit(EXIT_FAILURE);
+	}
+	checkEquivalence();
+
+	// The flat machine scans the edges of the leaf, the hierarchical one takes
+	// the entry of the table and runs the actions of each level
+	BENCH_CASE(&report, siblings);
+	BENCH_CASE(&report, fallback);
+	BENCH_CASE(&report, self);
+	BENCH_CASE(&report, internal);
+	BENCH_CASE(&report, unhandled);
+
+	benchClose(&report);
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,194 @@
+/*******************************************************************************
+  @file     hsm_test.c
+  @brief    Host test of the Hierarchical State Machine, the order of the exit,
+            transition and entry actions, and the errors of hsmBuild()
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lib/hsm/hsm.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define STATES				5
+#define EVENTS_COUNT		7
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+// Entry and exit actions of a state, which log its name
+#define STATE_ACTIONS(name)	static void enter_##name(void* event) { logAction("+" #name); }	\
+							static void exit_##name(void* event) { logAction("-" #name); }
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+enum {
+	EVENT_NEXT,				// Between the children of a, NULL action from a2
+	EVENT_TO_B,				// Handled by a, for its children
+	EVENT_TO_A,				// From b to a, entering its initial child
+	EVENT_SELF,				// Self-transition of a, from its children
+	EVENT_SELF_B,			// Self-transition of b, with a NULL action
+	EVENT_INTERNAL,			// Internal transition of top
+	EVENT_INTERNAL_NULL		// Internal transition of top, with a NULL action
+};
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static char			actionsLog[256];	// Actions run, separated by spaces
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+static void logAction(const char* name)
+{
+	size_t length = strlen(actionsLog);
+	snprintf(actionsLog + length, sizeof(actionsLog) - length, "%s%s", length ? " " : "", name);
+}
+
+static void onTransition(void* event)
+{
+	logAction(">t");
+}
+
+static void onInternal(void* event)
+{
+	logAction(">i");
+}
+
+STATE_ACTIONS(top)
+STATE_ACTIONS(a)
+STATE_ACTIONS(a1)
+STATE_ACTIONS(a2)
+STATE_ACTIONS(b)
+
+// top
+// ├── a (initial)
+// │   ├── a1 (initial)
+// │   └── a2
+// └── b
+static const hsm_state_t top, a, a1, a2, b;
+
+static const hsm_edge_t topEdges[] = {
+	{	EVENT_INTERNAL,			HSM_INTERNAL,	onInternal		},
+	{	EVENT_INTERNAL_NULL,	HSM_INTERNAL,	NULL			},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t aEdges[] = {
+	{	EVENT_TO_B,				&b,				onTransition	},
+	{	EVENT_SELF,				&a,				onTransition	},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t a1Edges[] = {
+	{	EVENT_NEXT,				&a2,			onTransition	},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t a2Edges[] = {
+	{	EVENT_NEXT,				&a1,			NULL			},
+	HSM_END_OF_EDGES
+};
+static const hsm_edge_t bEdges[] = {
+	{	EVENT_TO_A,				&a,				onTransition	},
+	{	EVENT_SELF_B,			&b,				NULL			},
+	HSM_END_OF_EDGES
+};
+
+static const hsm_state_t top = { NULL, &a, enter_top, exit_top, topEdges };
+static const hsm_state_t a = { &top, &a1, enter_a, exit_a, aEdges };
+static const hsm_state_t a1 = { &a, NULL, enter_a1, exit_a1, a1Edges };
+static const hsm_state_t a2 = { &a, NULL, enter_a2, exit_a2, a2Edges };
+static const hsm_state_t b = { &top, NULL, enter_b, exit_b, bEdges };
+
+static const hsm_state_t* const states[STATES] = { &top, &a, &a1, &a2, &b };
+
+static hsm_entry_t	table[HSM_TABLE_SIZE(STATES, EVENTS_COUNT)];
+static hsm_path_t	paths[STATES];
+
+// Dispatches the event, then the actions run must be the expected ones, in order,
+// and the machine must be in the given state
+static void dispatch(hsm_t* hsm, event_id_t event, const char* expectedLog, uint16_t expectedState)
+{
+	actionsLog[0] = '\0';
+	hsmDispatch(hsm, &event);
+	if (strcmp(actionsLog, expectedLog) != 0)
+	{
+		printf("FAIL: event %u ran \"%s\" instead of \"%s\"\n", event, actionsLog, expectedLog);
+		exit(EXIT_FAILURE);
+	}
+	CHECK(hsm->current == expectedState);
+}
+
+int main(void)
+{
+	hsm_t hsm;
+
+	CHECK(hsmBuild(&hsm, states, STATES, EVENTS_COUNT, table, paths));
+
+	// The start goes down through the initial children, entering from the top
+	hsmStart(&hsm, 0);
+	CHECK(strcmp(actionsLog, "+top +a +a1") == 0);
+	CHECK(hsm.current == 2 && HSM_IS_IN_STATE(&hsm, 1) && HSM_IS_IN_STATE(&hsm, 0) && !HSM_IS_IN_STATE(&hsm, 4));
+
+	// Between siblings only the leaves are exited and entered, the exit runs
+	// before the action and the entry after it, also with a NULL action
+	dispatch(&hsm, EVENT_NEXT, "-a1 >t +a2", 3);
+	dispatch(&hsm, EVENT_NEXT, "-a2 +a1", 2);
+
+	// Handled by the parent, exiting up to the common ancestor
+	dispatch(&hsm, EVENT_TO_B, "-a1 -a >t +b", 4);
+	dispatch(&hsm, EVENT_NEXT, "", 4);
+
+	// Self-transition of a leaf, exited and entered again
+	dispatch(&hsm, EVENT_SELF_B, "-b +b", 4);
+
+	// The target has children, the initial ones are entered down to a leaf
+	dispatch(&hsm, EVENT_TO_A, "-b >t +a +a1", 2);
+
+	// Self-transition of a parent from a child, both exited and entered again
+	dispatch(&hsm, EVENT_NEXT, "-a1 >t +a2", 3);
+	dispatch(&hsm, EVENT_SELF, "-a2 -a >t +a +a1", 2);
+
+	// Internal transitions of the top, only the action runs, also without it
+	dispatch(&hsm, EVENT_INTERNAL, ">i", 2);
+	dispatch(&hsm, EVENT_INTERNAL_NULL, "", 2);
+	dispatch(&hsm, EVENT_TO_A, "", 2);
+	dispatch(&hsm, EVENTS_COUNT + 10, "", 2);
+
+	// A chain as deep as HSM_MAX_DEPTH is built, one more level is not
+	static hsm_state_t deep[HSM_MAX_DEPTH + 1];
+	static const hsm_state_t* deepStates[HSM_MAX_DEPTH + 1];
+	static hsm_entry_t deepTable[HSM_TABLE_SIZE(HSM_MAX_DEPTH + 1, 1)];
+	static hsm_path_t deepPaths[HSM_MAX_DEPTH + 1];
+	for (size_t i = 0 ; i <= HSM_MAX_DEPTH ; i++)
+	{
+		deep[i] = (hsm_state_t){ i ? &deep[i - 1] : NULL, NULL, NULL, NULL, NULL };
+		deepStates[i] = &deep[i];
+	}
+	CHECK(hsmBuild(&hsm, deepStates, HSM_MAX_DEPTH, 1, deepTable, deepPaths));
+	CHECK(deepPaths[HSM_MAX_DEPTH - 1].depth == HSM_MAX_DEPTH);
+	CHECK(!hsmBuild(&hsm, deepStates, HSM_MAX_DEPTH + 1, 1, deepTable, deepPaths));
+
+	// A parent or a target missing from the array of states
+	static const hsm_state_t* const withoutTop[] = { &a, &a1, &a2, &b };
+	static const hsm_state_t* const withoutB[] = { &top, &a, &a1, &a2 };
+	CHECK(!hsmBuild(&hsm, withoutTop, 4, EVENTS_COUNT, table, paths));
+	CHECK(!hsmBuild(&hsm, withoutB, 4, EVENTS_COUNT, table, paths));
+
+	printf("Actions run in order, from the parents, internal and self transitions\n");
+
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,167 @@
+/*******************************************************************************
+  @file     isr_profiler_test.c
+  @brief    Host test of the ISR profiler, with the cycle counter run by the
+            test, the reset requests, the registry and the dump
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// The cycle counter of the profiler is the one of the test
+static uint32_t		cycleCounter;
+#define ISR_PROFILER_CYCLES()	(cycleCounter)
+
+#include "lib/isr_profiler/isr_profiler.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define DUMP_NAME_MAX_SIZE	34			// Longest name of a line of the dump, with four numbers of 10 digits
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static isr_profile_t	profiles[ISR_PROFILER_MAX_REGISTERED + 1];
+static char				dump[4096];			// Lines written by the dump
+static size_t			dumpLength;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Routine profiled, which takes the given cycles
+static void routine(isr_profile_t* profile, uint32_t cycles)
+{
+	ISR_PROFILE_BEGIN();
+	cycleCounter += cycles;
+	ISR_PROFILE_END(profile);
+}
+
+static void writer(const char* text, size_t length)
+{
+	CHECK(dumpLength + length < sizeof(dump));
+	memcpy(dump + dumpLength, text, length);
+	dumpLength += length;
+	dump[dumpLength] = '\0';
+}
+
+static isr_profile_snapshot_t snapshot(size_t index, bool reset)
+{
+	isr_profile_snapshot_t figures;
+	CHECK(isrProfilerSnapshot(index, &figures, reset));
+	return figures;
+}
+
+int main(void)
+{
+	isr_profile_snapshot_t figures;
+
+	// Figures of the calls, the counter wraps during one of them
+	CHECK(isrProfilerRegister("uart", &profiles[0]) && isrProfilerCount() == 1);
+	figures = snapshot(0, false);
+	CHECK(figures.count == 0 && figures.min == 0 && figures.mean == 0 && figures.max == 0);
+	cycleCounter = 0xFFFFFFF0UL;
+	routine(&profiles[0], 100);
+	routine(&profiles[0], 40);
+	routine(&profiles[0], 400);
+	figures = snapshot(0, false);
+	CHECK(strcmp(figures.name, "uart") == 0);
+	CHECK(figures.count == 3 && figures.min == 40 && figures.mean == 180 && figures.max == 400);
+
+	// The total of the calls goes over 32 bits, the mean is still exact
+	for (uint32_t i = 0 ; i < 5 ; i++)
+	{
+		routine(&profiles[0], 0xFFFFFF00UL);
+	}
+	CHECK(profiles[0].total == 540 + 5 * 0xFFFFFF00ULL);
+	figures = snapshot(0, false);
+	CHECK(figures.count == 8 && figures.min == 40 && figures.max == 0xFFFFFF00UL);
+	CHECK(figures.mean == (uint32_t)((540 + 5 * 0xFFFFFF00ULL) / 8));
+
+	// The reset requested by a snapshot, the figures are copied before it, and
+	// read as zeros until the routine runs again and clears them
+	figures = snapshot(0, true);
+	CHECK(figures.count == 8 && profiles[0].resetRequested);
+	figures = snapshot(0, false);
+	CHECK(figures.count == 0 && figures.min == 0 && figures.mean == 0 && figures.max == 0);
+	CHECK(profiles[0].count == 8);
+	routine(&profiles[0], 7);
+	CHECK(!profiles[0].resetRequested && profiles[0].total == 7);
+	figures = snapshot(0, false);
+	CHECK(figures.count == 1 && figures.min == 7 && figures.mean == 7 && figures.max == 7);
+
+	// The reset of every profile, the minimum and maximum start again
+	CHECK(isrProfilerRegister("systick", &profiles[1]) && isrProfilerCount() == 2);
+	routine(&profiles[1], 1000);
+	isrProfilerReset();
+	CHECK(profiles[0].resetRequested && profiles[1].resetRequested);
+	routine(&profiles[1], 2000);
+	figures = snapshot(1, false);
+	CHECK(figures.count == 1 && figures.min == 2000 && figures.max == 2000);
+
+	// Registering the same profile again only renames it
+	CHECK(isrProfilerRegister("systick.00", &profiles[1]) && isrProfilerCount() == 2);
+	figures = snapshot(1, false);
+	CHECK(strcmp(figures.name, "systick.00") == 0 && figures.count == 1);
+
+	// The registry full, the profiles registered can still be renamed
+	for (size_t i = 2 ; i < ISR_PROFILER_MAX_REGISTERED ; i++)
+	{
+		CHECK(isrProfilerRegister("gpio", &profiles[i]));
+	}
+	CHECK(isrProfilerCount() == ISR_PROFILER_MAX_REGISTERED);
+	CHECK(!isrProfilerRegister("extra", &profiles[ISR_PROFILER_MAX_REGISTERED]));
+	CHECK(isrProfilerCount() == ISR_PROFILER_MAX_REGISTERED);
+	CHECK(isrProfilerRegister("uart.0", &profiles[0]));
+	CHECK(!isrProfilerSnapshot(ISR_PROFILER_MAX_REGISTERED, &figures, false));
+
+	// The dump, a line for each profile, with the names too long truncated so
+	// the line fits even with the largest numbers
+	static const char longName[] = "a_very_long_name_of_an_interrupt_service_routine";
+	CHECK(isrProfilerRegister(longName, &profiles[2]));
+	routine(&profiles[2], 0xFFFFFFFFUL);
+	routine(&profiles[3], 12);
+	routine(&profiles[3], 30);
+	isrProfilerDump(writer, true);
+
+	char expected[256];
+	char* line = dump;
+	CHECK(strncmp(line, "name,count,min,mean,max\r\n", 25) == 0);
+	line += 25;
+	CHECK(strncmp(line, "uart.0,0,0,0,0\r\n", 16) == 0);
+	line += 16;
+	CHECK(strncmp(line, "systick.00,1,2000,2000,2000\r\n", 29) == 0);
+	line += 29;
+	snprintf(expected, sizeof(expected), "%.*s,1,4294967295,4294967295,4294967295\r\n", DUMP_NAME_MAX_SIZE, longName);
+	CHECK(strncmp(line, expected, strlen(expected)) == 0);
+	line += strlen(expected);
+	CHECK(strncmp(line, "gpio,2,12,21,30\r\n", 17) == 0);
+	line += 17;
+	for (size_t i = 4 ; i < ISR_PROFILER_MAX_REGISTERED ; i++)
+	{
+		CHECK(strncmp(line, "gpio,0,0,0,0\r\n", 14) == 0);
+		line += 14;
+	}
+	CHECK(*line == '\0');
+
+	// Reset by the dump
+	figures = snapshot(3, false);
+	CHECK(figures.count == 0);
+
+	printf("Figures of the calls, resets, registry and dump of the profiles\n");
+
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,238 @@
+/*******************************************************************************
+  @file     lib_bench.c
+  @brief    Host benchmark suite of lib/, queue, event_queue, fsm, general and array
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "lib/array/array.h"
+#include "lib/event_queue/event_queue.h"
+#include "lib/fsm/fsm.h"
+#include "lib/general/general.h"
+#include "lib/queue/queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define QUEUE_SIZE			32
+#define QUEUE_OPERATIONS	4000000UL
+#define EVENT_CALLS			2000000UL
+#define FSM_CYCLES			2000000UL
+#define NUMBER_CALLS		4000000UL
+#define MAX_EDGES			64
+#define MAX_ELEMENT_SIZE	64
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+typedef struct {
+	event_id_t	id;
+} bench_event_t;
+
+// Patterns of the queue, which change how often the indexes wrap around
+typedef enum {
+	PATTERN_PING_PONG,		// One push and one pop, the queue has at most one element
+	PATTERN_FILL_DRAIN,		// Fills the queue and then drains it
+	PATTERN_HALF_FULL,		// One push and one pop with the queue always half full
+	PATTERN_COUNT
+} queue_pattern_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const char*		patternNames[PATTERN_COUNT] = { "ping_pong", "fill_drain", "half_full" };
+static uint8_t			queueBuffer[QUEUE_SIZE * MAX_ELEMENT_SIZE];
+static uint8_t			element[MAX_ELEMENT_SIZE];
+static bench_event_t	eventBuffer[QUEUE_SIZE];
+static edge_t			edges[MAX_EDGES + 1];
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Returns the nanoseconds of each push and pop pair
+static double queueRun(size_t elementSize, queue_pattern_t pattern)
+{
+	queue_t queue = createQueue(queueBuffer, QUEUE_SIZE, elementSize);
+	size_t batch = pattern == PATTERN_FILL_DRAIN ? QUEUE_SIZE - 1 : 1;
+	void* out = NULL;
+
+	if (pattern == PATTERN_HALF_FULL)
+	{
+		for (size_t i = 0 ; i < QUEUE_SIZE / 2 ; i++)
+		{
+			push(&queue, element);
+		}
+	}
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < QUEUE_OPERATIONS ; n += batch)
+	{
+		for (size_t i = 0 ; i < batch ; i++)
+		{
+			push(&queue, element);
+		}
+		for (size_t i = 0 ; i < batch ; i++)
+		{
+			out = pop(&queue);
+		}
+	}
+	BENCH_KEEP(out);
+	return (benchNow() - start) / QUEUE_OPERATIONS;
+}
+
+static void* idleGenerator(void)
+{
+	return NO_EVENTS;
+}
+
+// Returns the nanoseconds of each getNextEvent(), polling the given amount of
+// generators which have no events, with or without an event posted before
+static double eventRun(uint8_t generators, bool posted)
+{
+	event_queue_t queue = createEventQueue(eventBuffer, QUEUE_SIZE, sizeof(bench_event_t));
+	bench_event_t event = { 1 };
+	void* next = NULL;
+
+	for (uint8_t i = 0 ; i < generators ; i++)
+	{
+		registerEventGenerator(&queue, idleGenerator, EVENT_PRIORITY_DEFAULT);
+	}
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < EVENT_CALLS ; n++)
+	{
+		if (posted)
+		{
+			postEvent(&queue, &event);
+		}
+		next = getNextEvent(&queue);
+	}
+	BENCH_KEEP(next);
+	return (benchNow() - start) / EVENT_CALLS;
+}
+
+// Returns the nanoseconds of each fsmCycle() in a state with the given amount
+// of edges, for the event of the last edge or for the default edge
+static double fsmRun(size_t count, bool defaultEdge)
+{
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		edges[i] = (edge_t){ i, edges, DO_NOTHING };
+	}
+	edges[count] = (edge_t)DEFAULT_NO_ACTION_EDGE(edges);
+
+	state_t state = edges;
+	bench_event_t event = { defaultEdge ? MAX_EDGES : count - 1 };
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < FSM_CYCLES ; n++)
+	{
+		fsmCycle(&state, &event);
+		BENCH_KEEP(state);
+	}
+	return (benchNow() - start) / FSM_CYCLES;
+}
+
+// Returns the nanoseconds of each conversion of a number of the given digits
+static double numberRun(uint8_t digits, bool toArray)
+{
+	uint8_t array[10];
+	uint32_t number = 0;
+
+	for (uint8_t i = 0 ; i < digits ; i++)
+	{
+		number = number * 10 + 9 - i;
+	}
+	number2Array(number, array, digits, NULL);
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < NUMBER_CALLS ; n++)
+	{
+		if (toArray)
+		{
+			number2Array(number + (n & 1), array, digits, NULL);
+			BENCH_KEEP(array[0]);
+		}
+		else
+		{
+			number = array2Number(array, digits);
+			BENCH_KEEP(number);
+		}
+	}
+	return (benchNow() - start) / NUMBER_CALLS;
+}
+
+// Returns the nanoseconds of each arrayRemove() of the first element,
+// the worst case, moving every other element
+static double arrayRun(size_t elements)
+{
+	uint32_t* array = calloc(elements, sizeof(uint32_t));
+	size_t calls = (1UL << 28) / elements / sizeof(uint32_t);
+	calls = calls < 16 ? 16 : calls;
+
+	double start = benchNow();
+	for (size_t n = 0 ; n < calls ; n++)
+	{
+		arrayRemove(array, 0, elements, sizeof(uint32_t));
+		BENCH_KEEP(array[0]);
+	}
+	double elapsed = (benchNow() - start) / calls;
+	free(array);
+	return elapsed;
+}
+
+int main(int argc, char* argv[])
+{
+	bench_report_t report = benchOpen(argc > 1 ? argv[1] : NULL);
+	static const size_t elementSizes[] = { 1, 4, 16, 64 };
+	static const size_t edgeCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+	static const size_t arraySizes[] = { 1024, 16384, 262144, 1048576 };
+
+	for (size_t p = 0 ; p < PATTERN_COUNT ; p++)
+	{
+		for (size_t s = 0 ; s < sizeof(elementSizes) / sizeof(elementSizes[0]) ; s++)
+		{
+			char name[32];
+			snprintf(name, sizeof(name), "push_pop_%s", patternNames[p]);
+			benchRecord(&report, "queue", name, elementSizes[s], queueRun(elementSizes[s], p), "ns/pair");
+		}
+	}
+
+	for (uint8_t generators = 1 ; generators <= MAX_EVENT_GENERATORS ; generators++)
+	{
+		benchRecord(&report, "event_queue", "getNextEvent_idle", generators, eventRun(generators, false), "ns/call");
+		benchRecord(&report, "event_queue", "postEvent_getNextEvent", generators, eventRun(generators, true), "ns/call");
+	}
+
+	for (size_t e = 0 ; e < sizeof(edgeCounts) / sizeof(edgeCounts[0]) ; e++)
+	{
+		benchRecord(&report, "fsm", "fsmCycle_last_edge", edgeCounts[e], fsmRun(edgeCounts[e], false), "ns/cycle");
+		benchRecord(&report, "fsm", "fsmCycle_default_edge", edgeCounts[e], fsmRun(edgeCounts[e], true), "ns/cycle");
+	}
+
+	for (uint8_t digits = 1 ; digits <= 9 ; digits += 4)
+	{
+		benchRecord(&report, "general", "number2Array", digits, numberRun(digits, true), "ns/call");
+		benchRecord(&report, "general", "array2Number", digits, numberRun(digits, false), "ns/call");
+	}
+
+	for (size_t a = 0 ; a < sizeof(arraySizes) / sizeof(arraySizes[0]) ; a++)
+	{
+		benchRecord(&report, "array", "arrayRemove_first", arraySizes[a], arrayRun(arraySizes[a]) / 1000, "us/call");
+	}
+
+	benchClose(&report);
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,194 @@
+/*******************************************************************************
+  @file     port_isfr_test.c
+  @brief    Host test of the dispatch of the port interrupts, injecting ISFR
+            patterns in fake registers
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "MK64F12.h"
+#include "drivers/MCAL/gpio/gpio.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define PATTERNS		20000
+#define PLAIN_PIN		7			// Pin with a callback without context
+#define FREE_PIN		13			// Pin in an interrupt mode without callback, only its edges are counted
+#define ENABLE_PIN		5			// Interrupt pin on the same port as a pin requesting the DMA
+#define CLK_PIN			6
+#define BENCH_CALLS		5000000UL
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+GPIO_Type	fakeGpio[5];
+PORT_Type	fakePort[5];
+SIM_Type	fakeSim;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint8_t		calls[32];			// Pins called back in the last dispatch, in order
+static uint8_t		callsCount;
+static uint32_t		plainCalls;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Dispatcher of the port interrupts, called by each PORTx_IRQHandler()
+void portHandler(uint8_t port);
+
+static void contextCallback(void* context)
+{
+	calls[callsCount++] = (uint8_t)(uintptr_t)context;
+}
+
+static void plainCallback(void)
+{
+	plainCalls++;
+}
+
+static void emptyCallback(void* context)
+{
+	(void)context;
+}
+
+int main(void)
+{
+	uint32_t expectedEdges[32] = { 0 };
+	uint32_t expectedPlain = 0;
+	uint32_t seed = 1;
+
+	for (uint8_t pin = 0 ; pin < 32 ; pin++)
+	{
+		if (pin == PLAIN_PIN)
+		{
+			gpioIRQ(PORTNUM2PIN(PC, pin), GPIO_IRQ_MODE_INTERRUPT_FALLING_EDGE, plainCallback);
+		}
+		else if (pin != FREE_PIN)
+		{
+			CHECK(gpioIRQContext(PORTNUM2PIN(PC, pin), GPIO_IRQ_MODE_INTERRUPT_BOTH_EDGES, contextCallback, (void*)(uintptr_t)pin));
+		}
+		else
+		{
+			gpioIRQMode(PORTNUM2PIN(PC, pin), GPIO_IRQ_MODE_INTERRUPT_BOTH_EDGES);
+		}
+		CHECK((fakePort[PC].PCR[pin] & PORT_PCR_IRQC_MASK) == PORT_PCR_IRQC(pin == PLAIN_PIN ? GPIO_IRQ_MODE_INTERRUPT_FALLING_EDGE : GPIO_IRQ_MODE_INTERRUPT_BOTH_EDGES));
+	}
+
+	// Edge cases first, then pseudo random patterns with any amount of bits
+	for (uint32_t k = 0 ; k < PATTERNS ; k++)
+	{
+		static const uint32_t edges[] = { 0, 0xFFFFFFFF, 0x80000001, 1UL << PLAIN_PIN, 1UL << FREE_PIN, 0x80000000 };
+		seed = seed * 1103515245 + 12345;
+		uint32_t random = seed;
+		seed = seed * 1103515245 + 12345;
+		uint32_t isfr = k < sizeof(edges) / sizeof(edges[0]) ? edges[k] : random & (seed | (seed >> 7));
+
+		fakePort[PC].ISFR = isfr;
+		callsCount = 0;
+		portHandler(PC);
+
+		// The fake register keeps the value written, which must be exactly the
+		// flags read, so flags raised after the read are not cleared
+		CHECK(fakePort[PC].ISFR == isfr);
+
+		// Every pin with a flag is called back once, from the lowest one
+		uint8_t expected = 0;
+		for (uint8_t pin = 0 ; pin < 32 ; pin++)
+		{
+			if (isfr & (1UL << pin))
+			{
+				expectedEdges[pin]++;
+				if (pin == PLAIN_PIN)
+				{
+					expectedPlain++;
+				}
+				else if (pin != FREE_PIN)
+				{
+					CHECK(expected < callsCount && calls[expected] == pin);
+					expected++;
+				}
+			}
+		}
+		CHECK(callsCount == expected);
+	}
+
+	for (uint8_t pin = 0 ; pin < 32 ; pin++)
+	{
+		CHECK(gpioIRQEdges(PORTNUM2PIN(PC, pin)) == expectedEdges[pin]);
+	}
+	CHECK(plainCalls == expectedPlain);
+
+	// Other ports are not touched by the dispatch of PORTC
+	for (uint8_t port = 0 ; port < GPIO_PORT_COUNT ; port++)
+	{
+		CHECK(port == PC || fakePort[port].ISFR == 0);
+	}
+	printf("%d ISFR patterns dispatched in order, edges counted\n", PATTERNS);
+
+	// A pin requesting the DMA on the same port as an interrupt pin, as the
+	// clock and the enable of the magnetic reader. Its flag is neither cleared,
+	// which would drop its DMA request, nor dispatched.
+	CHECK(gpioIRQContext(PORTNUM2PIN(PB, ENABLE_PIN), GPIO_IRQ_MODE_INTERRUPT_BOTH_EDGES, contextCallback, (void*)ENABLE_PIN));
+	gpioIRQ(PORTNUM2PIN(PB, CLK_PIN), GPIO_IRQ_MODE_INTERRUPT_FALLING_EDGE, plainCallback);
+	gpioIRQMode(PORTNUM2PIN(PB, CLK_PIN), GPIO_IRQ_MODE_DMA_FALLING_EDGE);
+	CHECK((fakePort[PB].PCR[CLK_PIN] & PORT_PCR_IRQC_MASK) == PORT_PCR_IRQC(GPIO_IRQ_MODE_DMA_FALLING_EDGE));
+	fakePort[PB].ISFR = (1UL << ENABLE_PIN) | (1UL << CLK_PIN);
+	callsCount = 0;
+	plainCalls = 0;
+	portHandler(PB);
+	CHECK(fakePort[PB].ISFR == 1UL << ENABLE_PIN);
+	CHECK(callsCount == 1 && calls[0] == ENABLE_PIN && plainCalls == 0);
+	CHECK(gpioIRQEdges(PORTNUM2PIN(PB, CLK_PIN)) == 0);
+
+	// Back to an interrupt mode, its callback is kept, then disabled
+	gpioIRQMode(PORTNUM2PIN(PB, CLK_PIN), GPIO_IRQ_MODE_INTERRUPT_FALLING_EDGE);
+	fakePort[PB].ISFR = 1UL << CLK_PIN;
+	portHandler(PB);
+	CHECK(fakePort[PB].ISFR == 1UL << CLK_PIN && plainCalls == 1);
+	gpioIRQ(PORTNUM2PIN(PB, CLK_PIN), GPIO_IRQ_MODE_DISABLE, NULL);
+	CHECK((fakePort[PB].PCR[CLK_PIN] & PORT_PCR_IRQC_MASK) == 0);
+	fakePort[PB].ISFR = 1UL << CLK_PIN;
+	portHandler(PB);
+	CHECK(fakePort[PB].ISFR == 0 && plainCalls == 1);
+
+	// Cost of the dispatch, which only depends on the amount of flags set
+	bench_report_t report = benchOpen(NULL);
+	for (uint8_t pin = 0 ; pin < 32 ; pin++)
+	{
+		gpioIRQContext(PORTNUM2PIN(PD, pin), GPIO_IRQ_MODE_INTERRUPT_BOTH_EDGES, emptyCallback, NULL);
+	}
+	static const uint32_t benchPatterns[] = { 0x00000001, 0x80000000, 0x00010001, 0xFFFFFFFF };
+	for (size_t i = 0 ; i < sizeof(benchPatterns) / sizeof(benchPatterns[0]) ; i++)
+	{
+		double start = benchNow();
+		for (uint32_t n = 0 ; n < BENCH_CALLS ; n++)
+		{
+			fakePort[PD].ISFR = benchPatterns[i];
+			portHandler(PD);
+		}
+		char name[32];
+		snprintf(name, sizeof(name), "isfr_0x%08x", benchPatterns[i]);
+		benchRecord(&report, "gpio", name, __builtin_popcount(benchPatterns[i]), (benchNow() - start) / BENCH_CALLS, "ns/irq");
+	}
+	benchClose(&report);
+
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
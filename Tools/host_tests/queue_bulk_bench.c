@@ -0,0 +1,156 @@
+/*******************************************************************************
+  @file     queue_bulk_bench.c
+  @brief    Host benchmark of the bulk pushMany() against a push() per byte,
+            of the queue_t, spsc_queue_t and the typed queues
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+
+#include "bench.h"
+#include "lib/queue/queue.h"
+#include "lib/spsc_queue/spsc_queue.h"
+#include "lib/typed_queue/typed_queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define QUEUE_SIZE		128		// Same as the UART queues
+#define BYTES			20000000UL
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Typed queue of the same capacity, as declared by the UART driver
+DECLARE_QUEUE(byteQueue, uint8_t, QUEUE_SIZE)
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static const size_t	lengths[] = { 1, 2, 4, 8, 16, 32, 50, 64, 100 };
+static uint8_t		buffer[QUEUE_SIZE];
+static uint8_t		message[100];
+static uint8_t		drain[QUEUE_SIZE];
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Writes messages of the given length as the UART writer did before, one push()
+// per byte, or with pushMany(), draining the queue in between so the messages
+// wrap around the buffer at every offset. Returns the bytes per microsecond.
+static double queueRun(size_t length, bool bulk)
+{
+	queue_t queue = createQueue(buffer, QUEUE_SIZE, sizeof(uint8_t));
+	size_t messages = BYTES / length;
+	double start = benchNow();
+
+	for (size_t m = 0 ; m < messages ; m++)
+	{
+		if (bulk)
+		{
+			pushMany(&queue, message, length);
+		}
+		else
+		{
+			for (size_t i = 0 ; i < length ; i++)
+			{
+				push(&queue, &message[i]);
+			}
+		}
+		popMany(&queue, drain, length);
+	}
+
+	BENCH_KEEP(drain[0]);
+	return messages * length / ((benchNow() - start) / 1000);
+}
+
+static double spscRun(size_t length, bool bulk)
+{
+	spsc_queue_t queue = createSpscQueue(buffer, QUEUE_SIZE, sizeof(uint8_t));
+	size_t messages = BYTES / length;
+	double start = benchNow();
+
+	for (size_t m = 0 ; m < messages ; m++)
+	{
+		if (bulk)
+		{
+			spscPushMany(&queue, message, length);
+		}
+		else
+		{
+			for (size_t i = 0 ; i < length ; i++)
+			{
+				spscPush(&queue, &message[i]);
+			}
+		}
+		spscPopMany(&queue, drain, length);
+	}
+
+	BENCH_KEEP(drain[0]);
+	return messages * length / ((benchNow() - start) / 1000);
+}
+
+static double typedRun(size_t length, bool bulk)
+{
+	static byteQueue_t queue;
+	size_t messages = BYTES / length;
+
+	byteQueueInit(&queue);
+	double start = benchNow();
+
+	for (size_t m = 0 ; m < messages ; m++)
+	{
+		if (bulk)
+		{
+			byteQueuePushMany(&queue, message, length);
+		}
+		else
+		{
+			for (size_t i = 0 ; i < length ; i++)
+			{
+				byteQueuePush(&queue, message[i]);
+			}
+		}
+		byteQueuePopMany(&queue, drain, length);
+	}
+
+	BENCH_KEEP(drain[0]);
+	return messages * length / ((benchNow() - start) / 1000);
+}
+
+int main(int argc, char* argv[])
+{
+	bench_report_t report = benchOpen(argc > 1 ? argv[1] : NULL);
+
+	for (size_t i = 0 ; i < sizeof(lengths) / sizeof(lengths[0]) ; i++)
+	{
+		benchRecord(&report, "queue", "push", lengths[i], queueRun(lengths[i], false), "bytes/us");
+		benchRecord(&report, "queue", "pushMany", lengths[i], queueRun(lengths[i], true), "bytes/us");
+		benchRecord(&report, "spsc_queue", "spscPush", lengths[i], spscRun(lengths[i], false), "bytes/us");
+		benchRecord(&report, "spsc_queue", "spscPushMany", lengths[i], spscRun(lengths[i], true), "bytes/us");
+		benchRecord(&report, "typed_queue", "Push", lengths[i], typedRun(lengths[i], false), "bytes/us");
+		benchRecord(&report, "typed_queue", "PushMany", lengths[i], typedRun(lengths[i], true), "bytes/us");
+	}
+
+	// Memory of each queue of QUEUE_SIZE bytes, the typed queue holds its buffer
+	// while the others point to a separate one
+	benchRecord(&report, "queue", "sizeof", QUEUE_SIZE, sizeof(queue_t), "bytes");
+	benchRecord(&report, "queue", "sizeof+buffer", QUEUE_SIZE, sizeof(queue_t) + sizeof(buffer), "bytes");
+	benchRecord(&report, "spsc_queue", "sizeof", QUEUE_SIZE, sizeof(spsc_queue_t), "bytes");
+	benchRecord(&report, "spsc_queue", "sizeof+buffer", QUEUE_SIZE, sizeof(spsc_queue_t) + sizeof(buffer), "bytes");
+	benchRecord(&report, "typed_queue", "sizeof", QUEUE_SIZE, sizeof(byteQueue_t), "bytes");
+	benchRecord(&report, "typed_queue", "sizeof+buffer", QUEUE_SIZE, sizeof(byteQueue_t), "bytes");
+
+	benchClose(&report);
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,218 @@
+/*******************************************************************************
+  @file     queue_span_test.c
+  @brief    Host unit test of the reserve/commit and peek/release spans, for
+            every start offset, fill level and requested length
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "lib/queue/queue.h"
+#include "lib/spsc_queue/spsc_queue.h"
+#include "lib/typed_queue/typed_queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define SLOTS		8
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+DECLARE_QUEUE(testQueue, uint8_t, SLOTS)
+
+// Adapter of each queue implementation. The model of every implementation is
+// the same: the element number j pushed since the creation lands in the slot
+// (j + first) % SLOTS, and the spans never cross the end of the buffer.
+typedef struct {
+	const char*	name;
+	size_t		capacity;		// Elements that fit, one less than the slots for queue_t
+	size_t		first;			// Slot of the first element pushed
+	uint8_t*	base;			// Buffer of the queue
+	void		(*reset)(void);
+	bool		(*push)(uint8_t element);
+	bool		(*pop)(uint8_t* element);
+	size_t		(*size)(void);
+	size_t		(*reserve)(uint8_t** ptr, size_t maxLen);
+	void		(*commit)(size_t length);
+	size_t		(*peekSpan)(uint8_t** ptr, size_t maxLen);
+	void		(*release)(size_t length);
+} queue_adapter_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint8_t			queueBuffer[SLOTS];
+static queue_t			queue;
+static uint8_t			spscBuffer[SLOTS];
+static spsc_queue_t		spsc;
+static testQueue_t		typed;
+
+/*******************************************************************************
+ * ADAPTERS
+ ******************************************************************************/
+
+static void queueReset(void)								{ queue = createQueue(queueBuffer, SLOTS, sizeof(uint8_t)); }
+static bool queuePush(uint8_t element)						{ return push(&queue, &element); }
+static bool queuePop(uint8_t* element)						{ uint8_t* e = pop(&queue); if (e) *element = *e; return e != NULL; }
+static size_t queueSizeOf(void)								{ return size(&queue); }
+static size_t queueReserveOf(uint8_t** ptr, size_t maxLen)	{ return queueReserve(&queue, (void**)ptr, maxLen); }
+static void queueCommitOf(size_t length)					{ queueCommit(&queue, length); }
+static size_t queuePeekSpanOf(uint8_t** ptr, size_t maxLen)	{ return queuePeekSpan(&queue, (void**)ptr, maxLen); }
+static void queueReleaseOf(size_t length)					{ queueRelease(&queue, length); }
+
+static void spscReset(void)									{ spsc = createSpscQueue(spscBuffer, SLOTS, sizeof(uint8_t)); }
+static bool spscPushOf(uint8_t element)						{ return spscPush(&spsc, &element); }
+static bool spscPopOf(uint8_t* element)						{ return spscPop(&spsc, element); }
+static size_t spscSizeOf(void)								{ return spscSize(&spsc); }
+static size_t spscReserveOf(uint8_t** ptr, size_t maxLen)	{ return spscReserve(&spsc, (void**)ptr, maxLen); }
+static void spscCommitOf(size_t length)						{ spscCommit(&spsc, length); }
+static size_t spscPeekSpanOf(uint8_t** ptr, size_t maxLen)	{ return spscPeekSpan(&spsc, (void**)ptr, maxLen); }
+static void spscReleaseOf(size_t length)					{ spscRelease(&spsc, length); }
+
+static void typedReset(void)								{ testQueueInit(&typed); }
+static bool typedPush(uint8_t element)						{ return testQueuePush(&typed, element); }
+static bool typedPop(uint8_t* element)						{ return testQueuePop(&typed, element); }
+static size_t typedSize(void)								{ return testQueueSize(&typed); }
+static size_t typedReserve(uint8_t** ptr, size_t maxLen)	{ return testQueueReserve(&typed, ptr, maxLen); }
+static void typedCommit(size_t length)						{ testQueueCommit(&typed, length); }
+static size_t typedPeekSpan(uint8_t** ptr, size_t maxLen)	{ return testQueuePeekSpan(&typed, ptr, maxLen); }
+static void typedRelease(size_t length)						{ testQueueRelease(&typed, length); }
+
+static const queue_adapter_t adapters[] = {
+	{ "queue_t",		SLOTS - 1,	1,	queueBuffer,	queueReset,	queuePush,	queuePop,	queueSizeOf,	queueReserveOf,	queueCommitOf,	queuePeekSpanOf,	queueReleaseOf },
+	{ "spsc_queue_t",	SLOTS,		0,	spscBuffer,		spscReset,	spscPushOf,	spscPopOf,	spscSizeOf,		spscReserveOf,	spscCommitOf,	spscPeekSpanOf,		spscReleaseOf },
+	{ "DECLARE_QUEUE",	SLOTS,		0,	typed.buffer,	typedReset,	typedPush,	typedPop,	typedSize,		typedReserve,	typedCommit,	typedPeekSpan,		typedRelease }
+};
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+#define CHECK(condition)																		\
+	do {																						\
+		if (!(condition))																		\
+		{																						\
+			if (failures++ < 10)																\
+			{																					\
+				printf("%s: offset %zu fill %zu want %zu: %s\n", q->name, offset, fill, want, #condition);	\
+			}																					\
+		}																						\
+	} while (0)
+
+// Starts with the given offset and fill level, then the producer writes up to
+// want elements through spans and the consumer reads everything through spans,
+// checking each span against the model and the order of the elements
+static unsigned long testCase(const queue_adapter_t* q, size_t offset, size_t fill, size_t want)
+{
+	unsigned long failures = 0;
+	size_t pushed = 0, popped = 0;
+	uint8_t element;
+
+	q->reset();
+	for ( ; pushed < offset ; pushed++, popped++)
+	{
+		q->push(pushed);
+		q->pop(&element);
+	}
+	for ( ; pushed < offset + fill ; pushed++)
+	{
+		q->push(pushed);
+	}
+
+	// Producer, a span may end at the end of the buffer, so it takes two at most
+	size_t expectedTotal = want < q->capacity - fill ? want : q->capacity - fill;
+	size_t total = 0;
+	for (int spans = 0 ; ; spans++)
+	{
+		uint8_t* ptr;
+		size_t slot = (pushed + q->first) % SLOTS;
+		size_t free = q->capacity - (pushed - popped);
+		size_t expected = want - total;
+		expected = expected < free ? expected : free;
+		expected = expected < SLOTS - slot ? expected : SLOTS - slot;
+
+		size_t length = q->reserve(&ptr, want - total);
+		CHECK(length == expected);
+		CHECK(length == 0 || ptr == q->base + slot);
+		if (length == 0 || length != expected)
+		{
+			break;
+		}
+		for (size_t i = 0 ; i < length ; i++)
+		{
+			ptr[i] = pushed + i;
+		}
+		q->commit(length);
+		pushed += length;
+		total += length;
+		CHECK(spans < 2);
+	}
+	CHECK(total == expectedTotal);
+	CHECK(q->size() == pushed - popped);
+
+	// Consumer, the same with the elements
+	while (pushed != popped && !failures)
+	{
+		uint8_t* ptr;
+		size_t slot = (popped + q->first) % SLOTS;
+		size_t expected = pushed - popped < SLOTS - slot ? pushed - popped : SLOTS - slot;
+
+		size_t length = q->peekSpan(&ptr, SLOTS);
+		CHECK(length == expected);
+		CHECK(length == 0 || ptr == q->base + slot);
+		for (size_t i = 0 ; i < length ; i++)
+		{
+			CHECK(ptr[i] == (uint8_t)(popped + i));
+		}
+		if (length == 0)
+		{
+			break;
+		}
+		q->release(length);
+		popped += length;
+	}
+	CHECK(q->size() == 0);
+	CHECK(q->peekSpan(&(uint8_t*){ NULL }, SLOTS) == 0);
+
+	return failures;
+}
+
+int main(void)
+{
+	unsigned long failures = 0;
+
+	for (size_t a = 0 ; a < sizeof(adapters) / sizeof(adapters[0]) ; a++)
+	{
+		const queue_adapter_t* q = &adapters[a];
+		unsigned long cases = 0, adapterFailures = 0;
+
+		for (size_t offset = 0 ; offset < SLOTS ; offset++)
+		{
+			for (size_t fill = 0 ; fill <= q->capacity ; fill++)
+			{
+				for (size_t want = 0 ; want <= SLOTS + 1 ; want++)
+				{
+					adapterFailures += testCase(q, offset, fill, want);
+					cases++;
+				}
+			}
+		}
+
+		printf("%-14s %lu cases, %lu failures\n", q->name, cases, adapterFailures);
+		failures += adapterFailures;
+	}
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/******************************************************************************/
@@ -0,0 +1,183 @@
+/*******************************************************************************
+  @file     spsc_queue_stress.c
+  @brief    Host stress test of the SPSC queue, a producer and a consumer thread
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lib/spsc_queue/spsc_queue.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CAPACITY		64
+#define ELEMENTS		4000000UL
+#define BATCH			13			// Not a divisor of the capacity, so the batches wrap everywhere
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint32_t		buffer[CAPACITY];
+static spsc_queue_t	queue;
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Pushes the sequence, rotating between the single, bulk and span producers
+static void* producer(void* arg)
+{
+	uint32_t next = 0;
+	(void)arg;
+
+	while (next < ELEMENTS)
+	{
+		// Gives the consumer a chance when the queue is full, even on a single core
+		if (spscIsFull(&queue))
+		{
+			sched_yield();
+		}
+
+		switch (next % 3)
+		{
+			case 0:
+				next += spscPush(&queue, &next) ? 1 : 0;
+				break;
+
+			case 1:
+			{
+				uint32_t batch[BATCH];
+				for (uint32_t i = 0 ; i < BATCH ; i++)
+				{
+					batch[i] = next + i;
+				}
+				next += spscPushMany(&queue, batch, ELEMENTS - next < BATCH ? ELEMENTS - next : BATCH);
+				break;
+			}
+
+			default:
+			{
+				void* span;
+				size_t length = spscReserve(&queue, &span, BATCH);
+				for (size_t i = 0 ; i < length && next + i < ELEMENTS ; i++)
+				{
+					((uint32_t*)span)[i] = next + i;
+				}
+				length = ELEMENTS - next < length ? ELEMENTS - next : length;
+				spscCommit(&queue, length);
+				next += length;
+				break;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+// Pops the sequence, rotating between the single, bulk and span consumers,
+// and counts every element out of order
+static void* consumer(void* arg)
+{
+	uint32_t expected = 0;
+	unsigned long* errors = arg;
+
+	while (expected < ELEMENTS)
+	{
+		uint32_t elements[BATCH];
+		size_t length = 0;
+
+		if (spscIsEmpty(&queue))
+		{
+			sched_yield();
+		}
+
+		switch (expected % 3)
+		{
+			case 0:
+				length = spscPop(&queue, elements) ? 1 : 0;
+				break;
+
+			case 1:
+				length = spscPopMany(&queue, elements, BATCH);
+				break;
+
+			default:
+			{
+				void* span;
+				length = spscPeekSpan(&queue, &span, BATCH);
+				for (size_t i = 0 ; i < length ; i++)
+				{
+					elements[i] = ((uint32_t*)span)[i];
+				}
+				spscRelease(&queue, length);
+				break;
+			}
+		}
+
+		for (size_t i = 0 ; i < length ; i++)
+		{
+			if (elements[i] != expected)
+			{
+				(*errors)++;
+			}
+			expected = elements[i] + 1;
+		}
+	}
+
+	return NULL;
+}
+
+// An invalid capacity must leave an empty queue where every operation fails
+static unsigned long invalidCapacity(void)
+{
+	unsigned long errors = 0;
+	uint32_t element = 1;
+	void* span;
+	spsc_queue_t invalid = createSpscQueue(buffer, 3, sizeof(uint32_t));
+
+	errors += !spscIsEmpty(&invalid);
+	errors += spscEmptySize(&invalid) != 0;
+	errors += spscPush(&invalid, &element);
+	errors += spscPop(&invalid, &element);
+	errors += spscPushMany(&invalid, &element, 1) != 0;
+	errors += spscPopMany(&invalid, &element, 1) != 0;
+	errors += spscReserve(&invalid, &span, 1) != 0;
+	errors += spscPeekSpan(&invalid, &span, 1) != 0;
+	return errors;
+}
+
+int main(void)
+{
+	pthread_t producerThread, consumerThread;
+	unsigned long errors = 0;
+
+	queue = createSpscQueue(buffer, CAPACITY, sizeof(uint32_t));
+
+	// Counters start near the overflow, so they wrap during the test
+	queue.front = queue.rear = 0xFFFFFFFFUL - ELEMENTS / 2;
+
+	pthread_create(&consumerThread, NULL, consumer, &errors);
+	pthread_create(&producerThread, NULL, producer, NULL);
+	pthread_join(producerThread, NULL);
+	pthread_join(consumerThread, NULL);
+
+	errors += !spscIsEmpty(&queue);
+	printf("%lu elements through a queue of %d, %lu out of order\n", ELEMENTS, CAPACITY, errors);
+
+	unsigned long invalidErrors = invalidCapacity();
+	printf("invalid capacity: %lu operations did not fail\n", invalidErrors);
+
+	return (errors || invalidErrors) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/******************************************************************************/
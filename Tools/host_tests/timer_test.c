@@ -0,0 +1,307 @@
+/*******************************************************************************
+  @file     timer_test.c
+  @brief    Host test of the timer driver against a reference model, driven by
+            a simulated SysTick, or a simulated PIT in the tickless mode, and
+            cost of the timer ISR
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "drivers/HAL/timer/timer.h"
+#ifdef TIMER_TICKLESS_MODE
+#include "drivers/MCAL/pit/pit.h"
+#endif
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define MODEL_TIMERS		24
+#define MODEL_TICKS			200000UL
+#define MAX_TICKS			(3 * TIMER_WHEEL_SIZE)	// Timers up to three turns of the wheel
+#define BENCH_TICKS			200000UL
+#ifdef TIMER_TICKLESS_MODE
+#define SUITE				"timer_tickless"
+#else
+#define SUITE				"timer"
+#endif
+#define MASK_EVERY			997			// Ticks between windows with the alarm masked
+#define MASK_TICKS			23			// Longest window with the alarm masked
+
+/*******************************************************************************
+ * ENUMERATIONS AND STRUCTURES AND TYPEDEFS
+ ******************************************************************************/
+
+// Expected behaviour of a timer, a timer of zero ticks expires in the next tick,
+// periodic timers are rescheduled from their deadline
+typedef struct {
+	ttick_t		period;
+	ttick_t		deadline;
+	bool		periodic;
+	bool		running;
+} model_timer_t;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static void			(*timerIsr)(void);
+static ttick_t		simulatedTick;
+static uint32_t		callbacks;
+static uint32_t		wakeups;		// Times the timer ISR ran
+static bool			masked;			// Whether the alarm is held off, as with interrupts disabled
+
+#ifdef TIMER_TICKLESS_MODE
+static ttick_t		alarmTick;
+static bool			alarmArmed;
+#endif
+
+static tim_id_t		ids[TIMERS_MAX_CANT];
+static model_timer_t model[MODEL_TIMERS];
+
+/*******************************************************************************
+ * FAKES OF THE DRIVERS USED BY THE TIMER
+ ******************************************************************************/
+
+bool systickInit(void (*funcallback)(void))
+{
+	timerIsr = funcallback;
+	return true;
+}
+
+void hardwareEnableInterrupts(void)		{}
+void hardwareDisableInterrupts(void)	{}
+
+#ifdef TIMER_TICKLESS_MODE
+
+// The time base of the PIT is the simulated tick
+void pitTimebaseInit(uint32_t cyclesPerTick)
+{
+	(void)cyclesPerTick;
+}
+
+uint32_t pitTimebaseTicks(void)
+{
+	return simulatedTick;
+}
+
+void pitAlarmAt(uint32_t tick, pit_callback_t callback)
+{
+	alarmTick = tick;
+	alarmArmed = true;
+	timerIsr = callback;
+}
+
+void pitAlarmStop(void)
+{
+	alarmArmed = false;
+}
+
+#endif
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+static void countCallback(void)
+{
+	callbacks++;
+}
+
+// Advances the simulated time by one tick. The SysTick interrupts every tick,
+// the alarm of the tickless mode only when due, and late while masked.
+// Returns whether the timer ISR ran.
+static bool tick(void)
+{
+	bool serviced = false;
+
+	simulatedTick++;
+#ifdef TIMER_TICKLESS_MODE
+	if (alarmArmed && !masked && (int32_t)(simulatedTick - alarmTick) >= 0)
+	{
+		alarmArmed = false;
+		serviced = true;
+	}
+#else
+	serviced = !masked;
+#endif
+	if (serviced)
+	{
+		wakeups++;
+		timerIsr();
+	}
+	return serviced;
+}
+
+static ttick_t later(ttick_t ticks)
+{
+	return simulatedTick + (ticks ? ticks : 1);
+}
+
+// Random starts, pauses, resumes and restarts from the main loop, between the
+// ticks, and after each tick every timer must have expired as the model says
+static void testModel(void)
+{
+	uint32_t seed = 2024;
+	uint32_t expected = 0;
+#ifdef TIMER_TICKLESS_MODE
+	uint32_t maskLength = 0;
+#endif
+
+	// Every timer gets a callback before being resumed or restarted
+	for (size_t i = 0 ; i < MODEL_TIMERS ; i++)
+	{
+		ids[i] = timerGetId();
+		timerStart(ids[i], 1, TIM_MODE_SINGLESHOT, countCallback);
+		timerPause(ids[i]);
+		model[i] = (model_timer_t){ 1, 0, false, false };
+	}
+
+	for (uint32_t n = 0 ; n < MODEL_TICKS ; n++)
+	{
+		seed = seed * 1103515245 + 12345;
+		if ((seed >> 16) % 4 == 0)
+		{
+			size_t i = (seed >> 8) % MODEL_TIMERS;
+			seed = seed * 1103515245 + 12345;
+			ttick_t ticks = (seed >> 16) % (MAX_TICKS + 1);
+			bool periodic = seed & 0x100;
+			model_timer_t* m = &model[i];
+
+			switch ((seed >> 4) % 4)
+			{
+				case 0:
+					timerStart(ids[i], ticks, periodic ? TIM_MODE_PERIODIC : TIM_MODE_SINGLESHOT, countCallback);
+					*m = (model_timer_t){ ticks, later(ticks), periodic, true };
+					break;
+				case 1:
+					timerPause(ids[i]);
+					m->running = false;
+					break;
+				case 2:
+					timerResume(ids[i]);
+					if (!m->running)
+					{
+						m->deadline = later(m->period);
+						m->running = true;
+					}
+					break;
+				default:
+					timerRestart(ids[i]);
+					m->deadline = later(m->period);
+					m->running = true;
+					break;
+			}
+		}
+
+#ifdef TIMER_TICKLESS_MODE
+		// From time to time the alarm is held off, so the timers due meanwhile
+		// expire late, all of them when the alarm is serviced
+		if (n % MASK_EVERY == 0)
+		{
+			maskLength = (seed >> 20) % (MASK_TICKS + 1);
+		}
+		masked = (n % MASK_EVERY) < maskLength;
+#endif
+		bool serviced = tick();
+
+		for (size_t i = 0 ; i < MODEL_TIMERS ; i++)
+		{
+			model_timer_t* m = &model[i];
+			bool expires = false;
+			while (serviced && m->running && (int32_t)(simulatedTick - m->deadline) >= 0)
+			{
+				expires = true;
+				expected++;
+				m->running = m->periodic;
+				m->deadline += m->period ? m->period : 1;
+			}
+			bool expired = timerExpired(ids[i]);
+			bool running = timerRunning(ids[i]);
+			if (expired != expires || running != m->running)
+			{
+				printf("FAIL: tick %u, timer %zu, expired %d running %d, expected %d %d\n",
+						simulatedTick, i, expired, running, expires, m->running);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+
+	if (callbacks != expected)
+	{
+		printf("FAIL: %u callbacks, expected %u\n", callbacks, expected);
+		exit(EXIT_FAILURE);
+	}
+	printf("%lu ticks, %u expirations of %d timers as the model\n", MODEL_TICKS, expected, MODEL_TIMERS);
+	masked = false;
+
+	for (size_t i = 0 ; i < MODEL_TIMERS ; i++)
+	{
+		timerPause(ids[i]);
+	}
+}
+
+// Cost of each tick of the timer ISR with the given amount of periodic timers,
+// with periods spread from 50 to 1049 ticks, as the usual debouncing, blinking
+// and timeout timers of the applications
+static double tickCost(size_t count, uint32_t* expirations, uint32_t* interrupts)
+{
+	uint32_t before = callbacks;
+	uint32_t wakeupsBefore = wakeups;
+
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		timerStart(ids[i], 50 + (i * 37) % 1000, TIM_MODE_PERIODIC, countCallback);
+	}
+
+	double start = benchNow();
+	for (uint32_t n = 0 ; n < BENCH_TICKS ; n++)
+	{
+		tick();
+	}
+	double elapsed = (benchNow() - start) / BENCH_TICKS;
+
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		timerPause(ids[i]);
+	}
+	*expirations = callbacks - before;
+	*interrupts = wakeups - wakeupsBefore;
+	return elapsed;
+}
+
+int main(void)
+{
+	static const size_t counts[] = { 16, 64, 256 };
+	bench_report_t report = benchOpen(NULL);
+
+	timerInit();
+	testModel();
+
+	for (size_t i = MODEL_TIMERS ; i < TIMERS_MAX_CANT - 1 ; i++)
+	{
+		ids[i] = timerGetId();
+	}
+
+	for (size_t c = 0 ; c < sizeof(counts) / sizeof(counts[0]) ; c++)
+	{
+		uint32_t expirations;
+		uint32_t interrupts;
+		double cost = tickCost(counts[c], &expirations, &interrupts);
+		benchRecord(&report, SUITE, "isr", counts[c], cost, "ns/tick");
+		benchRecord(&report, SUITE, "expirations", counts[c], (double)expirations / BENCH_TICKS, "per tick");
+		benchRecord(&report, SUITE, "wakeups", counts[c], (double)interrupts / BENCH_TICKS, "per tick");
+	}
+
+	benchClose(&report);
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
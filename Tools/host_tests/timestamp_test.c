@@ -0,0 +1,259 @@
+/*******************************************************************************
+  @file     timestamp_test.c
+  @brief    Host test of the timestamp clock on the SysTick, with the counter
+            run by the test on fake registers, reloads between the reads of
+            the driver and reads preempting the SysTick ISR
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core_cm4.h"
+#include "drivers/HAL/timestamp/timestamp.h"
+
+// The driver is included to start its tick count near the wrap of the 32 bits
+// tick processed by the ISR, without running four billion ticks. Its reads of
+// the registers run the counter, and reading CTRL clears the COUNTFLAG.
+static uint32_t readCtrl(void);
+static uint32_t readVal(void);
+
+static struct {
+	uint32_t	ctrl[1];
+	uint32_t	val[1];
+} registersRead;
+
+#undef SysTick
+#define SysTick		(&registersRead)
+#define CTRL		ctrl[readCtrl()]
+#define VAL			val[readVal()]
+#include "drivers/MCAL/systick/systick.c"
+#undef SysTick
+#undef CTRL
+#undef VAL
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define CYCLES_PER_TICK		(CPU_FREQUENCY_HZ / SYSTICK_ISR_FREQUENCY_HZ)
+#define CYCLES_PER_US		(CPU_FREQUENCY_HZ / 1000000UL)
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+SysTick_Type	fakeSysTick;
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint64_t		cycles;				// Cycles run by the counter since initialised
+static uint64_t		tickBase;			// Ticks counted by the driver before the cycles
+static uint32_t		accessCycles;		// Cycles run before each read of the driver
+static bool			pending;			// Whether the SysTick exception is pending
+static uint32_t		calls;				// Calls of the subscriber
+static uint32_t		lastCall;			// Tick of the last call of the subscriber
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+void hardwareDisableInterrupts(void)
+{
+}
+
+void hardwareEnableInterrupts(void)
+{
+}
+
+// The counter goes down to zero, raising the COUNTFLAG and the exception, and
+// is reloaded on the next cycle
+static void runCounter(uint64_t count)
+{
+	for ( ; count ; count--)
+	{
+		if (fakeSysTick.VAL == 0)
+		{
+			fakeSysTick.VAL = fakeSysTick.LOAD;
+		}
+		else if (--fakeSysTick.VAL == 0)
+		{
+			fakeSysTick.CTRL |= SysTick_CTRL_COUNTFLAG_Msk;
+			pending = true;
+		}
+		cycles++;
+	}
+}
+
+static uint32_t readCtrl(void)
+{
+	runCounter(accessCycles);
+	registersRead.ctrl[0] = fakeSysTick.CTRL;
+	fakeSysTick.CTRL &= ~SysTick_CTRL_COUNTFLAG_Msk;
+	return 0;
+}
+
+static uint32_t readVal(void)
+{
+	runCounter(accessCycles);
+	registersRead.val[0] = fakeSysTick.VAL;
+	return 0;
+}
+
+static void serve(void)
+{
+	if (pending)
+	{
+		pending = false;
+		SysTick_Handler();
+	}
+}
+
+// Runs the counter, with the ISR served right after each reload
+static void runServed(uint64_t count)
+{
+	for ( ; count ; count--)
+	{
+		runCounter(1);
+		serve();
+	}
+}
+
+// Runs the counter up to the given cycles from the beginning of the next tick,
+// or of the one after it if already past them
+static void runToOffset(int32_t offset)
+{
+	uint64_t target = (cycles / CYCLES_PER_TICK + 1) * CYCLES_PER_TICK + offset;
+	runServed(target > cycles ? target - cycles : target + CYCLES_PER_TICK - cycles);
+}
+
+// Clock of the driver in cycles, and the one of the counter
+static uint64_t readCycles(void)
+{
+	uint32_t value;
+	uint64_t ticks = systickGetClock(&value);
+	return ticks * CYCLES_PER_TICK + (value ? CYCLES_PER_TICK - value : 0);
+}
+
+static uint64_t counterCycles(void)
+{
+	return tickBase * CYCLES_PER_TICK + cycles;
+}
+
+static void onTick(void)
+{
+	calls++;
+	lastCall = (uint32_t)processedTick;
+}
+
+int main(void)
+{
+	uint64_t last = 0;
+
+	timestampInit();
+	CHECK(fakeSysTick.LOAD == CYCLES_PER_TICK - 1 && (fakeSysTick.CTRL & SysTick_CTRL_ENABLE_Msk));
+
+	// Every cycle around the reloads, the value 0 is already the next tick and
+	// the reload value its first cycle. The ISR runs right at the reload, or
+	// pending while the clock is read, preempting it.
+	for (uint32_t tick = 0 ; tick < 6 ; tick++)
+	{
+		runToOffset(-4);
+		for (int32_t offset = -4 ; offset <= 4 ; offset++)
+		{
+			if (tick % 2 || offset == 3)
+			{
+				serve();
+			}
+			uint64_t now = readCycles();
+			CHECK(now == counterCycles() && now >= last);
+			CHECK(timeNowUs() == counterCycles() / CYCLES_PER_US);
+			CHECK(timeNowTicks64() == tickBase + cycles / CYCLES_PER_TICK);
+			last = now;
+			runCounter(1);
+		}
+		serve();
+		CHECK(systickGetTicks() == tickBase + cycles / CYCLES_PER_TICK);
+	}
+
+	// The counter runs while the driver reads it, so the reload falls between
+	// any two of its accesses. The clock is from an instant of the read, and
+	// the tick is counted once, by the read or by the ISR.
+	for (accessCycles = 1 ; accessCycles <= 3 ; accessCycles++)
+	{
+		for (int32_t offset = -12 ; offset <= 2 ; offset++)
+		{
+			runToOffset(offset);
+			uint64_t before = counterCycles();
+			uint64_t now = readCycles();
+			CHECK(now > before && now <= counterCycles() && now >= last);
+			last = now;
+			serve();
+			CHECK(systickGetTicks() == tickBase + cycles / CYCLES_PER_TICK);
+		}
+	}
+	accessCycles = 0;
+
+	// The subscriber is called once per tick, also for the ticks counted by
+	// reads while the ISR could not run
+	CHECK(systickSubscribe(onTick, 1, 0) != SYSTICK_INVALID_ID);
+	runToOffset(10);
+	calls = 0;
+	for (uint32_t tick = 0 ; tick < 3 ; tick++)
+	{
+		runCounter(CYCLES_PER_TICK);
+		CHECK(readCycles() == counterCycles());
+	}
+	CHECK(calls == 0);
+	serve();
+	CHECK(calls == 3 && lastCall == (uint32_t)(tickBase + cycles / CYCLES_PER_TICK));
+	CHECK(systickGetTicks() == tickBase + cycles / CYCLES_PER_TICK);
+
+	// Without subscribers, the ISR has no call due anymore
+	systickUnsubscribe(0);
+	CHECK(!anyDue);
+
+	// Near the wrap of the 32 bits ticks, the subscribers are called on time
+	// and the 64 bits clock keeps going up
+	tickBase = 0xFFFFFFFCULL - cycles / CYCLES_PER_TICK;
+	tickCount = 0xFFFFFFFCULL;
+	processedTick = 0xFFFFFFFCUL;
+	CHECK(systickSubscribe(onTick, 2, 0) == 0);
+	calls = 0;
+	for (uint32_t tick = 0 ; tick < 10 ; tick++)
+	{
+		runToOffset(0);
+		CHECK(readCycles() == counterCycles() && counterCycles() > last);
+		last = counterCycles();
+		CHECK(calls == (tick + 1) / 2 && (calls == 0 || lastCall % 2 == 0));
+	}
+	CHECK(systickGetTicks() == 0x100000006ULL);
+
+	// A late ISR across the wrap processes both ticks counted by reads
+	tickBase = 0xFFFFFFFFULL - cycles / CYCLES_PER_TICK;
+	tickCount = 0xFFFFFFFFULL;
+	processedTick = 0xFFFFFFFFUL;
+	systickUnsubscribe(0);
+	CHECK(systickSubscribe(onTick, 1, 0) == 0);
+	calls = 0;
+	runCounter(CYCLES_PER_TICK - cycles % CYCLES_PER_TICK);
+	CHECK(readCycles() == counterCycles());
+	runCounter(CYCLES_PER_TICK);
+	CHECK(readCycles() == counterCycles());
+	serve();
+	CHECK(calls == 2 && lastCall == 1 && systickGetTicks() == 0x100000001ULL);
+
+	printf("Clock monotonic across the reloads, each tick counted once, also across the wrap\n");
+
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/
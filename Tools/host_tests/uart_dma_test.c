@@ -0,0 +1,277 @@
+/*******************************************************************************
+  @file     uart_dma_test.c
+  @brief    Host test of the eDMA mode of the UART driver, with the channels run
+            by the test on fake registers, also with late and lost interrupts
+  @author   G. Davidov, F. Farall, J. Gaytán, L. Kammann, N. Trozzo
+ ******************************************************************************/
+
+/*******************************************************************************
+ * INCLUDE HEADER FILES
+ ******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "MK64F12.h"
+#include "drivers/MCAL/uart/uart.h"
+
+/*******************************************************************************
+ * CONSTANT AND MACRO DEFINITIONS USING #DEFINE
+ ******************************************************************************/
+
+#define TX_CHANNEL			3			// Channels of UART0
+#define RX_CHANNEL			4
+#define RING_LENGTH			64			// Circular buffer of the receiver DMA
+
+#define CHECK(condition)	do { if (!(condition)) { printf("FAIL: %s:%d %s\n", __FILE__, __LINE__, #condition); exit(EXIT_FAILURE); } } while (0)
+
+/*******************************************************************************
+ * VARIABLES WITH GLOBAL SCOPE
+ ******************************************************************************/
+
+GPIO_Type	fakeGpio[5];
+PORT_Type	fakePort[5];
+SIM_Type	fakeSim;
+DMA_Type	fakeDma;
+DMAMUX_Type	fakeDmamux;
+UART_Type	fakeUart[5];
+
+/*******************************************************************************
+ * STATIC VARIABLES AND CONST VARIABLES WITH FILE LEVEL SCOPE
+ ******************************************************************************/
+
+static uint8_t		sent[256];			// Words written to D by the transmitter channel
+static size_t		sentCount;
+static uint32_t		txCompleted;
+static uint32_t		rxCallbacks;
+static uint8_t		received;			// Next word the line receives
+static uint8_t		expected;			// Next word the test reads from the driver
+
+/*******************************************************************************
+ * FUNCTION DEFINITIONS
+ ******************************************************************************/
+
+// Interrupt handlers of UART0 and of its channels
+void UART0_RX_TX_IRQHandler(void);
+void DMA3_IRQHandler(void);
+void DMA4_IRQHandler(void);
+
+void hardwareDisableInterrupts(void)
+{
+}
+
+void hardwareEnableInterrupts(void)
+{
+}
+
+static void onTxCompleted(void)
+{
+	txCompleted++;
+}
+
+static void onRx(void)
+{
+	rxCallbacks++;
+}
+
+// One minor loop of a channel, as the eDMA runs it with the flags of the
+// interrupts, the request disabled at the end and the scatter/gather
+static void dmaMinorLoop(uint8_t channel)
+{
+	typeof(fakeDma.TCD[0])* tcd = &fakeDma.TCD[channel];
+	uint16_t citer = (tcd->CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK) - 1;
+
+	*(uint8_t*)(uintptr_t)tcd->DADDR = *(uint8_t*)(uintptr_t)tcd->SADDR;
+	tcd->SADDR += (int16_t)tcd->SOFF;
+	tcd->DADDR += (int16_t)tcd->DOFF;
+
+	if (citer == (tcd->BITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK) / 2 && (tcd->CSR & DMA_CSR_INTHALF_MASK))
+	{
+		fakeDma.INT |= 1UL << channel;
+	}
+	if (citer == 0)
+	{
+		uint16_t csr = tcd->CSR;
+		fakeDma.INT |= (csr & DMA_CSR_INTMAJOR_MASK) ? 1UL << channel : 0;
+		fakeDma.ERQ &= (csr & DMA_CSR_DREQ_MASK) ? ~(1UL << channel) : ~0UL;
+		if (csr & DMA_CSR_ESG_MASK)
+		{
+			memcpy((void*)tcd, (void*)(uintptr_t)tcd->DLAST_SGA, sizeof(*tcd));
+		}
+		else
+		{
+			tcd->SADDR += tcd->SLAST;
+			tcd->DADDR += tcd->DLAST_SGA;
+			tcd->CITER_ELINKNO = tcd->BITER_ELINKNO;
+		}
+	}
+	else
+	{
+		tcd->CITER_ELINKNO = citer;
+	}
+}
+
+// The eDMA applies the last writes of the driver, SERQ sets the request of a
+// channel and CINT clears the flag of a channel
+static void dmaWrites(void)
+{
+	if (fakeDma.SERQ < 16)
+	{
+		fakeDma.ERQ |= 1UL << fakeDma.SERQ;
+	}
+	if (fakeDma.CINT < 16)
+	{
+		fakeDma.INT &= ~(1UL << fakeDma.CINT);
+	}
+	fakeDma.SERQ = 0xFF;
+	fakeDma.CINT = 0xFF;
+}
+
+static void runDriver(void (*handler)(void))
+{
+	handler();
+	dmaWrites();
+}
+
+// The transmitter channel sends every word requested, its interrupt served
+// right away, then the UART raises the transmission complete
+static void runTransmitter(void)
+{
+	while (fakeDma.ERQ & (1UL << TX_CHANNEL))
+	{
+		dmaMinorLoop(TX_CHANNEL);
+		sent[sentCount++] = fakeUart[0].D;
+		if (fakeDma.INT & (1UL << TX_CHANNEL))
+		{
+			runDriver(DMA3_IRQHandler);
+		}
+	}
+	CHECK(fakeUart[0].C2 & UART_C2_TCIE_MASK);
+	fakeUart[0].S1 = UART_S1_TC_MASK;
+	runDriver(UART0_RX_TX_IRQHandler);
+	fakeUart[0].S1 = 0;
+}
+
+// Words arriving at the receiver, moved by its channel, with the interrupts of
+// the halves served right away or left pending
+static void receive(size_t count, bool served)
+{
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		fakeUart[0].D = received++;
+		dmaMinorLoop(RX_CHANNEL);
+		if (served && (fakeDma.INT & (1UL << RX_CHANNEL)))
+		{
+			runDriver(DMA4_IRQHandler);
+		}
+	}
+}
+
+// Pending interrupt of the receiver channel
+static void serveReceiver(void)
+{
+	if (fakeDma.INT & (1UL << RX_CHANNEL))
+	{
+		runDriver(DMA4_IRQHandler);
+	}
+}
+
+// Idle line after a frame, the FIFO already emptied by the DMA
+static void idleLine(void)
+{
+	fakeUart[0].S1 = UART_S1_IDLE_MASK;
+	runDriver(UART0_RX_TX_IRQHandler);
+	fakeUart[0].S1 = 0;
+	CHECK(fakeUart[0].C5 & UART_C5_RDMAS_MASK);
+}
+
+// Reads every word queued, which must follow the ones read before
+static size_t readAll(void)
+{
+	uint8_t words[255];
+	size_t count = uartReadMsg(UART_INSTANCE_0, words, sizeof(words));
+
+	for (size_t i = 0 ; i < count ; i++)
+	{
+		CHECK(words[i] == expected);
+		expected++;
+	}
+	return count;
+}
+
+int main(void)
+{
+	uart_cfg_t config = { .baudRate = UART_BAUD_RATE_9600, .dmaEnable = 1 };
+
+	uartInit(UART_INSTANCE_0, config);
+	dmaWrites();
+	uartSubscribeTxMsgComplete(UART_INSTANCE_0, onTxCompleted);
+	uartSubscribeRxMsg(UART_INSTANCE_0, onRx, 1);
+	CHECK(fakeDma.ERQ == 1UL << RX_CHANNEL);
+	CHECK(fakeUart[0].C5 & UART_C5_TDMAS_MASK);
+	CHECK(fakeDmamux.CHCFG[TX_CHANNEL] == (DMAMUX_CHCFG_ENBL(1) | 3));
+	CHECK(fakeDmamux.CHCFG[RX_CHANNEL] == (DMAMUX_CHCFG_ENBL(1) | 2));
+
+	// Messages of growing lengths, so the queue wraps at every offset and the
+	// scatter/gather sends the words after the wrap
+	uint8_t next = 0;
+	for (uint8_t length = 1 ; length < 120 ; length++)
+	{
+		uint8_t message[128];
+		for (uint8_t i = 0 ; i < length ; i++)
+		{
+			message[i] = next + i;
+		}
+		sentCount = 0;
+		CHECK(uartWriteMsg(UART_INSTANCE_0, message, length) == length);
+		dmaWrites();
+		runTransmitter();
+		CHECK(sentCount == length && memcmp(sent, message, length) == 0);
+		CHECK(txCompleted == length && !(fakeUart[0].C2 & UART_C2_TE_MASK));
+		next += length;
+	}
+
+	// Frames of varied lengths, flushed by the halves and by the idle line
+	for (uint32_t frame = 1 ; frame < 200 ; frame++)
+	{
+		size_t length = (frame * 7) % 70 + 1;
+		receive(length, true);
+		idleLine();
+		CHECK(readAll() == length);
+	}
+	CHECK(uartGetRxOverruns(UART_INSTANCE_0) == 0 && rxCallbacks > 0);
+
+	// Both halves filled before a late interrupt, with less than a whole buffer
+	// since the last read, from a read in the middle of a half
+	receive((RING_LENGTH + RING_LENGTH * 3 / 4 - received % RING_LENGTH) % RING_LENGTH, true);
+	idleLine();
+	readAll();
+	receive(RING_LENGTH - 4, false);
+	serveReceiver();
+	CHECK(readAll() == RING_LENGTH - 4);
+
+	// A whole buffer not read yet, still intact
+	receive(RING_LENGTH - (received % RING_LENGTH), true);
+	readAll();
+	receive(RING_LENGTH, false);
+	serveReceiver();
+	CHECK(readAll() == RING_LENGTH && uartGetRxOverruns(UART_INSTANCE_0) == 0);
+
+	// More than a whole buffer before the interrupt, the words were overwritten
+	// so they are discarded and counted, and the next ones are read right
+	receive(RING_LENGTH + 10, false);
+	serveReceiver();
+	CHECK(uartGetRxOverruns(UART_INSTANCE_0) == 1);
+	CHECK(uartReadMsg(UART_INSTANCE_0, (uint8_t[1]){ 0 }, 1) == 0);
+	expected = received;
+	receive(20, true);
+	idleLine();
+	CHECK(readAll() == 20 && uartGetRxOverruns(UART_INSTANCE_0) == 1);
+
+	printf("Messages sent by the DMA, frames received in order, overruns detected\n");
+
+	return EXIT_SUCCESS;
+}
+
+/******************************************************************************/